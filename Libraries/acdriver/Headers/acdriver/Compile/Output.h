@@ -13,8 +13,11 @@
 #include <plist/Dictionary.h>
 #include <car/Writer.h>
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <ext/optional>
@@ -23,12 +26,22 @@ namespace libutil { class Filesystem; }
 namespace xcassets { namespace Asset { class Asset; } }
 
 namespace acdriver {
+
+class Result;
+
 namespace Compile {
 
 /*
  * Output for asset catalog compilation.
  */
 class Output {
+public:
+    /*
+     * Creates a rendition from the contents of its source file. Returns the
+     * rendition, or an error message if it couldn't be created.
+     */
+    typedef std::function<std::pair<ext::optional<car::Rendition>, std::string>(std::vector<uint8_t> const &contents)> RenditionFunction;
+
 public:
     enum class Format {
         /*
@@ -54,6 +67,27 @@ private:
     std::vector<std::pair<std::string, std::string>> _copies;
     std::unique_ptr<plist::Dictionary> _additionalInfo;
 
+private:
+    struct PendingRendition {
+        std::string       file;
+        car::AttributeList attributes;
+        std::string       key;
+        RenditionFunction function;
+    };
+
+    struct PendingInput {
+        std::string       path;
+        size_t            renditions;
+    };
+
+private:
+    std::map<std::string, uint16_t>    _facetIdentifiers;
+    std::vector<std::string>           _facetNames;
+    std::unordered_set<uint16_t>       _facetsAdded;
+    std::vector<PendingRendition>      _renditions;
+    std::vector<PendingInput>          _renditionInputs;
+    ext::optional<std::string>         _renditionCache;
+
 private:
     std::vector<std::string>           _inputs;
     std::vector<std::string>           _outputs;
@@ -116,6 +150,45 @@ public:
     plist::Dictionary *additionalInfo()
     { return _additionalInfo.get(); }
 
+public:
+    /*
+     * The identifier for the facet with a name. The first time a name is
+     * used, assigns the next identifier. The facet is added to the archive
+     * along with the first of its renditions that is created.
+     */
+    uint16_t facetIdentifier(std::string const &name);
+
+    /*
+     * Add a rendition to create later from a file. Renditions are created in
+     * parallel, so the function must only use state that it owns. The key
+     * describes everything other than the file's contents that the function
+     * uses to create the rendition; it identifies the rendition in the cache.
+     */
+    void addRendition(std::string const &file, car::AttributeList const &attributes, std::string const &key, RenditionFunction const &function);
+
+    /*
+     * Create the added renditions and add them to the archive. Renditions
+     * are added in the order they were added here, regardless of the order
+     * they are created in. Errors are reported for each rendition's file.
+     */
+    bool compileRenditions(libutil::Filesystem *filesystem, Result *result);
+
+    /*
+     * Add an input that the renditions added since the last such input were
+     * found in. It's added to the inputs once the renditions are created,
+     * and only if all of them are.
+     */
+    void addRenditionInput(std::string const &path);
+
+    /*
+     * A directory to cache serialized renditions in, if any. Renditions
+     * with the same key and file contents are reused from the cache.
+     */
+    ext::optional<std::string> const &renditionCache() const
+    { return _renditionCache; }
+    ext::optional<std::string> &renditionCache()
+    { return _renditionCache; }
+
 public:
     /*
      * Files that were read in as input.
@@ -72,6 +72,13 @@ private:
     ext::optional<std::string> _filterForDeviceModel;
     ext::optional<std::string> _filterForDeviceOsVersion;
 
+private:
+    /*
+     * Not an actool option: a directory to cache compiled renditions in,
+     * so unchanged images are not recompiled on the next compile.
+     */
+    ext::optional<std::string> _renditionCache;
+
 public:
     Options();
     ~Options();
@@ -149,6 +156,10 @@ public:
     ext::optional<std::string> const &filterForDeviceOsVersion() const
     { return _filterForDeviceOsVersion; }
 
+public:
+    ext::optional<std::string> const &renditionCache() const
+    { return _renditionCache; }
+
 private:
     friend class libutil::Options;
     std::pair<bool, std::string>
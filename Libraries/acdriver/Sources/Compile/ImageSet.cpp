@@ -22,7 +22,7 @@
 #include <libutil/FSUtil.h>
 
 #include <algorithm>
-#include <map>
+#include <sstream>
 #include <string>
 
 using acdriver::Compile::ImageSet;
@@ -52,65 +52,24 @@ Compile(
     return success;
 }
 
-static uint16_t
-GenerateIdentifier(void) {
-    static uint16_t last = 0;
-    last = last + 1;
-    return last;
-}
-
-bool ImageSet::
-CompileAsset(
-    xcassets::Asset::ImageSet const *imageSet,
-    xcassets::Asset::ImageSet::Image const &image,
-    Filesystem *filesystem,
-    Output *compileOutput,
-    Result *result)
+static std::pair<ext::optional<car::Rendition>, std::string>
+CreateRendition(
+    std::vector<uint8_t> const &contents,
+    std::string const &filename,
+    car::AttributeList const &attributes,
+    double scale,
+    std::string const &fileName,
+    ext::optional<xcassets::Resizing> const &resizing)
 {
-    static std::map<std::string, uint16_t> idMap = {};
-
-    /* Skip any entry that is not attached to a file, or is explicitly unassigned. */
-    if (!image.fileName() || image.unassigned()) {
-        return true;
-    }
-
-    /* An image without an idiom is considered unassigned. */
-    if (!image.idiom()) {
-        return false;
-    }
-
-    std::string filename = FSUtil::ResolveRelativePath(*image.fileName(), imageSet->path());
-
-    std::string name = imageSet->name().string();
-
-    /* The default (0) is any scale. */
-    double scale = 0;
-    if (image.scale()) {
-        scale = image.scale()->value();
-    }
-
-    // TODO: filter by target-device / device-model / os-version
-    uint16_t idiom = Convert::IdiomAttribute(*image.idiom());
-
     std::vector<uint8_t> pixels;
     size_t width = 0;
     size_t height = 0;
     car::Rendition::Data::Format format = car::Rendition::Data::Format::Data;
 
     if (FSUtil::IsFileExtension(filename, "png", true)) {
-        std::vector<uint8_t> contents;
-        if (!filesystem->read(&contents, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read PNG file",
-                filename);
-            return false;
-        }
-
         auto png = graphics::Format::PNG::Read(contents);
         if (!png.first) {
-            result->normal(Result::Severity::Error, png.second, filename);
-            return false;
+            return std::make_pair(ext::nullopt, png.second);
         }
 
         graphics::Image const &image = *png.first;
@@ -140,66 +99,26 @@ CompileAsset(
                         graphics::PixelFormat::Alpha::PremultipliedFirst));
                 break;
         }
-    } else if (FSUtil::IsFileExtension(filename, "jpg", true) || FSUtil::IsFileExtension(filename, "jpeg", true)) {
-        if (!filesystem->read(&pixels, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read JPEG file",
-                filename);
-            return false;
-        }
-
-        format = car::Rendition::Data::Format::JPEG;
-    } else {
-        result->normal(
-            Result::Severity::Error,
-            "unknown file type",
-            filename);
-        return false;
-    }
-
-    bool createFacet = false;
-    uint16_t facetIdentifier = 0;
-    auto it = idMap.find(name);
-    if (it == idMap.end()) {
-        facetIdentifier = GenerateIdentifier();
-        idMap[name] = facetIdentifier;
-        createFacet = true;
     } else {
-        facetIdentifier = it->second;
-    }
-    if (createFacet) {
-        car::AttributeList attributes = car::AttributeList({
-            { car_attribute_identifier_identifier, facetIdentifier },
-        });
-
-        car::Facet facet = car::Facet::Create(name, attributes);
-        compileOutput->car()->addFacet(facet);
+        pixels = contents;
+        format = car::Rendition::Data::Format::JPEG;
     }
 
     /*
      * Create rendition for the image.
      */
-    car::AttributeList attributes = car::AttributeList({
-        { car_attribute_identifier_idiom, idiom },
-        { car_attribute_identifier_scale, static_cast<int>(scale) },
-        { car_attribute_identifier_identifier, facetIdentifier },
-    });
-
     auto data = ext::optional<car::Rendition::Data>(car::Rendition::Data(std::move(pixels), format));
 
     car::Rendition rendition = car::Rendition::Create(attributes, std::move(data));
     rendition.width() = width;
     rendition.height() = height;
     rendition.scale() = scale;
-    rendition.fileName() = *image.fileName();
-
-    if (image.resizing()) {
-        xcassets::Resizing const &resizing = *image.resizing();
+    rendition.fileName() = fileName;
 
+    if (resizing) {
         xcassets::Resizing::Center::Mode centerMode = xcassets::Resizing::Center::Mode::Tile;
-        if (resizing.center()) {
-            xcassets::Resizing::Center const &center = *resizing.center();
+        if (resizing->center()) {
+            xcassets::Resizing::Center const &center = *resizing->center();
             if (center.mode()) {
                 centerMode = *center.mode();
             }
@@ -207,13 +126,123 @@ CompileAsset(
             /* TODO: center size is currently ingnored */
         }
 
-        if (resizing.mode()) {
-            xcassets::Resizing::Mode resizingMode = *resizing.mode();
+        if (resizing->mode()) {
+            xcassets::Resizing::Mode resizingMode = *resizing->mode();
             rendition.layout() = Convert::LayoutForResizingAndCenterMode(resizingMode, centerMode);
-            rendition.slices() = Convert::SlicesForResizingModeAndCapInsets(width, height, resizingMode, resizing.capInsets());
+            rendition.slices() = Convert::SlicesForResizingModeAndCapInsets(width, height, resizingMode, resizing->capInsets());
         }
     }
 
-    compileOutput->car()->addRendition(std::move(rendition));
+    return std::make_pair(std::move(rendition), std::string());
+}
+
+static std::string
+RenditionKey(
+    std::string const &filename,
+    car::AttributeList const &attributes,
+    double scale,
+    std::string const &fileName,
+    ext::optional<xcassets::Resizing> const &resizing)
+{
+    /*
+     * Everything used to create the rendition other than the file contents.
+     * The facet identifier is left out: it depends on the other assets, but
+     * it's only stored in the rendition's key, not in the rendition itself.
+     */
+    std::ostringstream key;
+    auto optional = [&key](ext::optional<double> const &value) {
+        if (value) {
+            key << *value;
+        } else {
+            key << "-";
+        }
+        key << " ";
+    };
+
+    key << FSUtil::GetFileExtension(filename) << " " << fileName << " " << scale << " ";
+    key << attributes.get(car_attribute_identifier_idiom).value_or(0) << " ";
+
+    if (resizing) {
+        key << (resizing->mode() ? static_cast<int>(*resizing->mode()) : -1) << " ";
+        if (resizing->center()) {
+            xcassets::Resizing::Center const &center = *resizing->center();
+            key << (center.mode() ? static_cast<int>(*center.mode()) : -1) << " ";
+            optional(center.width());
+            optional(center.height());
+        }
+        if (resizing->capInsets()) {
+            xcassets::Insets const &capInsets = *resizing->capInsets();
+            optional(capInsets.top());
+            optional(capInsets.left());
+            optional(capInsets.bottom());
+            optional(capInsets.right());
+        }
+    }
+
+    return key.str();
+}
+
+bool ImageSet::
+CompileAsset(
+    xcassets::Asset::ImageSet const *imageSet,
+    xcassets::Asset::ImageSet::Image const &image,
+    Filesystem *filesystem,
+    Output *compileOutput,
+    Result *result)
+{
+    /* Skip any entry that is not attached to a file, or is explicitly unassigned. */
+    if (!image.fileName() || image.unassigned()) {
+        return true;
+    }
+
+    /* An image without an idiom is considered unassigned. */
+    if (!image.idiom()) {
+        return false;
+    }
+
+    std::string filename = FSUtil::ResolveRelativePath(*image.fileName(), imageSet->path());
+
+    std::string name = imageSet->name().string();
+
+    /* The default (0) is any scale. */
+    double scale = 0;
+    if (image.scale()) {
+        scale = image.scale()->value();
+    }
+
+    // TODO: filter by target-device / device-model / os-version
+    uint16_t idiom = Convert::IdiomAttribute(*image.idiom());
+
+    if (!FSUtil::IsFileExtension(filename, "png", true) && !FSUtil::IsFileExtension(filename, "jpg", true) && !FSUtil::IsFileExtension(filename, "jpeg", true)) {
+        result->normal(
+            Result::Severity::Error,
+            "unknown file type",
+            filename);
+        return false;
+    }
+
+    /*
+     * Identifiers are assigned here, in the order assets are found, so they
+     * don't depend on the order renditions are created in.
+     */
+    uint16_t facetIdentifier = compileOutput->facetIdentifier(name);
+
+    car::AttributeList attributes = car::AttributeList({
+        { car_attribute_identifier_idiom, idiom },
+        { car_attribute_identifier_scale, static_cast<int>(scale) },
+        { car_attribute_identifier_identifier, facetIdentifier },
+    });
+
+    /*
+     * Decoding and converting the image is slow; do it along with the other
+     * renditions. Copy what's needed, since the asset may not live that long.
+     */
+    std::string fileName = *image.fileName();
+    ext::optional<xcassets::Resizing> resizing = image.resizing();
+    std::string key = RenditionKey(filename, attributes, scale, fileName, resizing);
+    compileOutput->addRendition(filename, attributes, key, [filename, attributes, scale, fileName, resizing](std::vector<uint8_t> const &contents) {
+        return CreateRendition(contents, filename, attributes, scale, fileName, resizing);
+    });
+
     return true;
 }
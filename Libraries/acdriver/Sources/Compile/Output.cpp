@@ -16,7 +16,17 @@
 #include <dependency/BinaryDependencyInfo.h>
 #include <plist/Format/Format.h>
 #include <plist/Format/XML.h>
+#include <car/Facet.h>
+#include <car/Rendition.h>
+#include <car/car_format.h>
 #include <libutil/Filesystem.h>
+#include <libutil/md5.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+#include <thread>
 
 using acdriver::Compile::Output;
 using acdriver::Version;
@@ -38,6 +48,230 @@ Output(
 {
 }
 
+uint16_t Output::
+facetIdentifier(std::string const &name)
+{
+    auto it = _facetIdentifiers.find(name);
+    if (it != _facetIdentifiers.end()) {
+        return it->second;
+    }
+
+    uint16_t identifier = static_cast<uint16_t>(_facetIdentifiers.size() + 1);
+    _facetIdentifiers.insert({ name, identifier });
+    _facetNames.push_back(name);
+
+    return identifier;
+}
+
+void Output::
+addRendition(std::string const &file, car::AttributeList const &attributes, std::string const &key, RenditionFunction const &function)
+{
+    _renditions.push_back({ file, attributes, key, function });
+}
+
+void Output::
+addRenditionInput(std::string const &path)
+{
+    _renditionInputs.push_back({ path, _renditions.size() });
+}
+
+/*
+ * Version of the renditions stored in the cache. This MUST be bumped whenever
+ * the bytes written for a rendition can change: its layout, compression or
+ * chunking, pixel format conversion, or how attributes are chosen. Otherwise,
+ * cached renditions written by the old code are reused.
+ */
+static char const RenditionCacheVersion[] = "rendition-1";
+
+static std::string
+RenditionCacheKey(std::string const &key, std::vector<uint8_t> const &contents)
+{
+    /*
+     * Include the compiler version and the codecs available, as a codec that
+     * isn't available falls back to another one and writes different bytes.
+     */
+    std::string prefix = std::string(RenditionCacheVersion) + " " + std::to_string(Version::BuildVersion());
+    for (car::Rendition::Compression compression : { car::Rendition::Compression::LZVN, car::Rendition::Compression::LZFSE }) {
+        prefix += (car::Rendition::CompressionAvailable(compression) ? " 1" : " 0");
+    }
+    prefix += " " + key;
+
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<const md5_byte_t *>(prefix.c_str()), prefix.size() + 1);
+    md5_append(&state, reinterpret_cast<const md5_byte_t *>(contents.data()), contents.size());
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t c : digest) {
+        ss << std::setw(2) << static_cast<int>(c);
+    }
+    return ss.str();
+}
+
+static std::vector<uint8_t>
+RenditionCacheDigest(std::vector<uint8_t> const &value)
+{
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<const md5_byte_t *>(value.data()), value.size());
+    std::vector<uint8_t> digest = std::vector<uint8_t>(16);
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(digest.data()));
+    return digest;
+}
+
+static bool
+ReadRenditionCache(Filesystem const *filesystem, std::string const &path, std::vector<uint8_t> *value)
+{
+    /*
+     * Cache entries are the digest of the rendition followed by the
+     * rendition, so partially written entries are not reused.
+     */
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, path) || contents.size() < 16) {
+        return false;
+    }
+
+    std::vector<uint8_t> stored = std::vector<uint8_t>(contents.begin(), contents.begin() + 16);
+    *value = std::vector<uint8_t>(contents.begin() + 16, contents.end());
+    return (RenditionCacheDigest(*value) == stored);
+}
+
+bool Output::
+compileRenditions(Filesystem *filesystem, Result *result)
+{
+    struct Created {
+        ext::optional<std::vector<uint8_t>> value;
+        std::string error;
+        bool cached;
+        std::string cacheKey;
+    };
+    std::vector<Created> created = std::vector<Created>(_renditions.size());
+
+    /*
+     * Decoding, converting and encoding images is independent for each
+     * rendition, so create them on a pool of workers. Renditions that are
+     * already in the cache are reused without decoding the image.
+     */
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = std::min<size_t>(cores, _renditions.size());
+
+    /*
+     * Large renditions compress in parallel themselves. Share the cores
+     * with the other workers, rather than each using all of them.
+     */
+    size_t compressionThreads = std::max<size_t>(1, cores / std::max<size_t>(1, workers));
+
+    std::atomic<size_t> next = ATOMIC_VAR_INIT(0);
+    auto worker = [this, filesystem, compressionThreads, &created, &next]() {
+        for (size_t index = next++; index < _renditions.size(); index = next++) {
+            PendingRendition const &pending = _renditions[index];
+            Created *entry = &created[index];
+            entry->cached = false;
+
+            std::vector<uint8_t> contents;
+            if (!filesystem->read(&contents, pending.file)) {
+                entry->error = "unable to read file";
+                continue;
+            }
+
+            if (_renditionCache) {
+                entry->cacheKey = RenditionCacheKey(pending.key, contents);
+
+                std::vector<uint8_t> value;
+                if (ReadRenditionCache(filesystem, *_renditionCache + "/" + entry->cacheKey, &value)) {
+                    entry->value = std::move(value);
+                    entry->cached = true;
+                    continue;
+                }
+            }
+
+            std::pair<ext::optional<car::Rendition>, std::string> rendition = pending.function(contents);
+            if (rendition.first) {
+                rendition.first->compressionThreads() = compressionThreads;
+                entry->value = rendition.first->write();
+            } else {
+                entry->error = rendition.second;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    /*
+     * Collect the renditions in a consistent order. Filesystem writes are
+     * not thread-safe, so new renditions are cached here.
+     */
+    bool success = true;
+    size_t reused = 0;
+    bool cacheWritable = (_renditionCache && filesystem->createDirectory(*_renditionCache));
+
+    for (size_t index = 0; index < _renditions.size(); ++index) {
+        PendingRendition const &pending = _renditions[index];
+        Created const &entry = created[index];
+
+        if (entry.value) {
+            if (_car) {
+                /* Facets are only added for renditions that were created. */
+                ext::optional<uint16_t> identifier = pending.attributes.get(car_attribute_identifier_identifier);
+                if (identifier && *identifier >= 1 && *identifier <= _facetNames.size() && _facetsAdded.insert(*identifier).second) {
+                    car::AttributeList attributes = car::AttributeList({
+                        { car_attribute_identifier_identifier, *identifier },
+                    });
+
+                    car::Facet facet = car::Facet::Create(_facetNames[*identifier - 1], attributes);
+                    _car->addFacet(facet);
+                }
+
+                _car->addRendition(pending.attributes, *entry.value);
+            }
+
+            if (entry.cached) {
+                reused++;
+            } else if (cacheWritable) {
+                std::vector<uint8_t> contents = RenditionCacheDigest(*entry.value);
+                contents.insert(contents.end(), entry.value->begin(), entry.value->end());
+                filesystem->write(contents, *_renditionCache + "/" + entry.cacheKey);
+            }
+        } else {
+            result->normal(Result::Severity::Error, entry.error, pending.file);
+            success = false;
+        }
+    }
+
+    if (_renditionCache && !_renditions.empty()) {
+        std::string message = "reused " + std::to_string(reused) + " of " + std::to_string(_renditions.size()) + " renditions from cache";
+        result->normal(Result::Severity::Notice, message);
+    }
+
+    /*
+     * Inputs are only recorded if everything found in them was created.
+     */
+    size_t start = 0;
+    for (PendingInput const &input : _renditionInputs) {
+        bool complete = std::all_of(created.begin() + start, created.begin() + input.renditions, [](Created const &entry) {
+            return static_cast<bool>(entry.value);
+        });
+        if (complete) {
+            _inputs.push_back(input.path);
+        }
+        start = input.renditions;
+    }
+
+    _renditions.clear();
+    _renditionInputs.clear();
+    return success;
+}
+
 std::string Output::
 AssetReference(xcassets::Asset::Asset const *asset)
 {
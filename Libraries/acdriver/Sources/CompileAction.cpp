@@ -262,6 +262,7 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
         *outputFormat,
         options.appIcon(),
         options.launchImage());
+    compileOutput.renditionCache() = options.renditionCache();
 
     /*
      * If necessary, create output archive to write into.
@@ -306,7 +307,15 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
             continue;
         }
 
-        compileOutput.inputs().push_back(input);
+        compileOutput.addRenditionInput(input);
+    }
+
+    /*
+     * Create the renditions found in all of the asset catalogs.
+     */
+    if (!compileOutput.compileRenditions(filesystem, result)) {
+        /* Error already reported. */
+        return;
     }
 
     /*
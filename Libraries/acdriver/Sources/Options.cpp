@@ -82,6 +82,8 @@ parseArgument(std::vector<std::string> const &args, std::vector<std::string>::co
         return libutil::Options::Next<std::string>(&_filterForDeviceModel, args, it);
     } else if (arg == "--filter-for-device-os-version") {
         return libutil::Options::Next<std::string>(&_filterForDeviceOsVersion, args, it);
+    } else if (arg == "--rendition-cache") {
+        return libutil::Options::Next<std::string>(&_renditionCache, args, it);
     } else if (!arg.empty() && arg[0] != '-') {
         return libutil::Options::AppendCurrent<std::string>(&_inputs, arg);
     } else {
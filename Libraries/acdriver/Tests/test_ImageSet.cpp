@@ -0,0 +1,264 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <acdriver/Compile/Asset.h>
+#include <acdriver/Compile/Output.h>
+#include <acdriver/Result.h>
+#include <xcassets/Asset/Catalog.h>
+#include <graphics/Image.h>
+#include <graphics/PixelFormat.h>
+#include <graphics/Format/PNG.h>
+#include <bom/bom.h>
+#include <car/car_format.h>
+#include <car/Facet.h>
+#include <car/Reader.h>
+#include <car/Writer.h>
+#include <libutil/MemoryFilesystem.h>
+
+using acdriver::Compile::Output;
+using acdriver::Result;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+#define CONTENTS(...) Contents(#__VA_ARGS__)
+
+static std::vector<uint8_t>
+ImagePNG(uint8_t value)
+{
+    /* A 2x1 RGBA image, with one opaque and one half transparent pixel. */
+    graphics::PixelFormat format = graphics::PixelFormat(
+        graphics::PixelFormat::Color::RGB,
+        graphics::PixelFormat::Order::Forward,
+        graphics::PixelFormat::Alpha::Last);
+    graphics::Image image = graphics::Image(2, 1, format, { value, 0x20, 0x40, 0xFF, value, 0x20, 0x40, 0x80 });
+
+    auto png = graphics::Format::PNG::Write(image);
+    EXPECT_NE(png.first, ext::nullopt);
+    return png.first.value_or(std::vector<uint8_t>());
+}
+
+static MemoryFilesystem::Entry
+ImageSetEntry(std::string const &name, std::vector<MemoryFilesystem::Entry> const &images)
+{
+    std::vector<MemoryFilesystem::Entry> children = images;
+    children.push_back(MemoryFilesystem::Entry::File("Contents.json", CONTENTS({
+        "images" : [
+            { "idiom" : "universal", "filename" : "image.png", "scale" : "1x" },
+            { "idiom" : "universal", "filename" : "image@2x.png", "scale" : "2x" }
+        ]
+    })));
+    return MemoryFilesystem::Entry::Directory(name + ".imageset", children);
+}
+
+static Output
+CompiledOutput()
+{
+    /* Compile into an archive in memory. */
+    Output output = Output("/output", Output::Format::Compiled, ext::nullopt, ext::nullopt);
+    output.car() = car::Writer::Create(car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free));
+    EXPECT_NE(output.car(), ext::nullopt);
+    return output;
+}
+
+static ext::optional<car::Reader>
+ReadOutput(Output *output)
+{
+    output->car()->write();
+
+    /* Read back the archive. */
+    struct bom_context_memory const *memory = bom_memory(output->car()->bom());
+    auto bom = car::Reader::unique_ptr_bom(bom_alloc_load(bom_context_memory(memory->data, memory->size)), bom_free);
+    EXPECT_NE(bom, nullptr);
+    return car::Reader::Load(std::move(bom));
+}
+
+static ext::optional<car::Reader>
+CompileCatalog(MemoryFilesystem *filesystem, ext::optional<std::string> const &renditionCache, Result *result)
+{
+    auto catalog = xcassets::Asset::Catalog::Load(filesystem, "/Images.xcassets");
+    EXPECT_NE(catalog, nullptr);
+    if (catalog == nullptr) {
+        return ext::nullopt;
+    }
+
+    Output output = CompiledOutput();
+    output.renditionCache() = renditionCache;
+
+    EXPECT_TRUE(acdriver::Compile::Asset::Compile(catalog.get(), filesystem, &output, result));
+    output.compileRenditions(filesystem, result);
+    return ReadOutput(&output);
+}
+
+TEST(ImageSet, CompileParallel)
+{
+    /* Enough images that renditions are created on several workers. */
+    std::vector<MemoryFilesystem::Entry> imageSets;
+    for (int i = 0; i < 32; ++i) {
+        imageSets.push_back(ImageSetEntry("image" + std::to_string(i), {
+            MemoryFilesystem::Entry::File("image.png", ImagePNG(i)),
+            MemoryFilesystem::Entry::File("image@2x.png", ImagePNG(i + 0x80)),
+        }));
+    }
+
+    /* One image is missing, which should only fail that rendition. */
+    imageSets.push_back(ImageSetEntry("missing", {
+        MemoryFilesystem::Entry::File("image.png", ImagePNG(0xFF)),
+    }));
+
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Images.xcassets", imageSets),
+    });
+
+    Result result;
+    ext::optional<car::Reader> reader = CompileCatalog(&filesystem, ext::nullopt, &result);
+    EXPECT_FALSE(result.success());
+    ASSERT_NE(reader, ext::nullopt);
+
+    for (int i = 0; i < 32; ++i) {
+        ext::optional<car::Facet> facet = reader->lookupFacet("image" + std::to_string(i));
+        ASSERT_NE(facet, ext::nullopt);
+
+        /* Identifiers follow the order the image sets were found. */
+        EXPECT_EQ(facet->attributes().get(car_attribute_identifier_identifier), ext::optional<uint16_t>(i + 1));
+
+        std::vector<car::Rendition> renditions = reader->lookupRenditions(*facet);
+        ASSERT_EQ(renditions.size(), 2);
+        for (car::Rendition const &rendition : renditions) {
+            uint8_t value = (rendition.scale() == 2 ? i + 0x80 : i);
+            uint8_t premultiplied = static_cast<uint8_t>((value * 0x80 + 0x7F) / 0xFF);
+
+            ASSERT_NE(rendition.data(), ext::nullopt);
+            EXPECT_EQ(rendition.data()->data(), std::vector<uint8_t>({ 0x40, 0x20, value, 0xFF, 0x20, 0x10, premultiplied, 0x80 }));
+        }
+    }
+
+    /* The image that could be read is still included. */
+    ext::optional<car::Facet> missing = reader->lookupFacet("missing");
+    ASSERT_NE(missing, ext::nullopt);
+    EXPECT_EQ(reader->lookupRenditions(*missing).size(), 1);
+}
+
+TEST(ImageSet, FailedRenditions)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Good.xcassets", {
+            ImageSetEntry("good", {
+                MemoryFilesystem::Entry::File("image.png", ImagePNG(0x10)),
+                MemoryFilesystem::Entry::File("image@2x.png", ImagePNG(0x20)),
+            }),
+        }),
+        MemoryFilesystem::Entry::Directory("Bad.xcassets", {
+            /* One image isn't a valid image and the other is missing. */
+            ImageSetEntry("broken", {
+                MemoryFilesystem::Entry::File("image.png", Contents("not an image")),
+            }),
+        }),
+    });
+
+    Output output = CompiledOutput();
+    Result result;
+    for (std::string const &path : { "/Good.xcassets", "/Bad.xcassets" }) {
+        auto catalog = xcassets::Asset::Catalog::Load(&filesystem, path);
+        ASSERT_NE(catalog, nullptr);
+        EXPECT_TRUE(acdriver::Compile::Asset::Compile(catalog.get(), &filesystem, &output, &result));
+        output.addRenditionInput(path);
+    }
+
+    /* Renditions are created after compiling, so failures are found then. */
+    EXPECT_FALSE(output.compileRenditions(&filesystem, &result));
+    EXPECT_FALSE(result.success());
+
+    /* Only the catalog with everything created is an input. */
+    EXPECT_EQ(output.inputs(), std::vector<std::string>({ "/Good.xcassets" }));
+
+    /* Facets are only added for images that were created. */
+    ext::optional<car::Reader> reader = ReadOutput(&output);
+    ASSERT_NE(reader, ext::nullopt);
+    EXPECT_NE(reader->lookupFacet("good"), ext::nullopt);
+    EXPECT_EQ(reader->lookupFacet("broken"), ext::nullopt);
+}
+
+static std::vector<uint8_t>
+RenditionData(car::Reader const &reader, std::string const &name, double scale)
+{
+    ext::optional<car::Facet> facet = reader.lookupFacet(name);
+    EXPECT_NE(facet, ext::nullopt);
+    if (!facet) {
+        return std::vector<uint8_t>();
+    }
+
+    for (car::Rendition const &rendition : reader.lookupRenditions(*facet)) {
+        if (rendition.scale() == scale && rendition.data()) {
+            return rendition.data()->data();
+        }
+    }
+
+    return std::vector<uint8_t>();
+}
+
+TEST(ImageSet, RenditionCache)
+{
+    std::vector<MemoryFilesystem::Entry> imageSets;
+    for (int i = 0; i < 4; ++i) {
+        imageSets.push_back(ImageSetEntry("image" + std::to_string(i), {
+            MemoryFilesystem::Entry::File("image.png", ImagePNG(i)),
+            MemoryFilesystem::Entry::File("image@2x.png", ImagePNG(i + 0x80)),
+        }));
+    }
+
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Images.xcassets", imageSets),
+    });
+
+    /* Nothing is cached the first time. */
+    Result first;
+    ext::optional<car::Reader> firstReader = CompileCatalog(&filesystem, std::string("/cache"), &first);
+    ASSERT_NE(firstReader, ext::nullopt);
+    EXPECT_TRUE(first.success());
+    EXPECT_EQ(first.normalText(Result::Severity::Notice), ext::optional<std::string>(": notice: reused 0 of 8 renditions from cache\n"));
+
+    /* Only the changed image is created again. */
+    ASSERT_TRUE(filesystem.write(ImagePNG(0x40), "/Images.xcassets/image2.imageset/image.png"));
+
+    Result second;
+    ext::optional<car::Reader> secondReader = CompileCatalog(&filesystem, std::string("/cache"), &second);
+    ASSERT_NE(secondReader, ext::nullopt);
+    EXPECT_TRUE(second.success());
+    EXPECT_EQ(second.normalText(Result::Severity::Notice), ext::optional<std::string>(": notice: reused 7 of 8 renditions from cache\n"));
+
+    /* Reused renditions are the same as newly created ones. */
+    Result uncached;
+    ext::optional<car::Reader> uncachedReader = CompileCatalog(&filesystem, ext::nullopt, &uncached);
+    ASSERT_NE(uncachedReader, ext::nullopt);
+    for (int i = 0; i < 4; ++i) {
+        std::string name = "image" + std::to_string(i);
+        EXPECT_EQ(RenditionData(*secondReader, name, 1), RenditionData(*uncachedReader, name, 1));
+        EXPECT_EQ(RenditionData(*secondReader, name, 2), RenditionData(*uncachedReader, name, 2));
+    }
+    EXPECT_NE(RenditionData(*firstReader, "image2", 1), RenditionData(*secondReader, "image2", 1));
+
+    /* Damaged cache entries are not reused. */
+    std::vector<std::string> entries;
+    filesystem.enumerateDirectory("/cache", [&entries](std::string const &name) {
+        entries.push_back(name);
+    });
+    ASSERT_EQ(entries.size(), 9);
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(20, 0), "/cache/" + entries.front()));
+
+    Result damaged;
+    ASSERT_NE(CompileCatalog(&filesystem, std::string("/cache"), &damaged), ext::nullopt);
+    EXPECT_TRUE(damaged.success());
+    EXPECT_EQ(damaged.normalText(Result::Severity::Notice), ext::optional<std::string>(": notice: reused 7 of 8 renditions from cache\n"));
+}
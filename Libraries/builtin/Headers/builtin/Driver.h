@@ -10,6 +10,7 @@
 #ifndef __builtin_Driver_h
 #define __builtin_Driver_h
 
+#include <cstdio>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -28,7 +29,12 @@ public:
     virtual std::string name() = 0;
 
 public:
-    virtual int run(process::Context const *processContext, libutil::Filesystem *filesystem) = 0;
+    /*
+     * Run the tool in-process. The tool prints to the given output and
+     * error streams rather than to this process's, so callers running
+     * several tools at once can hold each tool's output together.
+     */
+    virtual int run(process::Context const *processContext, libutil::Filesystem *filesystem, FILE *output, FILE *error) = 0;
 };
 
 }
@@ -11,16 +11,18 @@
 #include <builtin/copy/Options.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/Wildcard.h>
 #include <process/Context.h>
-#include <process/MemoryContext.h>
-#include <process/Launcher.h>
 
-#include <unordered_set>
+#include <algorithm>
+#include <cstring>
+#include <sys/stat.h>
 
 using builtin::copy::Driver;
 using builtin::copy::Options;
 using libutil::Filesystem;
 using libutil::FSUtil;
+using libutil::Wildcard;
 
 Driver::
 Driver()
@@ -38,41 +40,110 @@ name()
     return "builtin-copy";
 }
 
+/*
+ * Plan copying a path recursively: directories and symbolic links are created
+ * immediately, files to copy are collected so they can be copied together.
+ */
 static bool
-CopyPath(Filesystem *filesystem, std::string const &inputPath, std::string const &outputPath)
+CopyPath(Filesystem *filesystem, std::string const &inputPath, std::string const &outputPath, std::vector<std::string> const &excludes, std::vector<std::pair<std::string, std::string>> *files, FILE *error)
 {
-    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(outputPath))) {
-        return false;
+    if (filesystem->isSymbolicLink(inputPath)) {
+        /* Links are copied as links, not followed. */
+        ext::optional<std::string> target = filesystem->readSymbolicLink(inputPath);
+        if (!target) {
+            fprintf(error, "error: unable to read link '%s'\n", inputPath.c_str());
+            return false;
+        }
+
+        if (filesystem->isSymbolicLink(outputPath) || filesystem->exists(outputPath)) {
+            if (filesystem->readSymbolicLink(outputPath) == target) {
+                return true;
+            }
+
+            filesystem->removeFile(outputPath);
+        }
+
+        if (!filesystem->writeSymbolicLink(*target, outputPath)) {
+            fprintf(error, "error: unable to create link '%s'\n", outputPath.c_str());
+            return false;
+        }
+
+        return true;
+    } else if (filesystem->isDirectory(inputPath)) {
+        if (!filesystem->createDirectory(outputPath)) {
+            fprintf(error, "error: unable to create directory '%s'\n", outputPath.c_str());
+            return false;
+        }
+
+        std::vector<std::string> names;
+        if (!filesystem->enumerateDirectory(inputPath, [&](std::string const &name) {
+            names.push_back(name);
+        })) {
+            fprintf(error, "error: unable to read directory '%s'\n", inputPath.c_str());
+            return false;
+        }
+
+        for (std::string const &name : names) {
+            bool excluded = std::any_of(excludes.begin(), excludes.end(), [&](std::string const &exclude) {
+                return Wildcard::Match(exclude, name);
+            });
+            if (excluded) {
+                continue;
+            }
+
+            if (!CopyPath(filesystem, inputPath + "/" + name, outputPath + "/" + name, excludes, files, error)) {
+                return false;
+            }
+        }
+
+        return true;
+    } else {
+        files->push_back({ inputPath, outputPath });
+        return true;
     }
+}
 
-    // TODO: This shouldn't use external tools to copy.
-    process::Context const *context = process::Context::GetDefaultUNSAFE();
-    process::Launcher *launcher = process::Launcher::GetDefaultUNSAFE();
-
-    process::MemoryContext cp = process::MemoryContext(
-        "/bin/cp",
-        context->currentDirectory(),
-        { "-R", inputPath, outputPath },
-        context->environmentVariables(),
-        context->userID(),
-        context->groupID(),
-        context->userName(),
-        context->groupName());
-    if (launcher->launch(filesystem, &cp).value_or(-1) != 0) {
-        return false;
+/*
+ * Copies should preserve permissions but be writable.
+ */
+static uint32_t const CopyAddMode = S_IWUSR;
+
+/*
+ * Copy files that aren't already up to date. Copies keep the modification
+ * time and permissions of their source, so a copy with the same size, time
+ * and permissions is current.
+ */
+static bool
+CopyFiles(Filesystem *filesystem, std::vector<std::pair<std::string, std::string>> const &files, FILE *error)
+{
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    for (auto const &file : files) {
+        inputs.push_back(file.first);
+        outputs.push_back(file.second);
+    }
+
+    std::vector<ext::optional<libutil::FileInfo>> inputInfos = filesystem->statMany(inputs);
+    std::vector<ext::optional<libutil::FileInfo>> outputInfos = filesystem->statMany(outputs);
+
+    std::vector<std::pair<std::string, std::string>> copies;
+    for (size_t i = 0; i < files.size(); ++i) {
+        ext::optional<libutil::FileInfo> const &input = inputInfos[i];
+        ext::optional<libutil::FileInfo> const &output = outputInfos[i];
+        if (input && output && output->type() == libutil::FileInfo::Type::File && input->size() == output->size() && input->modificationTime() == output->modificationTime() && output->mode() == (input->mode() | CopyAddMode)) {
+            continue;
+        }
+
+        copies.push_back(files[i]);
     }
 
-    /* Should preserve permissions but make writable. */
-    process::MemoryContext chmod = process::MemoryContext(
-        "/bin/chmod",
-        context->currentDirectory(),
-        { "-R", "+w", outputPath },
-        context->environmentVariables(),
-        context->userID(),
-        context->groupID(),
-        context->userName(),
-        context->groupName());
-    if (launcher->launch(filesystem, &chmod).value_or(-1) != 0) {
+    std::vector<int> errors;
+    if (!filesystem->copyFiles(copies, CopyAddMode, &errors)) {
+        for (size_t i = 0; i < copies.size(); ++i) {
+            if (errors[i] != 0) {
+                fprintf(error, "error: unable to copy '%s' to '%s': %s\n", copies[i].first.c_str(), copies[i].second.c_str(), strerror(errors[i]));
+            }
+        }
         return false;
     }
 
@@ -80,26 +151,26 @@ CopyPath(Filesystem *filesystem, std::string const &inputPath, std::string const
 }
 
 static int
-Run(Filesystem *filesystem, Options const &options, std::string const &workingDirectory)
+Run(Filesystem *filesystem, Options const &options, std::string const &workingDirectory, FILE *output, FILE *error)
 {
     if (!options.output()) {
-        fprintf(stderr, "error: no output path provided\n");
+        fprintf(error, "error: no output path provided\n");
         return 1;
     }
 
     if (options.stripDebugSymbols() || options.bitcodeStrip() != Options::BitcodeStripMode::None) {
         // TODO(grp): Implement strip support when copying.
 #if 0
-        fprintf(stderr, "warning: strip on copy is not supported\n");
+        fprintf(error, "warning: strip on copy is not supported\n");
 #endif
     }
 
     if (options.preserveHFSData()) {
-        fprintf(stderr, "warning: preserve HFS data is not supported\n");
+        fprintf(error, "warning: preserve HFS data is not supported\n");
     }
 
-    std::string const &output = FSUtil::ResolveRelativePath(*options.output(), workingDirectory);
-    auto excludes = std::unordered_set<std::string>(options.excludes().begin(), options.excludes().end());
+    std::string const &outputDirectory = FSUtil::ResolveRelativePath(*options.output(), workingDirectory);
+    std::vector<std::pair<std::string, std::string>> files;
 
     for (std::string input : options.inputs()) {
         input = FSUtil::ResolveRelativePath(input, workingDirectory);
@@ -112,33 +183,43 @@ Run(Filesystem *filesystem, Options const &options, std::string const &workingDi
             if (options.ignoreMissingInputs()) {
                 continue;
             } else {
-                fprintf(stderr, "error: missing input '%s'\n", input.c_str());
+                fprintf(error, "error: missing input '%s'\n", input.c_str());
                 return 1;
             }
         }
 
         if (options.verbose()) {
-            printf("verbose: copying %s -> %s\n", input.c_str(), output.c_str());
+            fprintf(output, "verbose: copying %s -> %s\n", input.c_str(), outputDirectory.c_str());
+        }
+
+        std::string outputPath = outputDirectory + "/" + FSUtil::GetBaseName(input);
+        if (!filesystem->createDirectory(FSUtil::GetDirectoryName(outputPath))) {
+            fprintf(error, "error: unable to create directory '%s'\n", FSUtil::GetDirectoryName(outputPath).c_str());
+            return 1;
         }
 
-        std::string outputPath = output + "/" + FSUtil::GetBaseName(input);
-        if (!CopyPath(filesystem, input, outputPath)) {
+        if (!CopyPath(filesystem, input, outputPath, options.excludes(), &files, error)) {
             return 1;
         }
     }
 
+    /* Files are independent, so copy them all together. */
+    if (!CopyFiles(filesystem, files, error)) {
+        return 1;
+    }
+
     return 0;
 }
 
 int Driver::
-run(process::Context const *processContext, libutil::Filesystem *filesystem)
+run(process::Context const *processContext, libutil::Filesystem *filesystem, FILE *output, FILE *error)
 {
     Options options;
     std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, processContext->commandLineArguments());
     if (!result.first) {
-        fprintf(stderr, "error: %s\n", result.second.c_str());
+        fprintf(error, "error: %s\n", result.second.c_str());
         return 1;
     }
 
-    return Run(filesystem, options, processContext->currentDirectory());
+    return Run(filesystem, options, processContext->currentDirectory(), output, error);
 }
@@ -33,16 +33,16 @@ name()
 }
 
 int Driver::
-run(process::Context const *processContext, libutil::Filesystem *filesystem)
+run(process::Context const *processContext, libutil::Filesystem *filesystem, FILE *output, FILE *error)
 {
     Options options;
     std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, processContext->commandLineArguments());
     if (!result.first) {
-        fprintf(stderr, "error: %s\n", result.second.c_str());
+        fprintf(error, "error: %s\n", result.second.c_str());
         return 1;
     }
 
     // TODO(grp): Implement copy tiff builtin.
-    fprintf(stderr, "error: copy tiff not supported\n");
+    fprintf(error, "error: copy tiff not supported\n");
     return 1;
 }
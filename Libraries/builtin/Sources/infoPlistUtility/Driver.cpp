@@ -155,23 +155,23 @@ CreateBuildEnvironment(std::unordered_map<std::string, std::string> const &envir
 }
 
 int Driver::
-run(process::Context const *processContext, libutil::Filesystem *filesystem)
+run(process::Context const *processContext, libutil::Filesystem *filesystem, FILE *output, FILE *error)
 {
     Options options;
     std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, processContext->commandLineArguments());
     if (!result.first) {
-        fprintf(stderr, "error: %s\n", result.second.c_str());
+        fprintf(error, "error: %s\n", result.second.c_str());
         return 1;
     }
 
     /* Validate options. */
     if (!options.input()) {
-        fprintf(stderr, "error: no input file specified\n");
+        fprintf(error, "error: no input file specified\n");
         return 1;
     }
 
     if (!options.output()) {
-        fprintf(stderr, "error: no output file specified\n");
+        fprintf(error, "error: no output file specified\n");
         return 1;
     }
 
@@ -180,27 +180,27 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     /* Read in the input. */
     std::vector<uint8_t> inputContents;
     if (!filesystem->read(&inputContents, FSUtil::ResolveRelativePath(*options.input(), processContext->currentDirectory()))) {
-        fprintf(stderr, "error: unable to read input %s\n", options.input()->c_str());
+        fprintf(error, "error: unable to read input %s\n", options.input()->c_str());
         return 1;
     }
 
     /* Determine the input format. */
     std::unique_ptr<plist::Format::Any> inputFormat = plist::Format::Any::Identify(inputContents);
     if (inputFormat == nullptr) {
-        fprintf(stderr, "error: input %s is not a plist\n", options.input()->c_str());
+        fprintf(error, "error: input %s is not a plist\n", options.input()->c_str());
         return 1;
     }
 
     /* Deserialize the input. */
     auto deserialize = plist::Format::Any::Deserialize(inputContents, *inputFormat);
     if (!deserialize.first) {
-        fprintf(stderr, "error: %s: %s\n", options.input()->c_str(), deserialize.second.c_str());
+        fprintf(error, "error: %s: %s\n", options.input()->c_str(), deserialize.second.c_str());
         return 1;
     }
 
     plist::Dictionary *root = plist::CastTo<plist::Dictionary>(deserialize.first.get());
     if (root == nullptr) {
-        fprintf(stderr, "error: info plist root is not a dictionary\n");
+        fprintf(error, "error: info plist root is not a dictionary\n");
         return 1;
     }
 
@@ -219,13 +219,13 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     for (std::string const &additionalContentFile : options.additionalContentFiles()) {
         std::vector<uint8_t> contents;
         if (!filesystem->read(&contents, FSUtil::ResolveRelativePath(additionalContentFile, processContext->currentDirectory()))) {
-            fprintf(stderr, "error: unable to read additional content file: %s\n", additionalContentFile.c_str());
+            fprintf(error, "error: unable to read additional content file: %s\n", additionalContentFile.c_str());
             return 1;
         }
 
         auto additionalContent = plist::Format::Any::Deserialize(contents);
         if (additionalContent.first == nullptr) {
-            fprintf(stderr, "error: unable to parse additional content file %s: %s\n", additionalContentFile.c_str(), additionalContent.second.c_str());
+            fprintf(error, "error: unable to parse additional content file %s: %s\n", additionalContentFile.c_str(), additionalContent.second.c_str());
             return 1;
         }
 
@@ -240,7 +240,7 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
      */
     if (options.infoFileKeys() || options.infoFileValues()) {
         // TODO(grp): Handle info file keys and values.
-        fprintf(stderr, "warning: info file keys and values are not yet implemented\n");
+        fprintf(error, "warning: info file keys and values are not yet implemented\n");
     }
 
     /*
@@ -249,7 +249,7 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     if (options.platform() || !options.requiredArchitectures().empty()) {
         // TODO(grp): Handle platform and required architectures.
 #if 0
-        fprintf(stderr, "warning: platform and required architectures are not yet implemented\n");
+        fprintf(error, "warning: platform and required architectures are not yet implemented\n");
 #endif
     }
 
@@ -264,7 +264,7 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     if (options.genPkgInfo()) {
         auto result = WritePkgInfo(filesystem, root, FSUtil::ResolveRelativePath(*options.genPkgInfo(), processContext->currentDirectory()));
         if (!result.first) {
-            fprintf(stderr, "error: %s\n", result.second.c_str());
+            fprintf(error, "error: %s\n", result.second.c_str());
             return 1;
         }
     }
@@ -277,12 +277,12 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
         if (!resourceRulesInputPath.empty()) {
             std::vector<uint8_t> contents;
             if (!filesystem->read(&contents, FSUtil::ResolveRelativePath(resourceRulesInputPath, processContext->currentDirectory()))) {
-                fprintf(stderr, "error: unable to read input %s\n", resourceRulesInputPath.c_str());
+                fprintf(error, "error: unable to read input %s\n", resourceRulesInputPath.c_str());
                 return 1;
             }
 
             if (!filesystem->write(contents, FSUtil::ResolveRelativePath(*options.resourceRulesFile(), processContext->currentDirectory()))) {
-                fprintf(stderr, "error: could not open output path %s to write\n", options.resourceRulesFile()->c_str());
+                fprintf(error, "error: could not open output path %s to write\n", options.resourceRulesFile()->c_str());
                 return 1;
             }
         }
@@ -300,7 +300,7 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
         } else if (*options.format() == "ascii" || *options.format() == "openstep") {
             outputFormat = plist::Format::Any::Create(plist::Format::ASCII::Create(false, plist::Format::Encoding::UTF8));
         } else {
-            fprintf(stderr, "error: unknown output format %s\n", options.format()->c_str());
+            fprintf(error, "error: unknown output format %s\n", options.format()->c_str());
             return 1;
         }
     }
@@ -308,13 +308,13 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     /* Serialize the output. */
     auto serialize = plist::Format::Any::Serialize(root, outputFormat);
     if (serialize.first == nullptr) {
-        fprintf(stderr, "error: %s\n", serialize.second.c_str());
+        fprintf(error, "error: %s\n", serialize.second.c_str());
         return 1;
     }
 
     /* Write out the output. */
     if (!filesystem->write(*serialize.first, FSUtil::ResolveRelativePath(*options.output(), processContext->currentDirectory()))) {
-        fprintf(stderr, "error: could not open output path %s to write\n", options.output()->c_str());
+        fprintf(error, "error: could not open output path %s to write\n", options.output()->c_str());
         return 1;
     }
 
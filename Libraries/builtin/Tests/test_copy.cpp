@@ -0,0 +1,124 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <builtin/copy/Driver.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/MemoryFilesystem.h>
+#include <process/MemoryContext.h>
+
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using builtin::copy::Driver;
+using libutil::DefaultFilesystem;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static process::MemoryContext
+Context(std::vector<std::string> const &arguments)
+{
+    return process::MemoryContext(
+        "builtin-copy",
+        "/",
+        arguments,
+        std::unordered_map<std::string, std::string>(),
+        0,
+        0,
+        "root",
+        "wheel");
+}
+
+TEST(copy, Name)
+{
+    Driver driver;
+    EXPECT_EQ(driver.name(), "builtin-copy");
+}
+
+TEST(copy, CopyRecursive)
+{
+    std::vector<uint8_t> contents;
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("file.txt", Contents("file")),
+        MemoryFilesystem::Entry::Directory("Resources.bundle", {
+            MemoryFilesystem::Entry::File("one.txt", Contents("one")),
+            MemoryFilesystem::Entry::File(".DS_Store", Contents("excluded")),
+            MemoryFilesystem::Entry::Directory("nested", {
+                MemoryFilesystem::Entry::File("two.txt", Contents("two")),
+            }),
+        }),
+    });
+
+    Driver driver;
+    process::MemoryContext context = Context({ "-exclude", ".DS_Store", "file.txt", "Resources.bundle", "output" });
+    EXPECT_EQ(0, driver.run(&context, &filesystem, stdout, stderr));
+
+    EXPECT_TRUE(filesystem.read(&contents, "/output/file.txt"));
+    EXPECT_EQ(contents, Contents("file"));
+    EXPECT_TRUE(filesystem.read(&contents, "/output/Resources.bundle/one.txt"));
+    EXPECT_EQ(contents, Contents("one"));
+    EXPECT_TRUE(filesystem.read(&contents, "/output/Resources.bundle/nested/two.txt"));
+    EXPECT_EQ(contents, Contents("two"));
+    EXPECT_FALSE(filesystem.exists("/output/Resources.bundle/.DS_Store"));
+
+    /* Copies keep the time of their source, so they're seen as up to date. */
+    EXPECT_EQ(filesystem.stat("/file.txt")->modificationTime(), filesystem.stat("/output/file.txt")->modificationTime());
+
+    /* Changed inputs are copied again. */
+    ASSERT_TRUE(filesystem.write(Contents("changed"), "/Resources.bundle/one.txt"));
+    EXPECT_EQ(0, driver.run(&context, &filesystem, stdout, stderr));
+    EXPECT_TRUE(filesystem.read(&contents, "/output/Resources.bundle/one.txt"));
+    EXPECT_EQ(contents, Contents("changed"));
+}
+
+TEST(copy, MissingInput)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({ });
+
+    Driver driver;
+    process::MemoryContext missing = Context({ "missing.txt", "output" });
+    EXPECT_NE(0, driver.run(&missing, &filesystem, stdout, stderr));
+
+    process::MemoryContext ignored = Context({ "-ignore-missing-inputs", "missing.txt", "output" });
+    EXPECT_EQ(0, driver.run(&ignored, &filesystem, stdout, stderr));
+}
+
+TEST(copy, CopyPermissions)
+{
+    /* Permissions need a real filesystem. */
+    char directory[] = "/tmp/builtin-copy-XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    std::string input = std::string(directory) + "/input.sh";
+    std::string output = std::string(directory) + "/output";
+
+    DefaultFilesystem filesystem;
+    ASSERT_TRUE(filesystem.write(Contents("script"), input));
+    ASSERT_EQ(0, ::chmod(input.c_str(), 0644));
+
+    Driver driver;
+    process::MemoryContext context = Context({ input, output });
+    EXPECT_EQ(0, driver.run(&context, &filesystem, stdout, stderr));
+    EXPECT_EQ(filesystem.stat(output + "/input.sh")->mode(), 0644);
+
+    /* Changing only the permissions of the input copies it again. */
+    ASSERT_EQ(0, ::chmod(input.c_str(), 0755));
+    EXPECT_EQ(0, driver.run(&context, &filesystem, stdout, stderr));
+    EXPECT_EQ(filesystem.stat(output + "/input.sh")->mode(), 0755);
+
+    filesystem.removeFile(output + "/input.sh");
+    filesystem.removeFile(input);
+    ::rmdir(output.c_str());
+    ::rmdir(directory);
+}
@@ -70,7 +70,7 @@ TEST(copyPlist, CopyMultiple)
         0,
         "root",
         "wheel");
-    EXPECT_EQ(0, driver.run(&processContext, &filesystem));
+    EXPECT_EQ(0, driver.run(&processContext, &filesystem, stdout, stderr));
 
     contents.clear();
     EXPECT_TRUE(filesystem.read(&contents, "/output/in1.plist"));
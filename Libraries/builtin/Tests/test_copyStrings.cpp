@@ -52,7 +52,7 @@ TEST(copyStrings, CopyMultiple)
         0,
         "root",
         "wheel");
-    EXPECT_EQ(0, driver.run(&processContext, &filesystem));
+    EXPECT_EQ(0, driver.run(&processContext, &filesystem, stdout, stderr));
 
     contents.clear();
     EXPECT_TRUE(filesystem.read(&contents, "/output/in1.strings"));
@@ -98,7 +98,7 @@ TEST(copyStrings, InputOutputEncoding)
                 0,
                 "root",
                 "wheel");
-            EXPECT_EQ(0, driver.run(&processContext, &filesystem));
+            EXPECT_EQ(0, driver.run(&processContext, &filesystem, stdout, stderr));
 
             std::vector<uint8_t> contents;
             EXPECT_TRUE(filesystem.read(&contents, "/output/in.strings"));
@@ -20,5 +20,5 @@ main(int argc, char **argv, char **envp)
     process::DefaultContext processContext = process::DefaultContext();
 
     builtin::copy::Driver driver;
-    return driver.run(&processContext, &filesystem);
+    return driver.run(&processContext, &filesystem, stdout, stderr);
 }
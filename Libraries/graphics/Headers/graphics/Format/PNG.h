@@ -31,10 +31,15 @@ private:
 
 public:
     /*
-     * Read a PNG image.
+     * Read a PNG image. The contents are only read from during the call,
+     * so they can be directly mapped from a file.
      */
     static std::pair<ext::optional<Image>, std::string>
-    Read(std::vector<uint8_t> const &contents);
+    Read(uint8_t const *data, size_t size);
+
+    static std::pair<ext::optional<Image>, std::string>
+    Read(std::vector<uint8_t> const &contents)
+    { return Read(contents.data(), contents.size()); }
 
 public:
     /*
@@ -109,12 +109,12 @@ PixelFormatFromCGColorSpaceAndCGBitmapInfo(CGColorSpaceRef colorSpace, CGBitmapI
 }
 
 std::pair<ext::optional<Image>, std::string> PNG::
-Read(std::vector<uint8_t> const &contents)
+Read(uint8_t const *contents, size_t size)
 {
     /*
      * Load the image.
      */
-    auto data = CFHandle<CFDataRef>(CFDataCreateWithBytesNoCopy(kCFAllocatorDefault, contents.data(), contents.size(), kCFAllocatorNull));
+    auto data = CFHandle<CFDataRef>(CFDataCreateWithBytesNoCopy(kCFAllocatorDefault, contents, size, kCFAllocatorNull));
     if (data == NULL) {
         return std::make_pair(ext::nullopt, "unable to create data");
     }
@@ -218,22 +218,32 @@ Read(std::vector<uint8_t> const &contents)
 #include <png.h>
 #include <string.h>
 
+struct png_user_read_context {
+    unsigned char const *current;
+    unsigned char const *end;
+};
+
 static void
 png_user_read_data(png_structp png_ptr, png_bytep data, png_size_t length)
 {
-    unsigned char **contents_ptr = (unsigned char **)png_get_io_ptr(png_ptr);
-    if (contents_ptr == NULL) {
+    png_user_read_context *context = (png_user_read_context *)png_get_io_ptr(png_ptr);
+    if (context == NULL) {
         return;
     }
 
-    memcpy(data, *contents_ptr, length);
-    *contents_ptr += length;
+    /* Don't read past the end of the contents. */
+    if (length > (png_size_t)(context->end - context->current)) {
+        png_error(png_ptr, "unexpected end of data");
+    }
+
+    memcpy(data, context->current, length);
+    context->current += length;
 }
 
 std::pair<ext::optional<Image>, std::string> PNG::
-Read(std::vector<uint8_t> const &contents)
+Read(uint8_t const *contents, size_t size)
 {
-    if (contents.size() < 8 || png_sig_cmp(const_cast<png_bytep>(static_cast<png_byte const *>(contents.data())), 0, 8)) {
+    if (size < 8 || png_sig_cmp(const_cast<png_bytep>(static_cast<png_byte const *>(contents)), 0, 8)) {
         return std::make_pair(ext::nullopt, "contents is not a PNG");
     }
 
@@ -253,8 +263,8 @@ Read(std::vector<uint8_t> const &contents)
         return std::make_pair(ext::nullopt, "setjmp/png_jmpbuf returned error");
     }
 
-    unsigned char const *contents_ptr = static_cast<unsigned char const *>(contents.data());
-    png_set_read_fn(png_struct_ptr, &contents_ptr, png_user_read_data);
+    png_user_read_context context = { contents, contents + size };
+    png_set_read_fn(png_struct_ptr, &context, png_user_read_data);
 
     png_read_info(png_struct_ptr, info_struct_ptr);
 
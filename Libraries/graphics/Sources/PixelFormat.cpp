@@ -12,6 +12,12 @@
 #include <cmath>
 #include <ext/optional>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 using graphics::PixelFormat;
 
 size_t PixelFormat::
@@ -172,6 +178,203 @@ ColorChannels(size_t *red, size_t *green, size_t *blue, PixelFormat::Color color
     }
 }
 
+/*
+ * Multiply a channel by alpha, rounding to the nearest value. For all 8-bit
+ * inputs, this gives the same result as the floating point calculation in
+ * `Premultiply()`, but without any division.
+ */
+static inline uint8_t
+PremultiplyInteger(uint8_t value, uint8_t alpha)
+{
+    uint32_t product = static_cast<uint32_t>(value) * alpha + 0x80;
+    return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+}
+
+#if defined(__SSE2__)
+static inline __m128i
+PremultiplySSE2(__m128i values, __m128i alphas)
+{
+    /* Same as `PremultiplyInteger()`, on 16-bit lanes. */
+    __m128i product = _mm_add_epi16(_mm_mullo_epi16(values, alphas), _mm_set1_epi16(0x80));
+    return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+#elif defined(__ARM_NEON)
+static inline uint8x16_t
+PremultiplyNEON(uint8x16_t values, uint8x16_t alphas)
+{
+    /* Same as `PremultiplyInteger()`, widening to 16-bit lanes. */
+    uint16x8_t low = vmlal_u8(vdupq_n_u16(0x80), vget_low_u8(values), vget_low_u8(alphas));
+    uint16x8_t high = vmlal_u8(vdupq_n_u16(0x80), vget_high_u8(values), vget_high_u8(alphas));
+    low = vsraq_n_u16(low, low, 8);
+    high = vsraq_n_u16(high, high, 8);
+    return vcombine_u8(vshrn_n_u16(low, 8), vshrn_n_u16(high, 8));
+}
+#endif
+
+/*
+ * Specialized conversions between the formats most commonly converted between,
+ * such as from decoded PNGs into the formats stored in asset catalogs. Each
+ * converts a number of pixels, using vector instructions where available.
+ */
+typedef void (*ConvertKernel)(uint8_t const *from, uint8_t *to, size_t count);
+
+static void
+ConvertRGBAToPremultipliedBGRA(uint8_t const *from, uint8_t *to, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    /* Four pixels at a time, two in each half. Alpha is multiplied by 0xFF to keep it. */
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    __m128i const alphaOpaque = _mm_set_epi16(0xFF, 0, 0, 0, 0xFF, 0, 0, 0);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(from + i * 4));
+        __m128i halves[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+
+        for (__m128i &half : halves) {
+            __m128i alphas = _mm_shufflehi_epi16(_mm_shufflelo_epi16(half, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            alphas = _mm_or_si128(_mm_and_si128(alphas, colorMask), alphaOpaque);
+            half = PremultiplySSE2(half, alphas);
+            half = _mm_shufflehi_epi16(_mm_shufflelo_epi16(half, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(to + i * 4), _mm_packus_epi16(halves[0], halves[1]));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t pixels = vld4q_u8(from + i * 4);
+
+        uint8x16x4_t result;
+        result.val[0] = PremultiplyNEON(pixels.val[2], pixels.val[3]);
+        result.val[1] = PremultiplyNEON(pixels.val[1], pixels.val[3]);
+        result.val[2] = PremultiplyNEON(pixels.val[0], pixels.val[3]);
+        result.val[3] = pixels.val[3];
+        vst4q_u8(to + i * 4, result);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        uint8_t const *fromPixel = &from[i * 4];
+        uint8_t *toPixel = &to[i * 4];
+
+        uint8_t alpha = fromPixel[3];
+        toPixel[0] = PremultiplyInteger(fromPixel[2], alpha);
+        toPixel[1] = PremultiplyInteger(fromPixel[1], alpha);
+        toPixel[2] = PremultiplyInteger(fromPixel[0], alpha);
+        toPixel[3] = alpha;
+    }
+}
+
+static void
+ConvertRGBToBGRA(uint8_t const *from, uint8_t *to, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t pixels = vld3q_u8(from + i * 3);
+
+        uint8x16x4_t result;
+        result.val[0] = pixels.val[2];
+        result.val[1] = pixels.val[1];
+        result.val[2] = pixels.val[0];
+        result.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(to + i * 4, result);
+    }
+#endif
+
+    /* Without byte shuffles, SSE2 isn't faster than this. */
+    for (; i < count; ++i) {
+        uint8_t const *fromPixel = &from[i * 3];
+        uint8_t *toPixel = &to[i * 4];
+
+        toPixel[0] = fromPixel[2];
+        toPixel[1] = fromPixel[1];
+        toPixel[2] = fromPixel[0];
+        toPixel[3] = 0xFF;
+    }
+}
+
+static void
+ConvertGAToPremultipliedGA(uint8_t const *from, uint8_t *to, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    /* Eight pixels at a time, four in each half. Alpha is multiplied by 0xFF to keep it. */
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const grayMask = _mm_set1_epi32(0x0000FFFF);
+    __m128i const alphaOpaque = _mm_set1_epi32(0x00FF0000);
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(from + i * 2));
+        __m128i halves[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+
+        for (__m128i &half : halves) {
+            __m128i alphas = _mm_shufflehi_epi16(_mm_shufflelo_epi16(half, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+            alphas = _mm_or_si128(_mm_and_si128(alphas, grayMask), alphaOpaque);
+            half = PremultiplySSE2(half, alphas);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(to + i * 2), _mm_packus_epi16(halves[0], halves[1]));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x2_t pixels = vld2q_u8(from + i * 2);
+
+        uint8x16x2_t result;
+        result.val[0] = PremultiplyNEON(pixels.val[0], pixels.val[1]);
+        result.val[1] = pixels.val[1];
+        vst2q_u8(to + i * 2, result);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        uint8_t const *fromPixel = &from[i * 2];
+        uint8_t *toPixel = &to[i * 2];
+
+        uint8_t alpha = fromPixel[1];
+        toPixel[0] = PremultiplyInteger(fromPixel[0], alpha);
+        toPixel[1] = alpha;
+    }
+}
+
+static ConvertKernel
+FindKernel(
+    PixelFormat const &from, size_t fromRed, size_t fromGreen, size_t fromBlue, ext::optional<size_t> fromAlphaChannel, bool fromPremultiplied,
+    PixelFormat const &to, size_t toRed, size_t toGreen, size_t toBlue, ext::optional<size_t> toAlphaChannel, bool toPremultiplied)
+{
+    /*
+     * Match on the layout of the bytes rather than the format itself, as the
+     * same layout can be described with either order.
+     */
+    if (from.color() == PixelFormat::Color::RGB && to.color() == PixelFormat::Color::RGB &&
+        from.bytesPerPixel() == 3 && to.bytesPerPixel() == 4 &&
+        fromRed == 0 && fromGreen == 1 && fromBlue == 2 && !fromAlphaChannel &&
+        toRed == 2 && toGreen == 1 && toBlue == 0 && toAlphaChannel && *toAlphaChannel == 3) {
+        /* Opaque, so premultiplying has no effect. */
+        return &ConvertRGBToBGRA;
+    }
+
+    if (from.color() == PixelFormat::Color::RGB && to.color() == PixelFormat::Color::RGB &&
+        from.bytesPerPixel() == 4 && to.bytesPerPixel() == 4 &&
+        fromRed == 0 && fromGreen == 1 && fromBlue == 2 && fromAlphaChannel && *fromAlphaChannel == 3 && !fromPremultiplied &&
+        toRed == 2 && toGreen == 1 && toBlue == 0 && toAlphaChannel && *toAlphaChannel == 3 && toPremultiplied) {
+        return &ConvertRGBAToPremultipliedBGRA;
+    }
+
+    if (from.color() == PixelFormat::Color::Grayscale && to.color() == PixelFormat::Color::Grayscale &&
+        from.bytesPerPixel() == 2 && to.bytesPerPixel() == 2 &&
+        fromRed == 0 && fromAlphaChannel && *fromAlphaChannel == 1 && !fromPremultiplied &&
+        toRed == 0 && toAlphaChannel && *toAlphaChannel == 1 && toPremultiplied) {
+        return &ConvertGAToPremultipliedGA;
+    }
+
+    return nullptr;
+}
+
 std::vector<uint8_t> PixelFormat::
 Convert(std::vector<uint8_t> const &pixels, PixelFormat const &from, PixelFormat const &to)
 {
@@ -201,7 +404,15 @@ Convert(std::vector<uint8_t> const &pixels, PixelFormat const &from, PixelFormat
      */
     bool toPremultiplied = (toAlphaPremultiplied || !toAlphaChannel);
 
-    if (from.color() == to.color() && (bool)fromAlphaChannel == (bool)toAlphaChannel && fromAlphaPremultiplied == toPremultiplied) {
+    ConvertKernel kernel = FindKernel(
+        from, fromRed, fromGreen, fromBlue, fromAlphaChannel, fromAlphaPremultiplied,
+        to, toRed, toGreen, toBlue, toAlphaChannel, toPremultiplied);
+    if (kernel != nullptr) {
+        /*
+         * Fastest path: a specialized conversion for these formats.
+         */
+        kernel(pixels.data(), result.data(), pixelCount);
+    } else if (from.color() == to.color() && (bool)fromAlphaChannel == (bool)toAlphaChannel && fromAlphaPremultiplied == toPremultiplied) {
         /*
          * Fast path: not converting color formats or changing alpha.
          */
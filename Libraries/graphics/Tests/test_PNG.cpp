@@ -137,6 +137,22 @@ TEST(PNG, Read)
     }
 }
 
+TEST(PNG, ReadTruncated)
+{
+    for (size_t i = 0; i < sizeof(PNGTests) / sizeof(*PNGTests); i++) {
+        /* Load test data. */
+        auto const &test = PNGTests[i];
+        std::vector<uint8_t> png;
+        std::vector<uint8_t> pixels;
+        PixelFormat format = PixelFormat(PixelFormat::Color::Grayscale, PixelFormat::Order::Forward, PixelFormat::Alpha::None);
+        test(&png, &pixels, &format);
+
+        /* Should fail rather than read past the end. */
+        auto result = PNG::Read(png.data(), png.size() / 2);
+        EXPECT_EQ(result.first, ext::nullopt);
+    }
+}
+
 TEST(PNG, Write)
 {
     for (size_t i = 0; i < sizeof(PNGTests) / sizeof(*PNGTests); i++) {
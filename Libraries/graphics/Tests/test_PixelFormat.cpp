@@ -10,6 +10,8 @@
 #include <gtest/gtest.h>
 #include <graphics/PixelFormat.h>
 
+#include <cmath>
+
 using graphics::PixelFormat;
 
 TEST(PixelFormat, Properties)
@@ -98,3 +100,71 @@ TEST(PixelFormat, ConvertRearrange)
     EXPECT_EQ(PixelFormat::Convert({ 0x6A, 0x6C, 0x6E }, forward, reversed), Expected({ 0x6E, 0x6C, 0x6A }));
     EXPECT_EQ(PixelFormat::Convert({ 0x6E, 0x6C, 0x6A }, reversed, forward), Expected({ 0x6A, 0x6C, 0x6E }));
 }
+
+static uint8_t
+ExpectedPremultiply(uint8_t value, uint8_t alpha)
+{
+    float v = (value / 255.0);
+    float a = (alpha / 255.0);
+    return std::round((v * a) * 255.0);
+}
+
+TEST(PixelFormat, ConvertGrayscaleAlphaPremultiplied)
+{
+    PixelFormat normal = PixelFormat(PixelFormat::Color::Grayscale, PixelFormat::Order::Forward, PixelFormat::Alpha::Last);
+    PixelFormat premult = PixelFormat(PixelFormat::Color::Grayscale, PixelFormat::Order::Reversed, PixelFormat::Alpha::PremultipliedFirst);
+
+    /* Every combination of gray and alpha. */
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> expected;
+    for (int alpha = 0; alpha <= 0xFF; ++alpha) {
+        for (int value = 0; value <= 0xFF; ++value) {
+            pixels.push_back(value);
+            pixels.push_back(alpha);
+            expected.push_back(ExpectedPremultiply(value, alpha));
+            expected.push_back(alpha);
+        }
+    }
+
+    /* Includes pixels left over after whole vectors. */
+    pixels.insert(pixels.end(), { 0x60, 0x7F, 0x80, 0x40, 0xFF, 0x00 });
+    expected.insert(expected.end(), { 0x30, 0x7F, 0x20, 0x40, 0x00, 0x00 });
+
+    EXPECT_EQ(PixelFormat::Convert(pixels, normal, premult), expected);
+}
+
+TEST(PixelFormat, ConvertColorPremultiplied)
+{
+    PixelFormat rgba = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Forward, PixelFormat::Alpha::Last);
+    PixelFormat rgb = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Forward, PixelFormat::Alpha::None);
+    PixelFormat bgra = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Reversed, PixelFormat::Alpha::PremultipliedFirst);
+
+    /* An odd number of pixels, so some are left over after whole vectors. */
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> expected;
+    uint32_t seed = 1;
+    for (size_t i = 0; i < 37; ++i) {
+        uint8_t channels[4];
+        for (uint8_t &channel : channels) {
+            seed = seed * 1103515245 + 12345;
+            channel = (seed >> 16);
+        }
+        channels[3] = (i % 5 == 0 ? 0xFF : i % 7 == 0 ? 0x00 : channels[3]);
+
+        pixels.insert(pixels.end(), channels, channels + 4);
+        expected.push_back(ExpectedPremultiply(channels[2], channels[3]));
+        expected.push_back(ExpectedPremultiply(channels[1], channels[3]));
+        expected.push_back(ExpectedPremultiply(channels[0], channels[3]));
+        expected.push_back(channels[3]);
+    }
+    EXPECT_EQ(PixelFormat::Convert(pixels, rgba, bgra), expected);
+
+    /* Without alpha, colors are unchanged and become opaque. */
+    std::vector<uint8_t> opaquePixels;
+    std::vector<uint8_t> opaqueExpected;
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        opaquePixels.insert(opaquePixels.end(), { pixels[i + 0], pixels[i + 1], pixels[i + 2] });
+        opaqueExpected.insert(opaqueExpected.end(), { pixels[i + 2], pixels[i + 1], pixels[i + 0], 0xFF });
+    }
+    EXPECT_EQ(PixelFormat::Convert(opaquePixels, rgb, bgra), opaqueExpected);
+}
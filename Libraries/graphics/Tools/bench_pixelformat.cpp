@@ -0,0 +1,111 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <graphics/PixelFormat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using graphics::PixelFormat;
+
+struct Conversion {
+    std::string name;
+    PixelFormat from;
+    PixelFormat to;
+};
+
+/*
+ * Pseudo-random pixels, so alpha takes every value and nothing is
+ * uniformly opaque or transparent.
+ */
+static std::vector<uint8_t>
+Pixels(size_t size)
+{
+    std::vector<uint8_t> pixels = std::vector<uint8_t>(size);
+    uint32_t seed = 1;
+    for (uint8_t &byte : pixels) {
+        seed = seed * 1103515245 + 12345;
+        byte = (seed >> 16);
+    }
+    return pixels;
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc != 1 && argc != 2) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    int iterations = (argc == 2 ? std::max(1, atoi(argv[1])) : 20);
+
+    PixelFormat rgba = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Forward, PixelFormat::Alpha::Last);
+    PixelFormat rgb = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Forward, PixelFormat::Alpha::None);
+    PixelFormat bgra = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Reversed, PixelFormat::Alpha::PremultipliedFirst);
+    PixelFormat ga = PixelFormat(PixelFormat::Color::Grayscale, PixelFormat::Order::Forward, PixelFormat::Alpha::Last);
+    PixelFormat ag = PixelFormat(PixelFormat::Color::Grayscale, PixelFormat::Order::Reversed, PixelFormat::Alpha::PremultipliedFirst);
+    PixelFormat argb = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Forward, PixelFormat::Alpha::PremultipliedFirst);
+
+    /*
+     * The conversions asset catalog compilation uses, plus one without a
+     * specialized kernel for comparison.
+     */
+    std::vector<Conversion> conversions = {
+        { "rgba-bgra", rgba, bgra },
+        { "rgb-bgra", rgb, bgra },
+        { "ga-ga", ga, ag },
+        { "rgba-argb", rgba, argb },
+    };
+
+    /*
+     * Icon sizes, then launch image sizes.
+     */
+    std::vector<std::pair<size_t, size_t>> sizes = {
+        { 29, 29 },
+        { 60, 60 },
+        { 180, 180 },
+        { 1024, 1024 },
+        { 750, 1334 },
+        { 1242, 2208 },
+        { 2048, 2732 },
+    };
+
+    printf("%d iterations\n\n", iterations);
+    printf("%-12s %12s %12s %10s\n", "conversion", "size", "ms", "MP/s");
+
+    size_t checksum = 0;
+    for (Conversion const &conversion : conversions) {
+        for (auto const &size : sizes) {
+            size_t count = size.first * size.second;
+            std::vector<uint8_t> pixels = Pixels(count * conversion.from.bytesPerPixel());
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                std::vector<uint8_t> result = PixelFormat::Convert(pixels, conversion.from, conversion.to);
+                checksum += result[result.size() / 2];
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+            double throughput = (ms != 0 ? (count / 1000000.0) / (ms / 1000.0) : 0.0);
+            std::string dimensions = std::to_string(size.first) + "x" + std::to_string(size.second);
+            printf("%-12s %12s %12.3f %10.1f\n", conversion.name.c_str(), dimensions.c_str(), ms, throughput);
+        }
+    }
+
+    /* Keep the conversions from being optimized out. */
+    printf("\nchecksum %zu\n", checksum);
+
+    return 0;
+}
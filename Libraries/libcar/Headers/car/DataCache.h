@@ -0,0 +1,110 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef _LIBCAR_DATACACHE_H
+#define _LIBCAR_DATACACHE_H
+
+#include <car/Rendition.h>
+#include <ext/optional>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace car {
+
+/*
+ * Decoded rendition data, keyed by the archive a rendition was loaded from
+ * and the offset of the serialized rendition within it. Holds at most a
+ * fixed number of bytes of data, evicting the least recently used data
+ * first. Safe to use from multiple threads, and may be shared by readers.
+ */
+class DataCache {
+public:
+    typedef std::shared_ptr<DataCache> shared_ptr;
+
+private:
+    typedef std::pair<void const *, size_t> Key;
+
+    struct KeyHash {
+        size_t operator()(Key const &key) const
+        { return std::hash<void const *>()(key.first) ^ (std::hash<size_t>()(key.second) * 31); }
+    };
+
+    typedef std::list<std::pair<Key, Rendition::Data>> EntryList;
+
+private:
+    size_t                                                  _capacity;
+
+private:
+    mutable std::mutex                                      _mutex;
+    EntryList                                               _entries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash>   _index;
+    size_t                                                  _size;
+    size_t                                                  _hits;
+    size_t                                                  _misses;
+
+public:
+    explicit DataCache(size_t capacity);
+
+public:
+    /*
+     * The most bytes of decoded data to hold.
+     */
+    size_t capacity() const
+    { return _capacity; }
+
+    /*
+     * The bytes of decoded data held.
+     */
+    size_t size() const;
+
+public:
+    /*
+     * Number of lookups that found decoded data.
+     */
+    size_t hits() const;
+
+    /*
+     * Number of lookups that had to decode.
+     */
+    size_t misses() const;
+
+public:
+    /*
+     * Find the decoded data for the serialized rendition at an offset in an
+     * archive, decoding it with the provided function if it's not already
+     * held. The archive is any pointer identifying where the data is from.
+     */
+    ext::optional<Rendition::Data> lookup(
+        void const *archive,
+        size_t offset,
+        std::function<ext::optional<Rendition::Data>()> const &decode);
+
+    /*
+     * Forget the decoded data from an archive. Must be called before the
+     * archive goes away, as its identity may be reused.
+     */
+    void clear(void const *archive);
+
+    /*
+     * Forget all decoded data.
+     */
+    void clear();
+
+private:
+    void evict();
+};
+
+}
+
+#endif /* _LIBCAR_DATACACHE_H */
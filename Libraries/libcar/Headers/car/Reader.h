@@ -11,6 +11,7 @@
 #define _LIBCAR_READER_H
 
 #include <car/AttributeList.h>
+#include <car/DataCache.h>
 #include <bom/bom.h>
 #include <ext/optional>
 
@@ -19,6 +20,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <utility>
 
 namespace car {
 
@@ -45,15 +47,39 @@ private:
     unique_ptr_bom                                  _bom;
     ext::optional<struct car_key_format *>          _keyfmt;
     std::unordered_map<std::string, void *>         _facetValues;
-    std::unordered_multimap<uint16_t, KeyValuePair> _renditionValues;
+
+    /*
+     * Renditions sorted by facet identifier, so the renditions for a facet
+     * can be found without allocating or loading any keys.
+     */
+    std::vector<std::pair<uint16_t, KeyValuePair>>  _renditionValues;
+
+private:
+    DataCache::shared_ptr                           _dataCache;
 
 private:
     Reader(unique_ptr_bom bom);
 
+public:
+    Reader(Reader &&other);
+    Reader &operator=(Reader &&other);
+    ~Reader();
+
 public:
     void facetFastIterate(std::function<void(void *key, size_t key_len, void *value, size_t value_len)> const &facet) const;
     void renditionFastIterate(std::function<void(void *key, size_t key_len, void *value, size_t value_len)> const &iterator) const;
 
+    /*
+     * Iterate the keys and values of the renditions for a facet identifier.
+     */
+    void renditionFastLookup(uint16_t identifier, std::function<void(void *key, size_t key_len, void *value, size_t value_len)> const &iterator) const;
+
+    /*
+     * The value of an attribute in a rendition key, without loading the
+     * key into an attribute list.
+     */
+    ext::optional<uint16_t> renditionKeyAttribute(void const *key, enum car_attribute_identifier identifier) const;
+
 public:
     /*
      * The BOM backing this archive.
@@ -79,6 +105,18 @@ public:
      int renditionCount() const
      { return _renditionValues.size(); }
 
+public:
+    /*
+     * A cache for the decoded data of renditions loaded from this archive.
+     * Without a cache, rendition data is decoded each time it is accessed.
+     * The cache may be shared with other readers; data from this archive is
+     * removed from it when the reader is destroyed.
+     */
+    DataCache::shared_ptr const &dataCache() const
+    { return _dataCache; }
+    DataCache::shared_ptr &dataCache()
+    { return _dataCache; }
+
 public:
     /*
      * Iterate all facets.
@@ -15,9 +15,11 @@
 
 #include <string>
 #include <functional>
+#include <memory>
 
 namespace car {
 
+class DataCache;
 class Reader;
 
 /*
@@ -86,6 +88,29 @@ public:
         HorizontalScaleVerticalUniform,
     };
 
+public:
+    /*
+     * How pixel data is compressed when the rendition is written.
+     */
+    enum class Compression {
+        /*
+         * zlib, with the gzip wrapper. Level 0 stores the data uncompressed.
+         */
+        Zlib,
+        /*
+         * LZVN and LZFSE. Only available with the system compression
+         * library, as no portable encoder is included; elsewhere, zlib
+         * is used instead, with a warning.
+         */
+        LZVN,
+        LZFSE,
+    };
+
+    /*
+     * If a compression algorithm can be used for writing on this system.
+     */
+    static bool CompressionAvailable(Compression compression);
+
 public:
     struct Slice {
         uint32_t x;
@@ -114,6 +139,12 @@ private:
     enum car_rendition_value_layout _layout;
     ext::optional<std::string>      _UTI;
 
+private:
+    Compression                     _compression;
+    ext::optional<int>              _compressionLevel;
+    ext::optional<size_t>           _compressionThreads;
+    bool                            _compressionChunked;
+
 private:
     Rendition(AttributeList const &attributes, std::function<ext::optional<Data>(Rendition const *)> const &data);
     Rendition(AttributeList const &attributes, ext::optional<Data> const &data);
@@ -217,6 +248,43 @@ public:
     std::vector<Slice> &slices()
     { return _slices; }
 
+public:
+    /*
+     * The algorithm to compress pixel data with when writing.
+     */
+    Compression compression() const
+    { return _compression; }
+    Compression &compression()
+    { return _compression; }
+
+    /*
+     * The compression level, if the algorithm has levels. Uses the
+     * algorithm's default level if not set.
+     */
+    ext::optional<int> const &compressionLevel() const
+    { return _compressionLevel; }
+    ext::optional<int> &compressionLevel()
+    { return _compressionLevel; }
+
+    /*
+     * The most threads to compress large pixel data on. Uses one per CPU
+     * if not set; set it when already writing renditions in parallel.
+     */
+    ext::optional<size_t> const &compressionThreads() const
+    { return _compressionThreads; }
+    ext::optional<size_t> &compressionThreads()
+    { return _compressionThreads; }
+
+    /*
+     * If large pixel data is split into chunks compressed independently,
+     * and in parallel. Off by default: the chunk headers written have not
+     * been verified against what CoreUI expects.
+     */
+    bool compressionChunked() const
+    { return _compressionChunked; }
+    bool &compressionChunked()
+    { return _compressionChunked; }
+
 public:
     /*
      * The rendition pixel data. May incur expensive decoding.
@@ -237,11 +305,16 @@ public:
 
 public:
     /*
-     * Load an existing rendition matching the provided attributes.
+     * Load an existing rendition matching the provided attributes. If a
+     * cache is provided, decoded data is shared through it, identified by
+     * the archive and offset the rendition was loaded from.
      */
     static Rendition const Load(
         AttributeList const &attributes,
-        struct car_rendition_value *value);
+        struct car_rendition_value *value,
+        std::shared_ptr<DataCache> const &cache = nullptr,
+        void const *archive = nullptr,
+        size_t offset = 0);
 
 public:
     /*
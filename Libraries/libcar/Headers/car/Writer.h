@@ -45,6 +45,7 @@ private:
     std::unordered_map<std::string, Facet> _facets;
     std::unordered_multimap<uint16_t, Rendition> _renditions;
     std::vector<KeyValuePair> _rawRenditions;
+    std::vector<std::pair<AttributeList, std::vector<uint8_t>>> _encodedRenditions;
 
 private:
     Writer(unique_ptr_bom bom);
@@ -67,6 +68,11 @@ public:
      */
     void addRendition(Rendition const &rendition);
 
+    /*
+     * Add a rendition for a facet, already serialized with `Rendition::write()`.
+     */
+    void addRendition(AttributeList const &attributes, std::vector<uint8_t> const &value);
+
     /*
      * Add a rendition for a facet, optimized for fast editing of CAR files
      */
@@ -0,0 +1,118 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <car/DataCache.h>
+
+using car::DataCache;
+using car::Rendition;
+
+DataCache::
+DataCache(size_t capacity) :
+    _capacity(capacity),
+    _size    (0),
+    _hits    (0),
+    _misses  (0)
+{
+}
+
+size_t DataCache::
+size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+size_t DataCache::
+hits() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+size_t DataCache::
+misses() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+ext::optional<Rendition::Data> DataCache::
+lookup(void const *archive, size_t offset, std::function<ext::optional<Rendition::Data>()> const &decode)
+{
+    Key key = Key(archive, offset);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _index.find(key);
+        if (it != _index.end()) {
+            _hits++;
+
+            /* Most recently used data is kept at the front. */
+            _entries.splice(_entries.begin(), _entries, it->second);
+            return it->second->second;
+        }
+
+        _misses++;
+    }
+
+    /*
+     * Decode without holding the lock, so other renditions can be decoded
+     * at the same time. If two threads decode the same rendition, the data
+     * is only held once.
+     */
+    ext::optional<Rendition::Data> data = decode();
+    if (!data || data->data().size() > _capacity) {
+        return data;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_index.find(key) == _index.end()) {
+        _entries.push_front({ key, *data });
+        _index.insert({ key, _entries.begin() });
+        _size += data->data().size();
+        evict();
+    }
+
+    return data;
+}
+
+void DataCache::
+clear(void const *archive)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->first.first == archive) {
+            _size -= it->second.data().size();
+            _index.erase(it->first);
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DataCache::
+clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _index.clear();
+    _size = 0;
+}
+
+void DataCache::
+evict()
+{
+    while (_size > _capacity && !_entries.empty()) {
+        _size -= _entries.back().second.data().size();
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+}
@@ -12,6 +12,7 @@
 #include <car/Rendition.h>
 #include <car/car_format.h>
 
+#include <algorithm>
 #include <limits>
 #include <random>
 
@@ -28,10 +29,55 @@ Reader(unique_ptr_bom bom) :
     _bom(std::move(bom)),
     _keyfmt(ext::nullopt),
     _facetValues({ }),
-    _renditionValues({ })
+    _renditionValues({ }),
+    _dataCache(nullptr)
 {
 }
 
+Reader::
+Reader(Reader &&other) :
+    _bom(std::move(other._bom)),
+    _keyfmt(std::move(other._keyfmt)),
+    _facetValues(std::move(other._facetValues)),
+    _renditionValues(std::move(other._renditionValues)),
+    _dataCache(std::move(other._dataCache))
+{
+}
+
+Reader &Reader::
+operator=(Reader &&other)
+{
+    if (_dataCache != nullptr && _bom != nullptr) {
+        _dataCache->clear(_bom.get());
+    }
+
+    _bom = std::move(other._bom);
+    _keyfmt = std::move(other._keyfmt);
+    _facetValues = std::move(other._facetValues);
+    _renditionValues = std::move(other._renditionValues);
+    _dataCache = std::move(other._dataCache);
+    return *this;
+}
+
+Reader::
+~Reader()
+{
+    /* The BOM's address may be reused by another archive. */
+    if (_dataCache != nullptr && _bom != nullptr) {
+        _dataCache->clear(_bom.get());
+    }
+}
+
+/*
+ * Offset of a rendition value in the archive, used with the archive's BOM to
+ * identify the rendition's data in a shared cache.
+ */
+static size_t
+ValueOffset(struct bom_context const *bom, void const *value)
+{
+    return reinterpret_cast<uintptr_t>(value) - reinterpret_cast<uintptr_t>(bom_memory(bom)->data);
+}
+
 struct _car_iterator_ctx {
     Reader const *reader;
     void *iterator;
@@ -87,7 +133,7 @@ renditionIterate(std::function<void(Rendition const &)> const &iterator) const
         car_rendition_key *rendition_key = (car_rendition_key *)kv.key;
         struct car_rendition_value *rendition_value = (struct car_rendition_value *)kv.value;
         AttributeList attributes = AttributeList::Load(keyfmt->num_identifiers, keyfmt->identifier_list, rendition_key);
-        Rendition rendition = Rendition::Load(attributes, rendition_value);
+        Rendition rendition = Rendition::Load(attributes, rendition_value, _dataCache, _bom.get(), ValueOffset(_bom.get(), rendition_value));
         iterator(rendition);
     }
 }
@@ -105,6 +151,42 @@ renditionFastIterate(std::function<void(void *key, size_t key_len, void *value,
     _car_tree_iterator(this, car_renditions_variable, _car_rendition_fast_iterator, const_cast<void *>(reinterpret_cast<void const *>(&iterator)));
 }
 
+template<typename T>
+static bool
+RenditionIdentifierLess(T const &lhs, T const &rhs)
+{
+    return lhs.first < rhs.first;
+}
+
+void Reader::
+renditionFastLookup(uint16_t identifier, std::function<void(void *key, size_t key_len, void *value, size_t value_len)> const &iterator) const
+{
+    std::pair<uint16_t, KeyValuePair> search;
+    search.first = identifier;
+
+    auto range = std::equal_range(_renditionValues.begin(), _renditionValues.end(), search, RenditionIdentifierLess<std::pair<uint16_t, KeyValuePair>>);
+    for (auto it = range.first; it != range.second; ++it) {
+        iterator(it->second.key, it->second.key_len, it->second.value, it->second.value_len);
+    }
+}
+
+ext::optional<uint16_t> Reader::
+renditionKeyAttribute(void const *key, enum car_attribute_identifier identifier) const
+{
+    if (!_keyfmt) {
+        return ext::nullopt;
+    }
+
+    car_rendition_key const *rendition_key = static_cast<car_rendition_key const *>(key);
+    for (uint32_t i = 0; i < (*_keyfmt)->num_identifiers; i++) {
+        if ((*_keyfmt)->identifier_list[i] == identifier) {
+            return rendition_key[i];
+        }
+    }
+
+    return ext::nullopt;
+}
+
 void Reader::
 dump() const
 {
@@ -223,9 +305,12 @@ Load(unique_ptr_bom bom)
         kv.value = value;
         kv.value_len = value_len;
         car_rendition_key *rendition_key = (car_rendition_key *)key;
-        reader._renditionValues.insert({ rendition_key[identifier_index], kv });
+        reader._renditionValues.push_back({ rendition_key[identifier_index], kv });
     });
 
+    /* Keep the archive's order for the renditions of each facet. */
+    std::stable_sort(reader._renditionValues.begin(), reader._renditionValues.end(), RenditionIdentifierLess<std::pair<uint16_t, KeyValuePair>>);
+
     return std::move(reader);
 }
 
@@ -263,15 +348,13 @@ lookupRenditions(Facet const &facet) const
     }
 
     auto keyfmt = *_keyfmt;
-    auto lookupRendition = _renditionValues.equal_range(*facet_identifier);
-    for (auto it = lookupRendition.first; it != lookupRendition.second; ++it) {
-        KeyValuePair value = (KeyValuePair)it->second;
-        car_rendition_key *rendition_key = (car_rendition_key *)value.key;
-        struct car_rendition_value *rendition_value = (struct car_rendition_value *)value.value;
+    renditionFastLookup(*facet_identifier, [this, keyfmt, &result](void *key, size_t key_len, void *value, size_t value_len) {
+        car_rendition_key *rendition_key = (car_rendition_key *)key;
+        struct car_rendition_value *rendition_value = (struct car_rendition_value *)value;
         AttributeList attributes = AttributeList::Load(keyfmt->num_identifiers, keyfmt->identifier_list, rendition_key);
-        Rendition rendition = Rendition::Load(attributes, rendition_value);
+        Rendition rendition = Rendition::Load(attributes, rendition_value, _dataCache, _bom.get(), ValueOffset(_bom.get(), rendition_value));
         result.push_back(rendition);
-    }
+    });
     return result;
 }
 
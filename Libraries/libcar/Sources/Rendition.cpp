@@ -8,12 +8,17 @@
  */
 
 #include <car/Rendition.h>
+#include <car/DataCache.h>
 #include <car/Reader.h>
 #include <car/car_format.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
+#include <mutex>
+#include <thread>
 
 #include <zlib.h>
 
@@ -57,27 +62,31 @@ FormatSize(Rendition::Data::Format format)
 
 Rendition::
 Rendition(AttributeList const &attributes, std::function<ext::optional<Data>(Rendition const *)> const &data) :
-    _attributes  (attributes),
-    _deferredData(data),
-    _width       (0),
-    _height      (0),
-    _scale       (1.0),
-    _isVector    (false),
-    _isOpaque    (false),
-    _isResizable (false)
+    _attributes        (attributes),
+    _deferredData      (data),
+    _width             (0),
+    _height            (0),
+    _scale             (1.0),
+    _isVector          (false),
+    _isOpaque          (false),
+    _isResizable       (false),
+    _compression       (Compression::Zlib),
+    _compressionChunked(false)
 {
 }
 
 Rendition::
 Rendition(AttributeList const &attributes, ext::optional<Data> const &data) :
-    _attributes (attributes),
-    _data       (data),
-    _width      (0),
-    _height     (0),
-    _scale      (1.0),
-    _isVector   (false),
-    _isOpaque   (false),
-    _isResizable(false)
+    _attributes        (attributes),
+    _data              (data),
+    _width             (0),
+    _height            (0),
+    _scale             (1.0),
+    _isVector          (false),
+    _isOpaque          (false),
+    _isResizable       (false),
+    _compression       (Compression::Zlib),
+    _compressionChunked(false)
 {
 }
 
@@ -167,9 +176,18 @@ ResizeModeFromLayout(enum car_rendition_value_layout layout)
 Rendition const Rendition::
 Load(
     AttributeList const &attributes,
-    struct car_rendition_value *value)
+    struct car_rendition_value *value,
+    std::shared_ptr<DataCache> const &cache,
+    void const *archive,
+    size_t offset)
 {
-    Rendition rendition = Rendition(attributes, [value](Rendition const *rendition) -> ext::optional<Data> {
+    Rendition rendition = Rendition(attributes, [value, cache, archive, offset](Rendition const *rendition) -> ext::optional<Data> {
+        if (cache != nullptr) {
+            return cache->lookup(archive, offset, [value]() {
+                return Decode(value);
+            });
+        }
+
         return Decode(value);
     });
 
@@ -337,7 +355,10 @@ Decode(struct car_rendition_value *value)
     while (offset < uncompressed_length) {
         if (offset != 0) {
             struct car_rendition_data_header2 *header2 = (struct car_rendition_data_header2 *)compressed_data;
-            assert(strncmp(header2->magic, "KCBC", sizeof(header2->magic)) == 0);
+            if (strncmp(header2->magic, "KCBC", sizeof(header2->magic)) != 0) {
+                fprintf(stderr, "error: expected another chunk of compressed data\n");
+                return ext::nullopt;
+            }
             compressed_length = header2->length;
             compressed_data = header2->data;
         }
@@ -355,21 +376,26 @@ Decode(struct car_rendition_value *value)
                return ext::nullopt;
             }
 
-            strm.avail_out = uncompressed_length;
-            strm.next_out = (Bytef *)uncompressed_data;
+            strm.avail_out = uncompressed_length - offset;
+            strm.next_out = (Bytef *)uncompressed_data + offset;
 
             ret = inflate(&strm, Z_NO_FLUSH);
             if (ret != Z_OK && ret != Z_STREAM_END) {
                 printf("error: decompression failure: %x.\n", ret);
+                inflateEnd(&strm);
                 return ext::nullopt;
             }
 
+            size_t decompressed_length = (uncompressed_length - offset) - strm.avail_out;
+
             ret = inflateEnd(&strm);
-            if (ret != Z_OK) {
+            if (ret != Z_OK || decompressed_length == 0) {
                 return ext::nullopt;
             }
 
-            offset += (uncompressed_length - strm.avail_out);
+            /* Each chunk is a separate stream. */
+            offset += decompressed_length;
+            compressed_data = (void *)((uintptr_t)compressed_data + compressed_length);
         } else if (header1->compression == car_rendition_data_compression_magic_rle) {
             fprintf(stderr, "error: unable to handle RLE\n");
             return ext::nullopt;
@@ -413,6 +439,111 @@ Decode(struct car_rendition_value *value)
     return data;
 }
 
+bool Rendition::
+CompressionAvailable(Compression compression)
+{
+    switch (compression) {
+        case Compression::Zlib:
+            return true;
+        case Compression::LZVN:
+        case Compression::LZFSE:
+#if HAVE_LIBCOMPRESSION
+            return true;
+#else
+            return false;
+#endif
+    }
+
+    abort();
+}
+
+static bool
+CompressChunk(Rendition::Compression compression, ext::optional<int> const &level, uint8_t const *data, size_t length, std::vector<uint8_t> *output)
+{
+    switch (compression) {
+        case Rendition::Compression::Zlib: {
+            z_stream zlibStream;
+            memset(&zlibStream, 0, sizeof(zlibStream));
+            int err = deflateInit2(&zlibStream, level.value_or(Z_DEFAULT_COMPRESSION), Z_DEFLATED, 16+MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+            if (err != Z_OK) {
+                return false;
+            }
+
+            /* Compress in one step into a buffer large enough for any input. */
+            output->resize(deflateBound(&zlibStream, length));
+            zlibStream.next_in = (Bytef *)data;
+            zlibStream.avail_in = (uInt)length;
+            zlibStream.next_out = (Bytef *)output->data();
+            zlibStream.avail_out = (uInt)output->size();
+
+            err = deflate(&zlibStream, Z_FINISH);
+            output->resize(output->size() - zlibStream.avail_out);
+            deflateEnd(&zlibStream);
+
+            if (err != Z_STREAM_END) {
+                fprintf(stderr, "Zlib error %d", err);
+                return false;
+            }
+
+            return true;
+        }
+        case Rendition::Compression::LZVN:
+        case Rendition::Compression::LZFSE: {
+#if HAVE_LIBCOMPRESSION
+            compression_algorithm algorithm = compression == Rendition::Compression::LZVN ?
+                (compression_algorithm)_COMPRESSION_LZVN :
+                COMPRESSION_LZFSE;
+
+            /* Incompressible data expands slightly; allow for that. */
+            output->resize(length + length / 16 + 1024);
+            size_t compressed_length = compression_encode_buffer(output->data(), output->size(), data, length, NULL, algorithm);
+            output->resize(compressed_length);
+            return (compressed_length != 0);
+#else
+            return false;
+#endif
+        }
+    }
+
+    abort();
+}
+
+static char const *
+CompressionName(Rendition::Compression compression)
+{
+    switch (compression) {
+        case Rendition::Compression::Zlib:
+            return "zlib";
+        case Rendition::Compression::LZVN:
+            return "LZVN";
+        case Rendition::Compression::LZFSE:
+            return "LZFSE";
+    }
+
+    abort();
+}
+
+static enum car_rendition_data_compression_magic
+CompressionMagic(Rendition::Compression compression)
+{
+    switch (compression) {
+        case Rendition::Compression::Zlib:
+            return car_rendition_data_compression_magic_zlib;
+        case Rendition::Compression::LZVN:
+            return car_rendition_data_compression_magic_lzvn;
+        case Rendition::Compression::LZFSE:
+            return car_rendition_data_compression_magic_jpeg_lzfse;
+    }
+
+    abort();
+}
+
+/*
+ * When chunking, pixel data larger than this is split into chunks of whole
+ * rows, which are compressed independently and so can be compressed in parallel.
+ */
+static size_t const EncodeChunkSize = 1024 * 1024;
+
 static ext::optional<std::vector<uint8_t>>
 Encode(Rendition const *rendition, ext::optional<Rendition::Data> data)
 {
@@ -427,52 +558,94 @@ Encode(Rendition const *rendition, ext::optional<Rendition::Data> data)
         return data->data();
     }
 
-    // The selected algorithm, only zlib for now
-    enum car_rendition_data_compression_magic compression_magic = car_rendition_data_compression_magic_zlib;
+    Rendition::Compression compression = rendition->compression();
+    ext::optional<int> level = rendition->compressionLevel();
+    if (!Rendition::CompressionAvailable(compression)) {
+        static std::once_flag warned;
+        std::call_once(warned, [compression]() {
+            fprintf(stderr, "warning: %s compression is not available, using zlib instead\n", CompressionName(compression));
+        });
+
+        compression = Rendition::Compression::Zlib;
+        level = ext::nullopt;
+    }
+
     size_t bytes_per_pixel = Rendition::Data::FormatSize(data->format());
+    size_t bytes_per_row = rendition->width() * bytes_per_pixel;
 
     size_t uncompressed_length = rendition->width() * rendition->height() * bytes_per_pixel;
-    void *uncompressed_data = static_cast<void *>(data->data().data());
-
-    std::vector<uint8_t> compressed_vector;
-    if (compression_magic == car_rendition_data_compression_magic_zlib) {
-        int deflateLevel = Z_DEFAULT_COMPRESSION;
-        int windowSize = 16+MAX_WBITS;
-        z_stream zlibStream;
-        memset(&zlibStream, 0, sizeof(zlibStream));
-        zlibStream.next_in = (Bytef*)uncompressed_data;
-        zlibStream.avail_in = (uInt)uncompressed_length;
-        int err = deflateInit2(&zlibStream, deflateLevel, Z_DEFLATED, windowSize, 8, Z_DEFAULT_STRATEGY);
-        if (err != Z_OK) {
+    uint8_t const *uncompressed_data = data->data().data();
+
+    /*
+     * Split into chunks of whole rows, if enabled. A single chunk is written
+     * without a chunk header, for compatibility with readers that don't
+     * expect one.
+     */
+    size_t chunk_length = uncompressed_length;
+    if (rendition->compressionChunked()) {
+        size_t rows_per_chunk = std::max<size_t>(1, EncodeChunkSize / std::max<size_t>(1, bytes_per_row));
+        chunk_length = rows_per_chunk * bytes_per_row;
+    }
+    size_t nchunks = (uncompressed_length + chunk_length - 1) / chunk_length;
+
+    std::vector<std::vector<uint8_t>> chunks = std::vector<std::vector<uint8_t>>(nchunks);
+    std::vector<char> succeeded = std::vector<char>(nchunks, false);
+
+    auto compress = [&](Rendition::Compression compression, ext::optional<int> const &level) {
+        std::atomic<size_t> next = ATOMIC_VAR_INIT(0);
+        auto worker = [&]() {
+            for (size_t index = next++; index < nchunks; index = next++) {
+                size_t offset = index * chunk_length;
+                size_t length = std::min(chunk_length, uncompressed_length - offset);
+                succeeded[index] = CompressChunk(compression, level, uncompressed_data + offset, length, &chunks[index]);
+            }
+        };
+
+        size_t threads_limit = rendition->compressionThreads().value_or(std::thread::hardware_concurrency());
+        size_t workers = std::min<size_t>(std::max<size_t>(1, threads_limit), nchunks);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workers; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        return std::all_of(succeeded.begin(), succeeded.end(), [](char success) { return success; });
+    };
+
+    if (!compress(compression, level)) {
+        if (compression == Rendition::Compression::Zlib) {
             return ext::nullopt;
         }
-        while (true) {
-            uint8_t tmp[4096];
-            zlibStream.next_out = (Bytef*)&tmp;
-            zlibStream.avail_out = (uInt)sizeof(tmp);
-            err = deflate(&zlibStream, Z_FINISH);
-            size_t block_size = sizeof(tmp) - zlibStream.avail_out;
-            compressed_vector.resize(compressed_vector.size() + block_size);
-            memcpy(&compressed_vector[compressed_vector.size() - block_size], &tmp[0], block_size);
-            if (err == Z_STREAM_END) {  /* Done */
-                break;
-            }
-            if (err != Z_OK) {  /* Z_OK -> Made progress, else err */
-                deflateEnd(&zlibStream);
-                fprintf(stderr, "Zlib error %d", err);
-                return ext::nullopt;
-            }
+
+        /* Fall back to zlib, which can always compress. */
+        compression = Rendition::Compression::Zlib;
+        if (!compress(compression, ext::nullopt)) {
+            return ext::nullopt;
         }
-        deflateEnd(&zlibStream);
     }
 
     std::vector<uint8_t> output = std::vector<uint8_t>(sizeof(struct car_rendition_data_header1));
+    for (std::vector<uint8_t> const &chunk : chunks) {
+        if (nchunks > 1) {
+            struct car_rendition_data_header2 header2;
+            memset(&header2, 0, sizeof(header2));
+            memcpy(header2.magic, "KCBC", sizeof(header2.magic));
+            header2.length = chunk.size();
+
+            uint8_t const *header2_bytes = reinterpret_cast<uint8_t const *>(&header2);
+            output.insert(output.end(), header2_bytes, header2_bytes + sizeof(header2));
+        }
+
+        output.insert(output.end(), chunk.begin(), chunk.end());
+    }
 
     struct car_rendition_data_header1 *header1 = reinterpret_cast<struct car_rendition_data_header1 *>(output.data());
     memcpy(header1->magic, "MLEC", sizeof(header1->magic));
-    header1->length = compressed_vector.size();
-    header1->compression = compression_magic;
-    output.insert(output.end(), compressed_vector.begin(), compressed_vector.end());
+    header1->length = output.size() - sizeof(struct car_rendition_data_header1);
+    header1->compression = CompressionMagic(compression);
 
     return output;
 }
@@ -10,6 +10,7 @@
 #include <car/Writer.h>
 #include <car/car_format.h>
 
+#include <algorithm>
 #include <random>
 #include <set>
 #include <unordered_set>
@@ -48,6 +49,14 @@ addRendition(Rendition const &rendition)
     }
 }
 
+void Writer::
+addRendition(AttributeList const &attributes, std::vector<uint8_t> const &value)
+{
+    if (attributes.get(car_attribute_identifier_identifier) != ext::nullopt) {
+        _encodedRenditions.push_back({ attributes, value });
+    }
+}
+
 void Writer::
 addRendition(void *key, size_t key_len, void *value, size_t value_len)
 {
@@ -58,7 +67,8 @@ addRendition(void *key, size_t key_len, void *value, size_t value_len)
 static std::vector<enum car_attribute_identifier>
 DetermineKeyFormat(
     std::unordered_map<std::string, Facet> const &facets,
-    std::unordered_multimap<uint16_t, Rendition> const &renditions)
+    std::unordered_multimap<uint16_t, Rendition> const &renditions,
+    std::vector<std::pair<car::AttributeList, std::vector<uint8_t>>> const &encodedRenditions)
 {
     std::unordered_set<enum car_attribute_identifier> format;
     auto insert = [&format](enum car_attribute_identifier identifier, uint16_t value) {
@@ -73,6 +83,10 @@ DetermineKeyFormat(
         item.second.attributes().iterate(insert);
     }
 
+    for (auto const &item : encodedRenditions) {
+        item.first.iterate(insert);
+    }
+
     /* Sort attributes to preserve ordering. */
     auto ordered = std::set<enum car_attribute_identifier>(format.begin(), format.end());
     return std::vector<enum car_attribute_identifier>(ordered.begin(), ordered.end());
@@ -87,7 +101,7 @@ write() const
      * Each tree entry (facet or rendition) requires 2: one key index, one value index.
      */
     uint32_t facet_count = _facets.size();
-    uint32_t rendition_count = _renditions.size() + _rawRenditions.size();
+    uint32_t rendition_count = _renditions.size() + _encodedRenditions.size() + _rawRenditions.size();
     uint32_t bom_index_count = 6 + facet_count * 2 + rendition_count * 2;
     bom_index_reserve(_bom.get(), bom_index_count);
 
@@ -124,7 +138,7 @@ write() const
     struct car_key_format *keyfmt;
     size_t keyfmt_size;
     if (_keyfmt == ext::nullopt) {
-      std::vector<enum car_attribute_identifier> format = DetermineKeyFormat(_facets, _renditions);
+      std::vector<enum car_attribute_identifier> format = DetermineKeyFormat(_facets, _renditions, _encodedRenditions);
       keyfmt_size = sizeof(struct car_key_format) + (format.size() * sizeof(uint32_t));
       keyfmt = (struct car_key_format *)malloc(keyfmt_size);
       strncpy(keyfmt->magic, "tmfk", 4);
@@ -161,15 +175,52 @@ write() const
     struct bom_tree_context *renditions_tree_context = bom_tree_alloc_empty(_bom.get(), car_renditions_variable);
     bom_tree_reserve(renditions_tree_context, rendition_count);
     if (renditions_tree_context != NULL) {
+        /* Copied out of the packed key format once for all renditions. */
+        std::vector<uint32_t> identifiers;
+        identifiers.reserve(keyfmt->num_identifiers);
+        for (size_t i = 0; i < keyfmt->num_identifiers; ++i) {
+            identifiers.push_back(keyfmt->identifier_list[i]);
+        }
+
+        std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> written;
+        written.reserve(_renditions.size());
         for (auto const &item : _renditions) {
-            auto attributes_value = item.second.attributes().write(keyfmt->num_identifiers, keyfmt->identifier_list);
-            auto rendition_value = item.second.write();
+            written.push_back({ item.second.attributes().write(identifiers.size(), identifiers.data()), item.second.write() });
+        }
+
+        /*
+         * Renditions added already serialized are merged with the others,
+         * so the tree is in the same order however each was added.
+         */
+        std::vector<std::pair<std::vector<uint16_t>, std::vector<uint8_t> const *>> entries;
+        entries.reserve(written.size() + _encodedRenditions.size());
+        auto add = [&entries](std::vector<uint8_t> const &key, std::vector<uint8_t> const &value) {
+            std::vector<uint16_t> values = std::vector<uint16_t>(key.size() / sizeof(uint16_t));
+            memcpy(values.data(), key.data(), values.size() * sizeof(uint16_t));
+            entries.push_back({ values, &value });
+        };
+
+        for (auto const &item : written) {
+            add(item.first, item.second);
+        }
+        for (auto const &item : _encodedRenditions) {
+            add(item.first.write(identifiers.size(), identifiers.data()), item.second);
+        }
+
+        /* Order by the attribute values, in key format order. */
+        std::stable_sort(entries.begin(), entries.end(), [](
+            std::pair<std::vector<uint16_t>, std::vector<uint8_t> const *> const &lhs,
+            std::pair<std::vector<uint16_t>, std::vector<uint8_t> const *> const &rhs) {
+            return lhs.first < rhs.first;
+        });
+
+        for (auto const &entry : entries) {
             bom_tree_add(
                 renditions_tree_context,
-                reinterpret_cast<void const *>(attributes_value.data()),
-                attributes_value.size(),
-                reinterpret_cast<void const *>(rendition_value.data()),
-                rendition_value.size());
+                reinterpret_cast<void const *>(entry.first.data()),
+                entry.first.size() * sizeof(uint16_t),
+                reinterpret_cast<void const *>(entry.second->data()),
+                entry.second->size());
         }
         for (auto const &item : _rawRenditions) {
             bom_tree_add(
@@ -0,0 +1,97 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <car/DataCache.h>
+
+using car::DataCache;
+using car::Rendition;
+
+static std::function<ext::optional<Rendition::Data>()>
+Decoder(uint8_t value, int *decodes)
+{
+    return [value, decodes]() -> ext::optional<Rendition::Data> {
+        (*decodes)++;
+        return Rendition::Data(std::vector<uint8_t>(100, value), Rendition::Data::Format::Data);
+    };
+}
+
+TEST(DataCache, Lookup)
+{
+    DataCache cache(250);
+    int archive;
+    int decodes = 0;
+
+    /* Decoded once, then reused. */
+    EXPECT_EQ(std::vector<uint8_t>(100, 0), cache.lookup(&archive, 0, Decoder(0, &decodes))->data());
+    EXPECT_EQ(std::vector<uint8_t>(100, 0), cache.lookup(&archive, 0, Decoder(0, &decodes))->data());
+    EXPECT_EQ(1, decodes);
+    EXPECT_EQ(1, cache.hits());
+    EXPECT_EQ(1, cache.misses());
+    EXPECT_EQ(100, cache.size());
+
+    /* The least recently used data is evicted first. */
+    cache.lookup(&archive, 1, Decoder(1, &decodes));
+    cache.lookup(&archive, 0, Decoder(0, &decodes));
+    cache.lookup(&archive, 2, Decoder(2, &decodes));
+    EXPECT_EQ(3, decodes);
+    EXPECT_EQ(200, cache.size());
+
+    cache.lookup(&archive, 0, Decoder(0, &decodes));
+    EXPECT_EQ(3, decodes);
+    cache.lookup(&archive, 1, Decoder(1, &decodes));
+    EXPECT_EQ(4, decodes);
+
+    /* Failures are not held. */
+    int failures = 0;
+    auto fail = [&failures]() -> ext::optional<Rendition::Data> {
+        failures++;
+        return ext::nullopt;
+    };
+    EXPECT_EQ(ext::nullopt, cache.lookup(&archive, 3, fail));
+    EXPECT_EQ(ext::nullopt, cache.lookup(&archive, 3, fail));
+    EXPECT_EQ(2, failures);
+
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+}
+
+TEST(DataCache, Oversized)
+{
+    /* Data larger than the whole cache is returned but not held. */
+    DataCache cache(50);
+    int archive;
+    int decodes = 0;
+
+    EXPECT_NE(ext::nullopt, cache.lookup(&archive, 0, Decoder(0, &decodes)));
+    EXPECT_NE(ext::nullopt, cache.lookup(&archive, 0, Decoder(0, &decodes)));
+    EXPECT_EQ(2, decodes);
+    EXPECT_EQ(0, cache.size());
+}
+
+TEST(DataCache, Archives)
+{
+    DataCache cache(1000);
+    int archives[2];
+    int decodes = 0;
+
+    /* The same offset in different archives is different data. */
+    EXPECT_EQ(std::vector<uint8_t>(100, 0), cache.lookup(&archives[0], 0, Decoder(0, &decodes))->data());
+    EXPECT_EQ(std::vector<uint8_t>(100, 1), cache.lookup(&archives[1], 0, Decoder(1, &decodes))->data());
+    EXPECT_EQ(2, decodes);
+    EXPECT_EQ(200, cache.size());
+
+    /* Forgetting an archive leaves the others' data. */
+    cache.clear(&archives[0]);
+    EXPECT_EQ(100, cache.size());
+    EXPECT_EQ(std::vector<uint8_t>(100, 1), cache.lookup(&archives[1], 0, Decoder(1, &decodes))->data());
+    EXPECT_EQ(2, decodes);
+    EXPECT_EQ(std::vector<uint8_t>(100, 2), cache.lookup(&archives[0], 0, Decoder(2, &decodes))->data());
+    EXPECT_EQ(3, decodes);
+}
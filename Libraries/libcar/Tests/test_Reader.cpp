@@ -0,0 +1,167 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <bom/bom.h>
+#include <car/car_format.h>
+#include <car/AttributeList.h>
+#include <car/DataCache.h>
+#include <car/Facet.h>
+#include <car/Rendition.h>
+#include <car/Reader.h>
+#include <car/Writer.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static ext::optional<car::Reader>
+WriteRead(int facets, int scales, int seed = 0)
+{
+    auto writer = car::Writer::Create(car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free));
+    EXPECT_NE(writer, ext::nullopt);
+
+    for (int identifier = 1; identifier <= facets; identifier++) {
+        car::Facet facet = car::Facet::Create("facet" + std::to_string(identifier), car::AttributeList({
+            { car_attribute_identifier_identifier, identifier },
+        }));
+        writer->addFacet(facet);
+
+        for (int scale = 1; scale <= scales; scale++) {
+            car::AttributeList attributes = car::AttributeList({
+                { car_attribute_identifier_idiom, car_attribute_identifier_idiom_value_universal },
+                { car_attribute_identifier_scale, scale },
+                { car_attribute_identifier_identifier, identifier },
+            });
+
+            /* Each rendition has different pixels. */
+            std::vector<uint8_t> pixels = std::vector<uint8_t>(4 * 4 * 4, static_cast<uint8_t>(seed + identifier * 16 + scale));
+            car::Rendition rendition = car::Rendition::Create(attributes, car::Rendition::Data(pixels, car::Rendition::Data::Format::PremultipliedBGRA8));
+            rendition.width() = 4;
+            rendition.height() = 4;
+            rendition.scale() = scale;
+            rendition.fileName() = "facet" + std::to_string(identifier) + ".png";
+            rendition.layout() = car_rendition_value_layout_one_part_scale;
+            writer->addRendition(rendition);
+        }
+    }
+
+    writer->write();
+
+    struct bom_context_memory const *memory = bom_memory(writer->bom());
+    auto bom = car::Reader::unique_ptr_bom(bom_alloc_load(bom_context_memory(memory->data, memory->size)), bom_free);
+    EXPECT_NE(bom, nullptr);
+    return car::Reader::Load(std::move(bom));
+}
+
+TEST(Reader, RenditionFastLookup)
+{
+    ext::optional<car::Reader> reader = WriteRead(10, 3);
+    ASSERT_NE(reader, ext::nullopt);
+    EXPECT_EQ(30, reader->renditionCount());
+
+    for (uint16_t identifier = 1; identifier <= 10; identifier++) {
+        std::vector<uint16_t> scales;
+        reader->renditionFastLookup(identifier, [&reader, identifier, &scales](void *key, size_t key_len, void *value, size_t value_len) {
+            EXPECT_EQ(ext::optional<uint16_t>(identifier), reader->renditionKeyAttribute(key, car_attribute_identifier_identifier));
+            scales.push_back(reader->renditionKeyAttribute(key, car_attribute_identifier_scale).value_or(0));
+        });
+
+        std::sort(scales.begin(), scales.end());
+        EXPECT_EQ(std::vector<uint16_t>({ 1, 2, 3 }), scales);
+    }
+
+    /* Unknown identifiers and attributes not in the key. */
+    int found = 0;
+    reader->renditionFastLookup(11, [&found](void *key, size_t key_len, void *value, size_t value_len) {
+        found++;
+    });
+    EXPECT_EQ(0, found);
+
+    reader->renditionFastLookup(1, [&reader](void *key, size_t key_len, void *value, size_t value_len) {
+        EXPECT_EQ(ext::nullopt, reader->renditionKeyAttribute(key, car_attribute_identifier_element));
+    });
+
+    /* Facets find the same renditions. */
+    ext::optional<car::Facet> facet = reader->lookupFacet("facet4");
+    ASSERT_NE(facet, ext::nullopt);
+    std::vector<car::Rendition> renditions = reader->lookupRenditions(*facet);
+    ASSERT_EQ(3, renditions.size());
+    for (car::Rendition const &rendition : renditions) {
+        EXPECT_EQ(ext::optional<uint16_t>(4), rendition.attributes().get(car_attribute_identifier_identifier));
+    }
+}
+
+TEST(Reader, DataCache)
+{
+    ext::optional<car::Reader> reader = WriteRead(2, 2);
+    ASSERT_NE(reader, ext::nullopt);
+
+    auto cache = std::make_shared<car::DataCache>(1024 * 1024);
+    reader->dataCache() = cache;
+
+    ext::optional<car::Facet> facet = reader->lookupFacet("facet2");
+    ASSERT_NE(facet, ext::nullopt);
+
+    /* Data is decoded once for each rendition, then reused. */
+    for (int i = 0; i < 3; i++) {
+        for (car::Rendition const &rendition : reader->lookupRenditions(*facet)) {
+            ext::optional<car::Rendition::Data> data = rendition.data();
+            ASSERT_NE(data, ext::nullopt);
+
+            uint8_t expected = static_cast<uint8_t>(2 * 16 + rendition.attributes().get(car_attribute_identifier_scale).value_or(0));
+            EXPECT_EQ(std::vector<uint8_t>(4 * 4 * 4, expected), data->data());
+        }
+    }
+
+    EXPECT_EQ(2, cache->misses());
+    EXPECT_EQ(4, cache->hits());
+
+    /* Renditions found by iterating share the cache. */
+    reader->renditionIterate([](car::Rendition const &rendition) {
+        EXPECT_NE(rendition.data(), ext::nullopt);
+    });
+    EXPECT_EQ(4, cache->misses());
+    EXPECT_EQ(6, cache->hits());
+}
+
+TEST(Reader, SharedDataCache)
+{
+    auto cache = std::make_shared<car::DataCache>(1024 * 1024);
+
+    /* Archives with the same layout but different pixels. */
+    ext::optional<car::Reader> first = WriteRead(1, 1);
+    ASSERT_NE(first, ext::nullopt);
+    first->dataCache() = cache;
+
+    {
+        ext::optional<car::Reader> second = WriteRead(1, 1, 100);
+        ASSERT_NE(second, ext::nullopt);
+        second->dataCache() = cache;
+
+        for (int i = 0; i < 2; i++) {
+            first->renditionIterate([](car::Rendition const &rendition) {
+                EXPECT_EQ(std::vector<uint8_t>(4 * 4 * 4, 17), rendition.data()->data());
+            });
+            second->renditionIterate([](car::Rendition const &rendition) {
+                EXPECT_EQ(std::vector<uint8_t>(4 * 4 * 4, 117), rendition.data()->data());
+            });
+        }
+
+        EXPECT_EQ(2, cache->misses());
+        EXPECT_EQ(2 * 4 * 4 * 4, cache->size());
+    }
+
+    /* Data from a destroyed reader is removed. */
+    EXPECT_EQ(4 * 4 * 4, cache->size());
+    first->renditionIterate([](car::Rendition const &rendition) {
+        EXPECT_EQ(std::vector<uint8_t>(4 * 4 * 4, 17), rendition.data()->data());
+    });
+    EXPECT_EQ(2, cache->misses());
+}
@@ -11,6 +11,8 @@
 #include <car/Rendition.h>
 #include <car/car_format.h>
 
+#include <algorithm>
+
 using car::Rendition;
 
 static car::AttributeList
@@ -246,3 +248,81 @@ TEST(Rendition, SerializeSlices)
     }
 }
 
+
+static std::vector<uint8_t>
+SerializeDeserialize(car::Rendition const &rendition)
+{
+    std::vector<uint8_t> rendition_value = rendition.write();
+    car::Rendition deserialized_rendition = car::Rendition::Load(EmptyAttributeList(), reinterpret_cast<struct car_rendition_value *>(rendition_value.data()));
+
+    auto deserialized_data = deserialized_rendition.data();
+    EXPECT_NE(deserialized_data, ext::nullopt);
+    return deserialized_data ? deserialized_data->data() : std::vector<uint8_t>();
+}
+
+static car::Rendition
+PatternRendition(size_t width, size_t height)
+{
+    /* A pattern that compresses, but not to nothing. */
+    auto bitmap = std::vector<uint8_t>(width * height * 4);
+    for (size_t i = 0; i < bitmap.size(); i++) {
+        bitmap[i] = static_cast<uint8_t>((i * 7) ^ (i >> 9));
+    }
+
+    auto data = car::Rendition::Data(bitmap, car::Rendition::Data::Format::PremultipliedBGRA8);
+    car::Rendition rendition = car::Rendition::Create(EmptyAttributeList(), data);
+    rendition.width() = width;
+    rendition.height() = height;
+    rendition.scale() = 1.0;
+    rendition.fileName() = "test.png";
+    rendition.layout() = car_rendition_value_layout_one_part_scale;
+    return rendition;
+}
+
+static size_t
+CountChunks(std::vector<uint8_t> const &rendition_value)
+{
+    std::string chunk = "KCBC";
+    return std::count_if(rendition_value.begin(), rendition_value.end() - chunk.size(), [&chunk](uint8_t const &byte) {
+        return std::equal(chunk.begin(), chunk.end(), &byte);
+    });
+}
+
+TEST(Rendition, SerializeChunks)
+{
+    /* Large enough to be split into several chunks, but only if asked. */
+    car::Rendition rendition = PatternRendition(1000, 700);
+    EXPECT_EQ(0, CountChunks(rendition.write()));
+
+    rendition.compressionChunked() = true;
+    std::vector<uint8_t> rendition_value = rendition.write();
+    EXPECT_EQ(3, CountChunks(rendition_value));
+
+    EXPECT_EQ(rendition.data()->data(), SerializeDeserialize(rendition));
+
+    /* Compressing the chunks on fewer threads gives the same result. */
+    rendition.compressionThreads() = 1;
+    EXPECT_EQ(rendition_value, rendition.write());
+}
+
+TEST(Rendition, SerializeCompression)
+{
+    car::Rendition rendition = PatternRendition(100, 100);
+
+    /* Level zero stores the data without compressing it. */
+    rendition.compressionLevel() = 0;
+    std::vector<uint8_t> stored = rendition.write();
+    EXPECT_EQ(rendition.data()->data(), SerializeDeserialize(rendition));
+
+    rendition.compressionLevel() = 9;
+    std::vector<uint8_t> compressed = rendition.write();
+    EXPECT_EQ(rendition.data()->data(), SerializeDeserialize(rendition));
+    EXPECT_LT(compressed.size(), stored.size());
+
+    /* Unavailable algorithms fall back to one that is. */
+    for (car::Rendition::Compression compression : { car::Rendition::Compression::LZVN, car::Rendition::Compression::LZFSE }) {
+        rendition.compression() = compression;
+        rendition.compressionLevel() = ext::nullopt;
+        EXPECT_EQ(rendition.data()->data(), SerializeDeserialize(rendition));
+    }
+}
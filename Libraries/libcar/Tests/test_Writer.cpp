@@ -19,6 +19,8 @@
 #include <car/Reader.h>
 
 #include <cstdio>
+#include <cstring>
+#include <functional>
 #include <string>
 
 #include <vector>
@@ -254,3 +256,78 @@ TEST(Writer, TestWriter100Optimal)
     EXPECT_EQ(rendition_count, create_rendition_count);
 }
 
+/*
+ * Writes renditions for three facets at three scales, each either as a
+ * rendition or already serialized, and returns the rendition keys in the
+ * order they are stored in the archive.
+ */
+static std::vector<std::vector<uint8_t>>
+WriteRenditionKeys(std::function<bool(int identifier, int scale)> const &serialized)
+{
+    auto writer_bom = car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free);
+    auto writer = car::Writer::Create(std::move(writer_bom));
+
+    /* Added out of order. */
+    for (int identifier : { 3, 1, 2 }) {
+        for (int scale : { 2, 3, 1 }) {
+            car::AttributeList attributes = car::AttributeList({
+                { car_attribute_identifier_idiom, car_attribute_identifier_idiom_value_universal },
+                { car_attribute_identifier_scale, scale },
+                { car_attribute_identifier_identifier, identifier },
+            });
+
+            car::Rendition rendition = car::Rendition::Create(attributes, car::Rendition::Data(test_pixels, car::Rendition::Data::Format::PremultipliedBGRA8));
+            rendition.width() = 8;
+            rendition.height() = 8;
+            rendition.scale() = scale;
+            rendition.fileName() = "testpattern_" + std::to_string(identifier) + "@" + std::to_string(scale) + "x.png";
+            rendition.layout() = car_rendition_value_layout_one_part_scale;
+
+            if (serialized(identifier, scale)) {
+                writer->addRendition(attributes, rendition.write());
+            } else {
+                writer->addRendition(rendition);
+            }
+        }
+    }
+
+    writer->write();
+
+    struct bom_context_memory const *writer_memory = bom_memory(writer->bom());
+    struct bom_context_memory reader_memory = bom_context_memory(writer_memory->data, writer_memory->size);
+    auto reader_bom = std::unique_ptr<struct bom_context, decltype(&bom_free)>(bom_alloc_load(reader_memory), bom_free);
+    ext::optional<car::Reader> reader = car::Reader::Load(std::move(reader_bom));
+    EXPECT_NE(reader, ext::nullopt);
+
+    std::vector<std::vector<uint8_t>> keys;
+    reader->renditionFastIterate([&keys](void *key, size_t key_len, void *value, size_t value_len) {
+        uint8_t const *bytes = static_cast<uint8_t const *>(key);
+        keys.push_back(std::vector<uint8_t>(bytes, bytes + key_len));
+    });
+    return keys;
+}
+
+TEST(Writer, RenditionOrderMixed)
+{
+    std::vector<std::vector<uint8_t>> fresh = WriteRenditionKeys([](int identifier, int scale) {
+        return false;
+    });
+    std::vector<std::vector<uint8_t>> mixed = WriteRenditionKeys([](int identifier, int scale) {
+        return (identifier + scale) % 2 == 0;
+    });
+    std::vector<std::vector<uint8_t>> cached = WriteRenditionKeys([](int identifier, int scale) {
+        return true;
+    });
+
+    /* Ordered by key, however each rendition was added. */
+    ASSERT_EQ(fresh.size(), 9);
+    for (size_t i = 1; i < fresh.size(); ++i) {
+        std::vector<uint16_t> previous = std::vector<uint16_t>(fresh[i - 1].size() / sizeof(uint16_t));
+        memcpy(previous.data(), fresh[i - 1].data(), fresh[i - 1].size());
+        std::vector<uint16_t> current = std::vector<uint16_t>(fresh[i].size() / sizeof(uint16_t));
+        memcpy(current.data(), fresh[i].data(), fresh[i].size());
+        EXPECT_LT(previous, current);
+    }
+    EXPECT_EQ(mixed, fresh);
+    EXPECT_EQ(cached, fresh);
+}
@@ -0,0 +1,105 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <bom/bom.h>
+#include <car/Reader.h>
+#include <car/Rendition.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Codec {
+    std::string                    name;
+    car::Rendition::Compression    compression;
+    ext::optional<int>             level;
+};
+
+int
+main(int argc, char **argv)
+{
+    bool chunked = (argc == 3 && strcmp(argv[1], "-chunked") == 0);
+    if (argc != (chunked ? 3 : 2)) {
+        fprintf(stderr, "usage: %s [-chunked] <archive.car>\n", argv[0]);
+        return 1;
+    }
+
+    struct bom_context_memory memory = bom_context_memory_file(argv[argc - 1], false, 0);
+    auto bom = std::unique_ptr<struct bom_context, decltype(&bom_free)>(bom_alloc_load(memory), bom_free);
+    if (bom == nullptr) {
+        fprintf(stderr, "error: unable to load BOM\n");
+        return 1;
+    }
+
+    ext::optional<car::Reader> car = car::Reader::Load(std::move(bom));
+    if (!car) {
+        fprintf(stderr, "error: unable to load car archive\n");
+        return 1;
+    }
+
+    /*
+     * Decode the pixel data up front, so only encoding is measured.
+     */
+    std::vector<car::Rendition> renditions;
+    size_t uncompressed = 0;
+    car->renditionIterate([&renditions, &uncompressed](car::Rendition const &loaded) {
+        ext::optional<car::Rendition::Data> data = loaded.data();
+        if (!data || data->format() == car::Rendition::Data::Format::JPEG || data->format() == car::Rendition::Data::Format::Data) {
+            return;
+        }
+
+        car::Rendition rendition = car::Rendition::Create(loaded.attributes(), data);
+        rendition.fileName() = loaded.fileName();
+        rendition.width() = loaded.width();
+        rendition.height() = loaded.height();
+        rendition.scale() = loaded.scale();
+        rendition.layout() = loaded.layout();
+        rendition.slices() = loaded.slices();
+
+        uncompressed += data->data().size();
+        renditions.push_back(rendition);
+    });
+
+    printf("%zu bitmap renditions, %zu bytes uncompressed\n\n", renditions.size(), uncompressed);
+    printf("%-12s %12s %8s %10s %10s\n", "codec", "bytes", "ratio", "ms", "MB/s");
+
+    std::vector<Codec> codecs = {
+        { "zlib-0", car::Rendition::Compression::Zlib, 0 },
+        { "zlib-1", car::Rendition::Compression::Zlib, 1 },
+        { "zlib", car::Rendition::Compression::Zlib, ext::nullopt },
+        { "zlib-9", car::Rendition::Compression::Zlib, 9 },
+        { "lzvn", car::Rendition::Compression::LZVN, ext::nullopt },
+        { "lzfse", car::Rendition::Compression::LZFSE, ext::nullopt },
+    };
+
+    for (Codec const &codec : codecs) {
+        if (!car::Rendition::CompressionAvailable(codec.compression)) {
+            printf("%-12s %12s\n", codec.name.c_str(), "unavailable");
+            continue;
+        }
+
+        size_t compressed = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (car::Rendition &rendition : renditions) {
+            rendition.compression() = codec.compression;
+            rendition.compressionLevel() = codec.level;
+            rendition.compressionChunked() = chunked;
+            compressed += rendition.write().size();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        double ratio = (uncompressed != 0 ? static_cast<double>(compressed) / uncompressed : 0.0);
+        double throughput = (ms != 0 ? (uncompressed / 1048576.0) / (ms / 1000.0) : 0.0);
+        printf("%-12s %12zu %8.3f %10.1f %10.1f\n", codec.name.c_str(), compressed, ratio, ms, throughput);
+    }
+
+    return 0;
+}
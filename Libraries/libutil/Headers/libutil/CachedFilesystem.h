@@ -0,0 +1,127 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_CachedFilesystem_h
+#define __libutil_CachedFilesystem_h
+
+#include <libutil/Filesystem.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace libutil {
+
+/*
+ * Wraps another filesystem, remembering the results of metadata lookups
+ * (including paths that don't exist) so repeated queries for the same path
+ * don't touch the underlying filesystem. Writes made through this filesystem
+ * invalidate what is known about the paths they modify; modifications made
+ * any other way must be reported with `invalidate()`.
+ *
+ * Contents are never cached. Safe to use from multiple threads.
+ */
+class CachedFilesystem : public Filesystem {
+private:
+    struct Entry {
+        ext::optional<ext::optional<FileInfo>> stat;
+        ext::optional<bool>                    symbolicLink;
+        ext::optional<bool>                    readable;
+        ext::optional<bool>                    writable;
+        ext::optional<bool>                    executable;
+        ext::optional<std::string>             resolved;
+    };
+
+private:
+    Filesystem                                     *_filesystem;
+
+private:
+    mutable std::mutex                              _mutex;
+    mutable std::unordered_map<std::string, Entry>  _entries;
+    mutable size_t                                  _hits;
+    mutable size_t                                  _misses;
+
+public:
+    CachedFilesystem(Filesystem *filesystem);
+
+public:
+    /*
+     * The wrapped filesystem.
+     */
+    Filesystem *filesystem() const
+    { return _filesystem; }
+
+public:
+    /*
+     * Number of lookups answered without the underlying filesystem.
+     */
+    size_t hits() const;
+
+    /*
+     * Number of lookups passed through to the underlying filesystem.
+     */
+    size_t misses() const;
+
+public:
+    /*
+     * Forget everything known about all paths.
+     */
+    void clear();
+
+public:
+    virtual bool exists(std::string const &path) const;
+
+public:
+    virtual bool isDirectory(std::string const &path) const;
+    virtual bool isSymbolicLink(std::string const &path) const;
+
+public:
+    virtual ext::optional<FileInfo> stat(std::string const &path) const;
+    virtual std::vector<ext::optional<FileInfo>> statMany(std::vector<std::string> const &paths) const;
+
+public:
+    virtual bool isReadable(std::string const &path) const;
+    virtual bool isWritable(std::string const &path) const;
+    virtual bool isExecutable(std::string const &path) const;
+
+public:
+    virtual bool createFile(std::string const &path);
+    virtual bool createDirectory(std::string const &path);
+
+public:
+    virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
+    virtual std::unique_ptr<FileContents> map(std::string const &path) const;
+    virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
+    virtual bool copyFile(std::string const &source, std::string const &destination, uint32_t addMode = 0);
+    virtual bool copyFiles(std::vector<std::pair<std::string, std::string>> const &files, uint32_t addMode = 0, std::vector<int> *errors = nullptr);
+    virtual ext::optional<std::string> readSymbolicLink(std::string const &path) const;
+    virtual bool writeSymbolicLink(std::string const &target, std::string const &path);
+
+public:
+    virtual bool removeFile(std::string const &path);
+
+public:
+    virtual void invalidate(std::string const &path);
+
+public:
+    virtual std::string resolvePath(std::string const &path) const;
+
+public:
+    virtual bool enumerateDirectory(
+        std::string const &path,
+        std::function<void(std::string const &)> const &cb) const;
+
+private:
+    template<typename T, typename F>
+    T lookup(std::string const &path, ext::optional<T> Entry::*field, F const &fetch) const;
+    void invalidatePath(std::string const &path);
+};
+
+}
+
+#endif  // !__libutil_CachedFilesystem_h
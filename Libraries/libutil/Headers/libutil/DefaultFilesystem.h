@@ -22,6 +22,10 @@ public:
     virtual bool isDirectory(std::string const &path) const;
     virtual bool isSymbolicLink(std::string const &path) const;
 
+public:
+    virtual ext::optional<FileInfo> stat(std::string const &path) const;
+    virtual std::vector<ext::optional<FileInfo>> statMany(std::vector<std::string> const &paths) const;
+
 public:
     virtual bool isReadable(std::string const &path) const;
     virtual bool isWritable(std::string const &path) const;
@@ -33,7 +37,10 @@ public:
 
 public:
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
+    virtual std::unique_ptr<FileContents> map(std::string const &path) const;
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
+    virtual bool copyFile(std::string const &source, std::string const &destination, uint32_t addMode = 0);
+    virtual bool copyFiles(std::vector<std::pair<std::string, std::string>> const &files, uint32_t addMode = 0, std::vector<int> *errors = nullptr);
     virtual ext::optional<std::string> readSymbolicLink(std::string const &path) const;
     virtual bool writeSymbolicLink(std::string const &target, std::string const &path);
 
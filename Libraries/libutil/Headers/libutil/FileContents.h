@@ -0,0 +1,72 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_FileContents_h
+#define __libutil_FileContents_h
+
+#include <functional>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libutil {
+
+/*
+ * Read-only contents of a file. The contents are either held in memory or
+ * mapped directly from the file; either way they stay valid for as long as
+ * this object exists.
+ */
+class FileContents {
+private:
+    std::vector<uint8_t>  _buffer;
+    uint8_t const        *_data;
+    size_t                _size;
+    std::function<void()> _release;
+
+public:
+    /*
+     * Contents held in memory.
+     */
+    explicit FileContents(std::vector<uint8_t> &&buffer);
+
+    /*
+     * Contents owned elsewhere. The release function is called when the
+     * contents are no longer needed.
+     */
+    FileContents(uint8_t const *data, size_t size, std::function<void()> const &release);
+
+    ~FileContents();
+
+    FileContents(FileContents const &) = delete;
+    FileContents &operator=(FileContents const &) = delete;
+
+public:
+    /*
+     * Pointer to the start of the contents.
+     */
+    uint8_t const *data() const
+    { return _data; }
+
+    /*
+     * Length of the contents, in bytes.
+     */
+    size_t size() const
+    { return _size; }
+
+public:
+    uint8_t const *begin() const
+    { return _data; }
+    uint8_t const *end() const
+    { return _data + _size; }
+};
+
+}
+
+#endif  // !__libutil_FileContents_h
@@ -0,0 +1,72 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_FileInfo_h
+#define __libutil_FileInfo_h
+
+#include <cstdint>
+
+namespace libutil {
+
+/*
+ * Metadata about a path in a filesystem, as fetched by a single lookup.
+ */
+class FileInfo {
+public:
+    enum class Type {
+        File,
+        Directory,
+        Other,
+    };
+
+private:
+    Type     _type;
+    uint64_t _size;
+    uint64_t _modificationTime;
+    uint32_t _mode;
+    uint64_t _inode;
+
+public:
+    FileInfo(Type type, uint64_t size, uint64_t modificationTime, uint32_t mode, uint64_t inode);
+
+public:
+    /*
+     * The type of the path.
+     */
+    Type type() const
+    { return _type; }
+
+    /*
+     * The size of the file, in bytes.
+     */
+    uint64_t size() const
+    { return _size; }
+
+    /*
+     * The last modification time, in nanoseconds since the epoch.
+     */
+    uint64_t modificationTime() const
+    { return _modificationTime; }
+
+    /*
+     * The permission bits of the path.
+     */
+    uint32_t mode() const
+    { return _mode; }
+
+    /*
+     * The inode number of the path. Only unique within a filesystem.
+     */
+    uint64_t inode() const
+    { return _inode; }
+};
+
+}
+
+#endif  // !__libutil_FileInfo_h
@@ -10,8 +10,13 @@
 #ifndef __libutil_Filesystem_h
 #define __libutil_Filesystem_h
 
+#include <libutil/FileContents.h>
+#include <libutil/FileInfo.h>
+
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <ext/optional>
 
@@ -35,6 +40,19 @@ public:
      */
     virtual bool isSymbolicLink(std::string const &path) const = 0;
 
+public:
+    /*
+     * Fetch metadata for a path, following symbolic links. Fails if the
+     * path doesn't exist.
+     */
+    virtual ext::optional<FileInfo> stat(std::string const &path) const = 0;
+
+    /*
+     * Fetch metadata for many paths. The result has one entry per path, in
+     * the same order, which is empty if that path doesn't exist.
+     */
+    virtual std::vector<ext::optional<FileInfo>> statMany(std::vector<std::string> const &paths) const;
+
 public:
     /*
      * Test if a file is readable.
@@ -68,11 +86,33 @@ public:
      */
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const = 0;
 
+    /*
+     * Read the entire contents of a file, without copying them if possible.
+     * Fails if the file can't be read.
+     */
+    virtual std::unique_ptr<FileContents> map(std::string const &path) const;
+
     /*
      * Write to a file.
      */
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path) = 0;
 
+    /*
+     * Copy a file, replacing the destination if it exists. The copy has the
+     * same permissions as the source, plus any bits in `addMode`, and the
+     * same modification time, so it can be recognized as up to date later.
+     */
+    virtual bool copyFile(std::string const &source, std::string const &destination, uint32_t addMode = 0);
+
+    /*
+     * Copy many files, as pairs of source and destination. Copies may be
+     * made in parallel, so destinations must be distinct. Succeeds if all
+     * of the copies succeed. If given, `errors` is set to the result of
+     * each copy, in order: zero if it succeeded, or the `errno` it failed
+     * with, `EIO` if there is none.
+     */
+    virtual bool copyFiles(std::vector<std::pair<std::string, std::string>> const &files, uint32_t addMode = 0, std::vector<int> *errors = nullptr);
+
     /*
      * Read the destination of the symbolic link, relative to its containing directory.
      */
@@ -89,6 +129,15 @@ public:
      */
     virtual bool removeFile(std::string const &path) = 0;
 
+public:
+    /*
+     * Note that a path, and anything beneath it, may have been modified
+     * outside of this filesystem, such as by an external process. Does
+     * nothing unless the filesystem retains information about paths
+     * between calls.
+     */
+    virtual void invalidate(std::string const &path);
+
 public:
     /*
      * Resolves and normalizes a path through symbolic links.
@@ -30,6 +30,7 @@ public:
         Type                 _type;
         std::vector<uint8_t> _contents;
         std::vector<Entry>   _children;
+        uint64_t             _modificationTime;
 
     private:
         Entry(std::string const &name, Type type);
@@ -51,6 +52,10 @@ public:
         { return _children; }
         std::vector<Entry> const &children() const
         { return _children; }
+        uint64_t &modificationTime()
+        { return _modificationTime; }
+        uint64_t modificationTime() const
+        { return _modificationTime; }
 
     public:
         MemoryFilesystem::Entry *child(std::string const &name);
@@ -62,7 +67,8 @@ public:
     };
 
 private:
-    Entry _root;
+    Entry    _root;
+    uint64_t _clock;
 
 public:
     MemoryFilesystem(std::vector<Entry> const &entries);
@@ -80,6 +86,9 @@ public:
     virtual bool isDirectory(std::string const &path) const;
     virtual bool isSymbolicLink(std::string const &path) const;
 
+public:
+    virtual ext::optional<FileInfo> stat(std::string const &path) const;
+
 public:
     virtual bool isReadable(std::string const &path) const;
     virtual bool isWritable(std::string const &path) const;
@@ -92,6 +101,7 @@ public:
 public:
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
+    virtual bool copyFile(std::string const &source, std::string const &destination, uint32_t addMode = 0);
     virtual ext::optional<std::string> readSymbolicLink(std::string const &path) const;
     virtual bool writeSymbolicLink(std::string const &target, std::string const &path);
 
@@ -0,0 +1,325 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/CachedFilesystem.h>
+#include <libutil/FSUtil.h>
+
+using libutil::CachedFilesystem;
+using libutil::FileInfo;
+using libutil::FSUtil;
+
+CachedFilesystem::
+CachedFilesystem(Filesystem *filesystem) :
+    _filesystem(filesystem),
+    _hits      (0),
+    _misses    (0)
+{
+}
+
+size_t CachedFilesystem::
+hits() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+size_t CachedFilesystem::
+misses() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+void CachedFilesystem::
+clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+static std::string
+CacheKey(std::string const &path)
+{
+    /* Different spellings of the same path should share an entry. */
+    return FSUtil::NormalizePath(path);
+}
+
+template<typename T, typename F>
+T CachedFilesystem::
+lookup(std::string const &path, ext::optional<T> Entry::*field, F const &fetch) const
+{
+    std::string key = CacheKey(path);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _entries.find(key);
+        if (it != _entries.end() && it->second.*field) {
+            _hits++;
+            return *(it->second.*field);
+        }
+    }
+
+    /* Don't hold the lock while waiting for the filesystem. */
+    T value = fetch();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[key].*field = value;
+        _misses++;
+    }
+
+    return value;
+}
+
+void CachedFilesystem::
+invalidatePath(std::string const &path)
+{
+    std::string key = CacheKey(path);
+
+    std::string prefix = (!key.empty() && key.back() == '/' ? key : key + "/");
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    /* A directory may have been replaced or removed along with its contents. */
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->first == key || it->first.compare(0, prefix.size(), prefix) == 0) {
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    /* Creating or removing an entry also changes its parent directory. */
+    _entries.erase(FSUtil::GetDirectoryName(key));
+}
+
+bool CachedFilesystem::
+exists(std::string const &path) const
+{
+    return static_cast<bool>(this->stat(path));
+}
+
+bool CachedFilesystem::
+isDirectory(std::string const &path) const
+{
+    ext::optional<FileInfo> info = this->stat(path);
+    return (info && info->type() == FileInfo::Type::Directory);
+}
+
+bool CachedFilesystem::
+isSymbolicLink(std::string const &path) const
+{
+    return lookup<bool>(path, &Entry::symbolicLink, [&] {
+        return _filesystem->isSymbolicLink(path);
+    });
+}
+
+ext::optional<FileInfo> CachedFilesystem::
+stat(std::string const &path) const
+{
+    return lookup<ext::optional<FileInfo>>(path, &Entry::stat, [&] {
+        return _filesystem->stat(path);
+    });
+}
+
+std::vector<ext::optional<FileInfo>> CachedFilesystem::
+statMany(std::vector<std::string> const &paths) const
+{
+    std::vector<ext::optional<FileInfo>> infos = std::vector<ext::optional<FileInfo>>(paths.size());
+    std::vector<std::string> keys;
+    keys.reserve(paths.size());
+
+    std::vector<size_t> missing;
+    std::vector<std::string> missingPaths;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        for (size_t i = 0; i < paths.size(); ++i) {
+            keys.push_back(CacheKey(paths[i]));
+
+            auto it = _entries.find(keys.back());
+            if (it != _entries.end() && it->second.stat) {
+                infos[i] = *it->second.stat;
+                _hits++;
+            } else {
+                missing.push_back(i);
+                missingPaths.push_back(paths[i]);
+            }
+        }
+    }
+
+    if (missing.empty()) {
+        return infos;
+    }
+
+    /* Fetch everything not known in one batch. */
+    std::vector<ext::optional<FileInfo>> fetched = _filesystem->statMany(missingPaths);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        for (size_t i = 0; i < missing.size(); ++i) {
+            infos[missing[i]] = fetched[i];
+            _entries[keys[missing[i]]].stat = fetched[i];
+            _misses++;
+        }
+    }
+
+    return infos;
+}
+
+bool CachedFilesystem::
+isReadable(std::string const &path) const
+{
+    return lookup<bool>(path, &Entry::readable, [&] {
+        return _filesystem->isReadable(path);
+    });
+}
+
+bool CachedFilesystem::
+isWritable(std::string const &path) const
+{
+    return lookup<bool>(path, &Entry::writable, [&] {
+        return _filesystem->isWritable(path);
+    });
+}
+
+bool CachedFilesystem::
+isExecutable(std::string const &path) const
+{
+    return lookup<bool>(path, &Entry::executable, [&] {
+        return _filesystem->isExecutable(path);
+    });
+}
+
+bool CachedFilesystem::
+createFile(std::string const &path)
+{
+    bool result = _filesystem->createFile(path);
+    invalidatePath(path);
+    return result;
+}
+
+bool CachedFilesystem::
+createDirectory(std::string const &path)
+{
+    bool result = _filesystem->createDirectory(path);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    /*
+     * Intermediate directories may have been created too, changing each of
+     * their parents. Nothing beneath the new directory exists yet, so what is
+     * known about paths below it still holds.
+     */
+    std::string current = CacheKey(path);
+    while (!current.empty() && current != FSUtil::GetDirectoryName(current)) {
+        _entries.erase(current);
+        current = FSUtil::GetDirectoryName(current);
+    }
+    _entries.erase(current);
+
+    return result;
+}
+
+bool CachedFilesystem::
+read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext::optional<size_t> length) const
+{
+    return _filesystem->read(contents, path, offset, length);
+}
+
+std::unique_ptr<libutil::FileContents> CachedFilesystem::
+map(std::string const &path) const
+{
+    return _filesystem->map(path);
+}
+
+bool CachedFilesystem::
+write(std::vector<uint8_t> const &contents, std::string const &path)
+{
+    bool result = _filesystem->write(contents, path);
+    invalidatePath(path);
+    return result;
+}
+
+bool CachedFilesystem::
+copyFile(std::string const &source, std::string const &destination, uint32_t addMode)
+{
+    bool result = _filesystem->copyFile(source, destination, addMode);
+    invalidatePath(destination);
+    return result;
+}
+
+bool CachedFilesystem::
+copyFiles(std::vector<std::pair<std::string, std::string>> const &files, uint32_t addMode, std::vector<int> *errors)
+{
+    bool result = _filesystem->copyFiles(files, addMode, errors);
+    for (auto const &file : files) {
+        invalidatePath(file.second);
+    }
+    return result;
+}
+
+ext::optional<std::string> CachedFilesystem::
+readSymbolicLink(std::string const &path) const
+{
+    return _filesystem->readSymbolicLink(path);
+}
+
+bool CachedFilesystem::
+writeSymbolicLink(std::string const &target, std::string const &path)
+{
+    bool result = _filesystem->writeSymbolicLink(target, path);
+
+    /* Anything beneath the link could now resolve differently. */
+    clear();
+
+    return result;
+}
+
+bool CachedFilesystem::
+removeFile(std::string const &path)
+{
+    /* Removing a link can change how other paths resolve through it. */
+    bool link = _filesystem->isSymbolicLink(path);
+
+    bool result = _filesystem->removeFile(path);
+    if (link) {
+        clear();
+    } else {
+        invalidatePath(path);
+    }
+
+    return result;
+}
+
+void CachedFilesystem::
+invalidate(std::string const &path)
+{
+    invalidatePath(path);
+    _filesystem->invalidate(path);
+}
+
+std::string CachedFilesystem::
+resolvePath(std::string const &path) const
+{
+    return lookup<std::string>(path, &Entry::resolved, [&] {
+        return _filesystem->resolvePath(path);
+    });
+}
+
+bool CachedFilesystem::
+enumerateDirectory(
+    std::string const &path,
+    std::function<void(std::string const &)> const &cb) const
+{
+    return _filesystem->enumerateDirectory(path, cb);
+}
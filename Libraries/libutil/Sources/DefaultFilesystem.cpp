@@ -15,13 +15,26 @@
 #include <cstdio>
 #include <cstring>
 #include <cerrno>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
 
 #include <unistd.h>
 #include <libgen.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
+#if defined(__APPLE__)
+#include <copyfile.h>
+#elif defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
 using libutil::DefaultFilesystem;
+using libutil::FileInfo;
 
 bool DefaultFilesystem::
 exists(std::string const &path) const
@@ -49,6 +62,85 @@ isSymbolicLink(std::string const &path) const
         return S_ISLNK(st.st_mode);
 }
 
+static FileInfo
+CreateFileInfo(struct stat const &st)
+{
+    FileInfo::Type type;
+    if (S_ISREG(st.st_mode)) {
+        type = FileInfo::Type::File;
+    } else if (S_ISDIR(st.st_mode)) {
+        type = FileInfo::Type::Directory;
+    } else {
+        type = FileInfo::Type::Other;
+    }
+
+#if defined(__APPLE__)
+    struct timespec const &mtime = st.st_mtimespec;
+#else
+    struct timespec const &mtime = st.st_mtim;
+#endif
+    uint64_t modificationTime = static_cast<uint64_t>(mtime.tv_sec) * 1000000000ull + static_cast<uint64_t>(mtime.tv_nsec);
+
+    return FileInfo(type, static_cast<uint64_t>(st.st_size), modificationTime, static_cast<uint32_t>(st.st_mode & 07777), static_cast<uint64_t>(st.st_ino));
+}
+
+ext::optional<FileInfo> DefaultFilesystem::
+stat(std::string const &path) const
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) < 0) {
+        return ext::nullopt;
+    }
+
+    return CreateFileInfo(st);
+}
+
+std::vector<ext::optional<FileInfo>> DefaultFilesystem::
+statMany(std::vector<std::string> const &paths) const
+{
+    std::vector<ext::optional<FileInfo>> infos = std::vector<ext::optional<FileInfo>>(paths.size());
+
+    /*
+     * Group paths by their containing directory, so each directory is only
+     * resolved once. Paths in the same directory are then looked up relative
+     * to the open directory, avoiding repeated walks of the full path.
+     */
+    std::unordered_map<std::string, std::vector<size_t>> directories;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        directories[FSUtil::GetDirectoryName(paths[i])].push_back(i);
+    }
+
+    for (auto const &entry : directories) {
+        int fd = -1;
+        if (entry.second.size() > 1 && !entry.first.empty()) {
+            fd = ::open(entry.first.c_str(), O_RDONLY | O_DIRECTORY);
+        }
+
+        for (size_t index : entry.second) {
+            std::string const &path = paths[index];
+
+            struct stat st;
+            int result;
+            if (fd >= 0) {
+                std::string name = FSUtil::GetBaseName(path);
+                result = ::fstatat(fd, name.c_str(), &st, 0);
+            } else {
+                result = ::stat(path.c_str(), &st);
+            }
+
+            if (result == 0) {
+                infos[index] = CreateFileInfo(st);
+            }
+        }
+
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    return infos;
+}
+
 bool DefaultFilesystem::
 isReadable(std::string const &path) const
 {
@@ -157,6 +249,55 @@ read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext
     return true;
 }
 
+std::unique_ptr<libutil::FileContents> DefaultFilesystem::
+map(std::string const &path) const
+{
+    /*
+     * Mapping has a fixed cost that outweighs copying for small files.
+     */
+    static size_t const MinimumMapSize = 16 * 1024;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size >= MinimumMapSize) {
+        void *address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            ::close(fd);
+            return std::unique_ptr<FileContents>(new FileContents(static_cast<uint8_t const *>(address), size, [address, size] {
+                ::munmap(address, size);
+            }));
+        }
+    }
+
+    /* Small, or couldn't be mapped: read it instead. */
+    std::vector<uint8_t> contents = std::vector<uint8_t>(size);
+    size_t offset = 0;
+    while (offset < size) {
+        ssize_t result = ::read(fd, contents.data() + offset, size - offset);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result <= 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        offset += static_cast<size_t>(result);
+    }
+
+    ::close(fd);
+    return std::unique_ptr<FileContents>(new FileContents(std::move(contents)));
+}
+
 bool DefaultFilesystem::
 write(std::vector<uint8_t> const &contents, std::string const &path)
 {
@@ -178,6 +319,184 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
     return true;
 }
 
+static bool
+CopyContents(int in, int out, off_t size)
+{
+#if defined(__APPLE__)
+    (void)size;
+    return (::fcopyfile(in, out, nullptr, COPYFILE_DATA) == 0);
+#else
+    off_t copied = 0;
+
+#if defined(__linux__)
+    /*
+     * Copy in the kernel where possible. Either call can be unsupported
+     * for a particular pair of files; fall back to the next method if so.
+     */
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+    while (copied < size) {
+        ssize_t result = ::copy_file_range(in, nullptr, out, nullptr, static_cast<size_t>(size - copied), 0);
+        if (result <= 0) {
+            break;
+        }
+        copied += result;
+    }
+#endif
+
+    while (copied < size) {
+        ssize_t result = ::sendfile(out, in, nullptr, static_cast<size_t>(size - copied));
+        if (result <= 0) {
+            break;
+        }
+        copied += result;
+    }
+#endif
+
+    /* Copy the rest, including anything written since the size was read. */
+    char buffer[65536];
+    while (true) {
+        ssize_t result = ::read(in, buffer, sizeof(buffer));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result < 0) {
+            return false;
+        } else if (result == 0) {
+            return true;
+        }
+
+        for (ssize_t written = 0; written < result;) {
+            ssize_t write = ::write(out, buffer + written, static_cast<size_t>(result - written));
+            if (write < 0 && errno == EINTR) {
+                continue;
+            } else if (write < 0) {
+                return false;
+            }
+            written += write;
+        }
+    }
+#endif
+}
+
+bool DefaultFilesystem::
+copyFile(std::string const &source, std::string const &destination, uint32_t addMode)
+{
+    /* On failure, leave `errno` as the first error, not one from cleaning up. */
+    int error = 0;
+
+    int in = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(in, &st) < 0) {
+        error = errno;
+        ::close(in);
+        errno = error;
+        return false;
+    }
+
+    if (!S_ISREG(st.st_mode)) {
+        ::close(in);
+        errno = (S_ISDIR(st.st_mode) ? EISDIR : EINVAL);
+        return false;
+    }
+
+    /* Replace rather than overwrite, as the destination may not be writable. */
+    if (::unlink(destination.c_str()) < 0 && errno != ENOENT) {
+        error = errno;
+        ::close(in);
+        errno = error;
+        return false;
+    }
+
+    int out = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (out < 0) {
+        error = errno;
+        ::close(in);
+        errno = error;
+        return false;
+    }
+
+    bool success = CopyContents(in, out, st.st_size);
+    if (!success) {
+        error = errno;
+    }
+    ::close(in);
+
+    if (success) {
+        success = (::fchmod(out, static_cast<mode_t>((st.st_mode & 07777) | addMode)) == 0);
+        if (!success) {
+            error = errno;
+        }
+    }
+
+    if (success) {
+#if defined(__APPLE__)
+        struct timespec times[2] = { st.st_atimespec, st.st_mtimespec };
+#else
+        struct timespec times[2] = { st.st_atim, st.st_mtim };
+#endif
+        success = (::futimens(out, times) == 0);
+        if (!success) {
+            error = errno;
+        }
+    }
+
+    if (::close(out) < 0 && success) {
+        success = false;
+        error = errno;
+    }
+
+    if (!success) {
+        ::unlink(destination.c_str());
+        errno = error;
+    }
+
+    return success;
+}
+
+bool DefaultFilesystem::
+copyFiles(std::vector<std::pair<std::string, std::string>> const &files, uint32_t addMode, std::vector<int> *errors)
+{
+    /*
+     * Copies are independent; make them on a few threads at once. This
+     * filesystem holds no state, so it's safe to use from each thread.
+     */
+    size_t jobs = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), files.size());
+    if (jobs <= 1) {
+        return Filesystem::copyFiles(files, addMode, errors);
+    }
+
+    /* Each thread writes only the results for the copies it makes. */
+    std::vector<int> results = std::vector<int>(files.size(), 0);
+    std::atomic<size_t> next(0);
+    std::atomic<bool> success(true);
+    auto worker = [&]() {
+        for (size_t index = next++; index < files.size(); index = next++) {
+            errno = 0;
+            if (!copyFile(files[index].first, files[index].second, addMode)) {
+                results[index] = (errno != 0 ? errno : EIO);
+                success = false;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t n = 0; n < jobs; ++n) {
+        threads.push_back(std::thread(worker));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    if (errors != nullptr) {
+        *errors = std::move(results);
+    }
+
+    return success;
+}
+
 ext::optional<std::string> DefaultFilesystem::
 readSymbolicLink(std::string const &path) const
 {
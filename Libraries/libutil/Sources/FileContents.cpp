@@ -0,0 +1,36 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/FileContents.h>
+
+using libutil::FileContents;
+
+FileContents::
+FileContents(std::vector<uint8_t> &&buffer) :
+    _buffer(std::move(buffer))
+{
+    _data = _buffer.data();
+    _size = _buffer.size();
+}
+
+FileContents::
+FileContents(uint8_t const *data, size_t size, std::function<void()> const &release) :
+    _data   (data),
+    _size   (size),
+    _release(release)
+{
+}
+
+FileContents::
+~FileContents()
+{
+    if (_release) {
+        _release();
+    }
+}
@@ -0,0 +1,22 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/FileInfo.h>
+
+using libutil::FileInfo;
+
+FileInfo::
+FileInfo(Type type, uint64_t size, uint64_t modificationTime, uint32_t mode, uint64_t inode) :
+    _type            (type),
+    _size            (size),
+    _modificationTime(modificationTime),
+    _mode            (mode),
+    _inode           (inode)
+{
+}
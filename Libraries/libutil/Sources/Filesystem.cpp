@@ -10,12 +10,75 @@
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
+#include <cerrno>
 #include <unordered_set>
 #include <sstream>
 
 using libutil::Filesystem;
 using libutil::FSUtil;
 
+std::vector<ext::optional<libutil::FileInfo>> Filesystem::
+statMany(std::vector<std::string> const &paths) const
+{
+    std::vector<ext::optional<FileInfo>> infos;
+    infos.reserve(paths.size());
+
+    for (std::string const &path : paths) {
+        infos.push_back(this->stat(path));
+    }
+
+    return infos;
+}
+
+std::unique_ptr<libutil::FileContents> Filesystem::
+map(std::string const &path) const
+{
+    std::vector<uint8_t> contents;
+    if (!this->read(&contents, path)) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<FileContents>(new FileContents(std::move(contents)));
+}
+
+bool Filesystem::
+copyFile(std::string const &source, std::string const &destination, uint32_t addMode)
+{
+    /* Permissions and times can't be set through this interface. */
+    std::vector<uint8_t> contents;
+    if (!this->read(&contents, source)) {
+        return false;
+    }
+
+    return this->write(contents, destination);
+}
+
+bool Filesystem::
+copyFiles(std::vector<std::pair<std::string, std::string>> const &files, uint32_t addMode, std::vector<int> *errors)
+{
+    if (errors != nullptr) {
+        errors->assign(files.size(), 0);
+    }
+
+    bool success = true;
+    for (size_t index = 0; index < files.size(); ++index) {
+        errno = 0;
+        if (!this->copyFile(files[index].first, files[index].second, addMode)) {
+            if (errors != nullptr) {
+                (*errors)[index] = (errno != 0 ? errno : EIO);
+            }
+            success = false;
+        }
+    }
+    return success;
+}
+
+void Filesystem::
+invalidate(std::string const &path)
+{
+    /* Nothing retained by default. */
+}
+
 bool Filesystem::
 enumerateRecursive(
     std::string const &path,
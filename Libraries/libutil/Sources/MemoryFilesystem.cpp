@@ -13,14 +13,17 @@
 #include <algorithm>
 
 #include <cassert>
+#include <cerrno>
 
 using libutil::MemoryFilesystem;
+using libutil::FileInfo;
 using libutil::FSUtil;
 
 MemoryFilesystem::Entry::
 Entry(std::string const &name, Type type) :
-    _name(name),
-    _type(type)
+    _name            (name),
+    _type            (type),
+    _modificationTime(0)
 {
 }
 
@@ -70,7 +73,8 @@ Directory(std::string const &name, std::vector<Entry> const &children)
 
 MemoryFilesystem::
 MemoryFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
-    _root(MemoryFilesystem::Entry::Directory("/", entries))
+    _root (MemoryFilesystem::Entry::Directory("/", entries)),
+    _clock(0)
 {
 }
 
@@ -158,6 +162,22 @@ isSymbolicLink(std::string const &path) const
     return false;
 }
 
+ext::optional<FileInfo> MemoryFilesystem::
+stat(std::string const &path) const
+{
+    ext::optional<FileInfo> info;
+    WalkPath<MemoryFilesystem::Entry const>(this, path, false, [&](MemoryFilesystem::Entry const *parent, std::string const &name, MemoryFilesystem::Entry const *entry) -> MemoryFilesystem::Entry const * {
+        if (entry != nullptr) {
+            /* No inodes or permissions in memory; everything is accessible. */
+            FileInfo::Type type = (entry->type() == MemoryFilesystem::Entry::Type::Directory ? FileInfo::Type::Directory : FileInfo::Type::File);
+            info = FileInfo(type, entry->contents().size(), entry->modificationTime(), 0755, 0);
+        }
+
+        return entry;
+    });
+    return info;
+}
+
 bool MemoryFilesystem::
 isReadable(std::string const &path) const
 {
@@ -179,7 +199,7 @@ isExecutable(std::string const &path) const
 bool MemoryFilesystem::
 createFile(std::string const &path)
 {
-    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [this](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == MemoryFilesystem::Entry::Type::File) {
                 /* Exists as a file. */
@@ -191,6 +211,7 @@ createFile(std::string const &path)
         } else {
             /* Add empty file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, std::vector<uint8_t>());
+            file.modificationTime() = ++_clock;
             std::vector<MemoryFilesystem::Entry> *children = &parent->children();
             children->emplace_back(std::move(file));
             return &children->back();
@@ -201,7 +222,7 @@ createFile(std::string const &path)
 bool MemoryFilesystem::
 createDirectory(std::string const &path)
 {
-    return WalkPath<MemoryFilesystem::Entry>(this, path, true, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+    return WalkPath<MemoryFilesystem::Entry>(this, path, true, [this](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == MemoryFilesystem::Entry::Type::Directory) {
                 /* Intermediate directory already exists. */
@@ -213,6 +234,7 @@ createDirectory(std::string const &path)
         } else {
             /* Add intermediate directory. */
             MemoryFilesystem::Entry directory = MemoryFilesystem::Entry::Directory(name, { });
+            directory.modificationTime() = ++_clock;
             std::vector<MemoryFilesystem::Entry> *children = &parent->children();
             children->emplace_back(std::move(directory));
             return &children->back();
@@ -248,6 +270,7 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
             if (entry->type() == MemoryFilesystem::Entry::Type::File) {
                 /* Exists as a file, replace contents. */
                 entry->contents() = contents;
+                entry->modificationTime() = ++_clock;
                 return entry;
             } else {
                 /* Exists already, but not as a file. */
@@ -256,6 +279,7 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
         } else {
             /* Add file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, contents);
+            file.modificationTime() = ++_clock;
             std::vector<MemoryFilesystem::Entry> *children = &parent->children();
             children->emplace_back(std::move(file));
             return &children->back();
@@ -263,6 +287,29 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
     });
 }
 
+bool MemoryFilesystem::
+copyFile(std::string const &source, std::string const &destination, uint32_t addMode)
+{
+    ext::optional<FileInfo> info = this->stat(source);
+    if (!info || info->type() != FileInfo::Type::File) {
+        errno = (info ? EISDIR : ENOENT);
+        return false;
+    }
+
+    std::vector<uint8_t> contents;
+    if (!this->read(&contents, source) || !this->write(contents, destination)) {
+        return false;
+    }
+
+    /* Keep the source's time, as a real copy would. */
+    return WalkPath<MemoryFilesystem::Entry>(this, destination, false, [&](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+        if (entry != nullptr) {
+            entry->modificationTime() = info->modificationTime();
+        }
+        return entry;
+    });
+}
+
 ext::optional<std::string> MemoryFilesystem::
 readSymbolicLink(std::string const &path) const
 {
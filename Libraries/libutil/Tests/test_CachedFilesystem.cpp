@@ -0,0 +1,142 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/CachedFilesystem.h>
+#include <libutil/MemoryFilesystem.h>
+
+using libutil::CachedFilesystem;
+using libutil::FileInfo;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static MemoryFilesystem
+BasicFilesystem()
+{
+    return MemoryFilesystem({
+        MemoryFilesystem::Entry::File("file1", Contents("one")),
+        MemoryFilesystem::Entry::Directory("dir1", {
+            MemoryFilesystem::Entry::File("file2", Contents("two")),
+        }),
+    });
+}
+
+TEST(CachedFilesystem, Memoize)
+{
+    auto memory = BasicFilesystem();
+    CachedFilesystem filesystem(&memory);
+
+    EXPECT_TRUE(filesystem.exists("/file1"));
+    EXPECT_EQ(filesystem.hits(), 0);
+    EXPECT_EQ(filesystem.misses(), 1);
+
+    /* Existence and type share the same lookup, for any spelling. */
+    EXPECT_TRUE(filesystem.exists("/file1"));
+    EXPECT_FALSE(filesystem.isDirectory("//file1"));
+    EXPECT_TRUE(filesystem.isDirectory("/dir1/./"));
+    EXPECT_EQ(filesystem.hits(), 2);
+    EXPECT_EQ(filesystem.misses(), 2);
+
+    /* Missing paths are remembered too. */
+    EXPECT_FALSE(filesystem.exists("/invalid"));
+    EXPECT_FALSE(filesystem.exists("/invalid"));
+    EXPECT_EQ(filesystem.hits(), 3);
+    EXPECT_EQ(filesystem.misses(), 3);
+
+    /* Batches only fetch what isn't known. */
+    std::vector<ext::optional<FileInfo>> infos = filesystem.statMany({ "/file1", "/dir1/file2", "/invalid" });
+    ASSERT_EQ(infos.size(), 3);
+    EXPECT_TRUE(infos[0]);
+    EXPECT_TRUE(infos[1]);
+    EXPECT_FALSE(infos[2]);
+    EXPECT_EQ(filesystem.hits(), 5);
+    EXPECT_EQ(filesystem.misses(), 4);
+}
+
+TEST(CachedFilesystem, InvalidateOnWrite)
+{
+    auto memory = BasicFilesystem();
+    CachedFilesystem filesystem(&memory);
+
+    EXPECT_FALSE(filesystem.exists("/new"));
+    EXPECT_TRUE(filesystem.write(Contents("new"), "/new"));
+    EXPECT_TRUE(filesystem.exists("/new"));
+    EXPECT_EQ(filesystem.stat("/new")->size(), 3);
+
+    EXPECT_FALSE(filesystem.isDirectory("/dir2/dir3"));
+    EXPECT_FALSE(filesystem.isDirectory("/dir2"));
+    EXPECT_TRUE(filesystem.createDirectory("/dir2/dir3"));
+    EXPECT_TRUE(filesystem.isDirectory("/dir2/dir3"));
+    EXPECT_TRUE(filesystem.isDirectory("/dir2"));
+
+    EXPECT_TRUE(filesystem.exists("/dir1/file2"));
+    EXPECT_TRUE(filesystem.removeFile("/dir1/file2"));
+    EXPECT_FALSE(filesystem.exists("/dir1/file2"));
+}
+
+TEST(CachedFilesystem, CreateDirectoryKeepsOthers)
+{
+    auto memory = BasicFilesystem();
+    CachedFilesystem filesystem(&memory);
+
+    EXPECT_TRUE(filesystem.exists("/dir1/file2"));
+    EXPECT_FALSE(filesystem.exists("/dir1/dir2"));
+    EXPECT_EQ(filesystem.misses(), 2);
+
+    /* Only the new directories and their parents are looked up again. */
+    EXPECT_TRUE(filesystem.createDirectory("/dir1/dir2/dir3"));
+    EXPECT_TRUE(filesystem.exists("/dir1/file2"));
+    EXPECT_EQ(filesystem.hits(), 1);
+    EXPECT_TRUE(filesystem.isDirectory("/dir1/dir2"));
+    EXPECT_TRUE(filesystem.isDirectory("/dir1"));
+    EXPECT_EQ(filesystem.hits(), 1);
+}
+
+TEST(CachedFilesystem, InvalidateExternal)
+{
+    auto memory = BasicFilesystem();
+    CachedFilesystem filesystem(&memory);
+
+    /* Changes made behind the cache aren't seen... */
+    EXPECT_FALSE(filesystem.exists("/external"));
+    EXPECT_TRUE(memory.write(Contents("external"), "/external"));
+    EXPECT_FALSE(filesystem.exists("/external"));
+
+    /* ...until the path is invalidated. */
+    filesystem.invalidate("/external");
+    EXPECT_TRUE(filesystem.exists("/external"));
+}
+
+TEST(CachedFilesystem, InvalidateDirectory)
+{
+    auto memory = BasicFilesystem();
+    CachedFilesystem filesystem(&memory);
+
+    EXPECT_TRUE(filesystem.exists("/dir1/file2"));
+    EXPECT_FALSE(filesystem.exists("/dir1/file3"));
+    EXPECT_FALSE(filesystem.exists("/file4"));
+    EXPECT_TRUE(memory.removeFile("/dir1/file2"));
+    EXPECT_TRUE(memory.write(Contents("three"), "/dir1/file3"));
+    EXPECT_TRUE(memory.write(Contents("four"), "/file4"));
+
+    /* Invalidating a directory also invalidates everything beneath it. */
+    filesystem.invalidate("/dir1");
+    EXPECT_FALSE(filesystem.exists("/dir1/file2"));
+    EXPECT_TRUE(filesystem.exists("/dir1/file3"));
+    EXPECT_FALSE(filesystem.exists("/file4"));
+
+    /* Invalidating the root invalidates everything. */
+    filesystem.invalidate("/");
+    EXPECT_TRUE(filesystem.exists("/file4"));
+}
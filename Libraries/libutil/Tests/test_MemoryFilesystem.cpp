@@ -10,6 +10,9 @@
 #include <gtest/gtest.h>
 #include <libutil/MemoryFilesystem.h>
 
+#include <cerrno>
+
+using libutil::FileInfo;
 using libutil::MemoryFilesystem;
 
 static std::vector<uint8_t>
@@ -60,6 +63,45 @@ TEST(MemoryFilesystem, IsDirectory)
     EXPECT_FALSE(filesystem.isDirectory("/invalid1/invalid2"));
 }
 
+TEST(MemoryFilesystem, Stat)
+{
+    auto filesystem = BasicFilesystem();
+
+    ext::optional<FileInfo> file = filesystem.stat("/dir1/file2");
+    ASSERT_TRUE(file);
+    EXPECT_EQ(file->type(), FileInfo::Type::File);
+    EXPECT_EQ(file->size(), 4);
+
+    ext::optional<FileInfo> directory = filesystem.stat("/dir2/dir3");
+    ASSERT_TRUE(directory);
+    EXPECT_EQ(directory->type(), FileInfo::Type::Directory);
+
+    EXPECT_FALSE(filesystem.stat("/invalid"));
+    EXPECT_FALSE(filesystem.stat("/file1/invalid"));
+
+    /* Writes advance the modification time. */
+    uint64_t before = filesystem.stat("/file1")->modificationTime();
+    EXPECT_TRUE(filesystem.write(Contents("new"), "/file1"));
+    EXPECT_GT(filesystem.stat("/file1")->modificationTime(), before);
+    EXPECT_TRUE(filesystem.write(Contents("new"), "/new"));
+    EXPECT_GT(filesystem.stat("/new")->modificationTime(), filesystem.stat("/file1")->modificationTime());
+}
+
+TEST(MemoryFilesystem, StatMany)
+{
+    auto filesystem = BasicFilesystem();
+
+    std::vector<ext::optional<FileInfo>> infos = filesystem.statMany({ "/file1", "/invalid", "/dir2/file2", "/dir2" });
+    ASSERT_EQ(infos.size(), 4);
+    ASSERT_TRUE(infos[0]);
+    EXPECT_EQ(infos[0]->size(), 3);
+    EXPECT_FALSE(infos[1]);
+    ASSERT_TRUE(infos[2]);
+    EXPECT_EQ(infos[2]->size(), 4);
+    ASSERT_TRUE(infos[3]);
+    EXPECT_EQ(infos[3]->type(), FileInfo::Type::Directory);
+}
+
 TEST(MemoryFilesystem, IsSymbolicLink)
 {
     auto filesystem = BasicFilesystem();
@@ -219,6 +261,19 @@ TEST(MemoryFilesystem, Read)
     EXPECT_EQ(contents, Contents(""));
 }
 
+TEST(MemoryFilesystem, Map)
+{
+    auto filesystem = BasicFilesystem();
+
+    std::unique_ptr<libutil::FileContents> contents = filesystem.map("/dir1/file2");
+    ASSERT_NE(contents, nullptr);
+    EXPECT_EQ(std::vector<uint8_t>(contents->begin(), contents->end()), Contents("two1"));
+
+    /* Can't map directories or nonexistent files. */
+    EXPECT_EQ(filesystem.map("/dir1"), nullptr);
+    EXPECT_EQ(filesystem.map("/invalid"), nullptr);
+}
+
 TEST(MemoryFilesystem, Write)
 {
     auto filesystem = BasicFilesystem();
@@ -251,6 +306,24 @@ TEST(MemoryFilesystem, Write)
     EXPECT_FALSE(filesystem.exists("/invalid/new"));
 }
 
+TEST(MemoryFilesystem, CopyFiles)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("file1", Contents("one")),
+        MemoryFilesystem::Entry::Directory("dir1", { }),
+    });
+
+    /* Each copy has its own result. */
+    std::vector<int> errors;
+    EXPECT_FALSE(filesystem.copyFiles({ { "/file1", "/copy1" }, { "/missing", "/copy2" }, { "/dir1", "/copy3" } }, 0, &errors));
+    EXPECT_EQ(errors, std::vector<int>({ 0, ENOENT, EISDIR }));
+
+    std::vector<uint8_t> contents;
+    EXPECT_TRUE(filesystem.read(&contents, "/copy1"));
+    EXPECT_EQ(contents, Contents("one"));
+    EXPECT_FALSE(filesystem.exists("/copy2"));
+}
+
 TEST(MemoryFilesystem, ResolvePath)
 {
     auto filesystem = BasicFilesystem();
@@ -17,6 +17,8 @@
 
 #include <ext/optional>
 
+#include <mutex>
+
 namespace pbxbuild {
 namespace Build {
 
@@ -37,6 +39,7 @@ private:
 
 private:
     std::shared_ptr<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>> _targetEnvironments;
+    std::shared_ptr<std::mutex>                                                                _targetEnvironmentsMutex;
 
 public:
     Context(
@@ -107,11 +110,20 @@ public:
 
 public:
     /*
-     * Create or fetch a target's computed environment.
+     * Create or fetch a target's computed environment. Safe to call from
+     * multiple threads; each target's environment is only stored once.
      */
     ext::optional<Target::Environment>
     targetEnvironment(Build::Environment const &buildEnvironment, pbxproj::PBX::Target::shared_ptr const &target) const;
 
+    /*
+     * Create the environments for a set of targets ahead of time, using up
+     * to `jobs` threads. The environments are the same as those created by
+     * `targetEnvironment()`, which will then return them without recomputing.
+     */
+    void
+    createTargetEnvironments(Build::Environment const &buildEnvironment, std::vector<pbxproj::PBX::Target::shared_ptr> const &targets, size_t jobs) const;
+
 public:
     /*
      * Finds a target by identifier within a project.
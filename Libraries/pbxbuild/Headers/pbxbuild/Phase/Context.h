@@ -16,12 +16,12 @@
 #include <pbxbuild/Phase/File.h>
 #include <pbxbuild/Tool/Context.h>
 #include <pbxbuild/Tool/ToolResolver.h>
+#include <pbxbuild/Tool/ClangResolver.h>
 
 namespace pbxbuild {
 
 namespace Tool {
     class AssetCatalogResolver;
-    class ClangResolver;
     class CopyResolver;
     class DittoResolver;
     class InfoPlistResolver;
@@ -40,6 +40,7 @@ class Environment;
 class Context {
 private:
     Tool::Context                                       _toolContext;
+    size_t                                              _jobs;
 
 private:
     std::unique_ptr<Tool::AssetCatalogResolver>         _assetCatalogResolver;
@@ -57,7 +58,7 @@ private:
     std::unordered_map<std::string, Tool::ToolResolver> _toolResolvers;
 
 public:
-    explicit Context(Tool::Context const &toolContext);
+    Context(Tool::Context const &toolContext, size_t jobs);
     ~Context();
 
 public:
@@ -68,6 +69,13 @@ public:
     Tool::Context &toolContext()
     { return _toolContext; }
 
+public:
+    /*
+     * Maximum number of threads to use when resolving build files.
+     */
+    size_t jobs() const
+    { return _jobs; }
+
 public:
     Tool::AssetCatalogResolver const     *assetCatalogResolver(Phase::Environment const &phaseEnvironment);
     Tool::ClangResolver const            *clangResolver(Phase::Environment const &phaseEnvironment);
@@ -90,6 +98,11 @@ public:
     static std::vector<std::vector<Phase::File>> Group(std::vector<Phase::File> const &files);
 
 public:
+    /*
+     * Resolves the tools for each group of files. Source compilations are
+     * resolved on up to `jobs` threads, but are always added to the tool
+     * context in the order of the groups.
+     */
     bool resolveBuildFiles(
         Phase::Environment const &phaseEnvironment,
         pbxsetting::Environment const &environment,
@@ -97,6 +110,14 @@ public:
         std::vector<std::vector<Phase::File>> const &groups,
         std::string const &outputDirectory,
         std::string const &fallbackToolIdentifier = std::string());
+
+private:
+    std::vector<ext::optional<Tool::ClangResolver::Source>> prepareSources(
+        Phase::Environment const &phaseEnvironment,
+        pbxsetting::Environment const &environment,
+        std::vector<std::vector<Phase::File>> const &groups,
+        std::string const &outputDirectory,
+        std::string const &fallbackToolIdentifier);
 };
 
 }
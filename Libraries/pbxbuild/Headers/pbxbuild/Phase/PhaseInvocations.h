@@ -31,8 +31,13 @@ public:
     { return _invocations; }
 
 public:
+    /*
+     * Resolve the invocations for a target's build phases. Independent
+     * build files are resolved on up to `jobs` threads; the invocations
+     * are the same regardless of the number of jobs.
+     */
     static PhaseInvocations
-    Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_ptr const &target);
+    Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_ptr const &target, size_t jobs);
 };
 
 }
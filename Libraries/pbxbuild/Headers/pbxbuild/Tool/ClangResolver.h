@@ -23,6 +23,24 @@ class Context;
 class PrecompiledHeaderInfo;
 
 class ClangResolver {
+public:
+    /*
+     * A resolved compilation of a source file, not yet added to a context.
+     * Resolving only reads from the context, so sources can be resolved in
+     * parallel, then added to the context in order.
+     */
+    class Source {
+    private:
+        Tool::Invocation                             _invocation;
+        std::pair<std::string, std::string>          _variantArchitecture;
+        std::shared_ptr<Tool::PrecompiledHeaderInfo> _precompiledHeaderInfo;
+        bool                                         _cPlusPlus;
+        std::vector<std::string>                     _linkerArgs;
+
+    private:
+        friend class ClangResolver;
+    };
+
 private:
     pbxspec::PBX::Compiler::shared_ptr _compiler;
 
@@ -36,6 +54,15 @@ public:
         pbxsetting::Environment const &environment,
         Phase::File const &input,
         std::string const &outputDirectory) const;
+    Source prepareSource(
+        Tool::Context const *toolContext,
+        pbxsetting::Environment const &environment,
+        Phase::File const &input,
+        std::string const &outputDirectory) const;
+    void addSource(
+        Tool::Context *toolContext,
+        pbxsetting::Environment const &environment,
+        Source const &source) const;
     void resolvePrecompiledHeader(
         Tool::Context *toolContext,
         pbxsetting::Environment const &environment,
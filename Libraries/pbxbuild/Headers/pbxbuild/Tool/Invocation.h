@@ -140,6 +140,9 @@ public:
         Determine(std::string const &executable);
     };
 
+private:
+    std::string                                  _toolIdentifier;
+
 private:
     ext::optional<Executable>                    _executable;
     std::vector<std::string>                     _arguments;
@@ -170,6 +173,15 @@ public:
     Invocation();
     ~Invocation();
 
+public:
+    /* The identifier of the tool specification invoked, if any. */
+    std::string const &toolIdentifier() const
+    { return _toolIdentifier; }
+
+public:
+    std::string &toolIdentifier()
+    { return _toolIdentifier; }
+
 public:
     ext::optional<Executable> const &executable() const
     { return _executable; }
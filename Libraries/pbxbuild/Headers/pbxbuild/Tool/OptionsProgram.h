@@ -0,0 +1,171 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxbuild_Tool_OptionsProgram_h
+#define __pbxbuild_Tool_OptionsProgram_h
+
+#include <pbxbuild/Base.h>
+#include <pbxbuild/Tool/OptionsResult.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace plist { class Object; }
+namespace pbxsetting { class Environment; }
+
+namespace pbxbuild {
+namespace Tool {
+
+/*
+ * A tool's options, compiled once so resolving the options for each
+ * invocation only needs to evaluate build settings. Conditions are parsed
+ * into expressions, architecture and file type lists into sets, and
+ * argument templates are split around the option's value.
+ */
+class OptionsProgram {
+public:
+    typedef std::shared_ptr<OptionsProgram> shared_ptr;
+
+public:
+    /*
+     * A parsed `Condition` or `CommandLineCondition` expression. Supports
+     * `==`, `!=`, `!`, `&&`, `||` and parentheses; operands are build
+     * setting values, optionally quoted. A bare operand is true unless it
+     * expands to `NO`.
+     */
+    class Condition {
+    public:
+        enum class Type {
+            Operand,
+            Equal,
+            NotEqual,
+            Not,
+            And,
+            Or,
+            /* Couldn't be parsed; evaluated by splitting the expansion. */
+            Expression,
+        };
+
+    private:
+        Type                                          _type;
+        std::vector<pbxsetting::Value>                _values;
+        std::vector<std::shared_ptr<Condition const>> _conditions;
+
+    public:
+        Condition(Type type, std::vector<pbxsetting::Value> const &values, std::vector<std::shared_ptr<Condition const>> const &conditions);
+
+    public:
+        inline Type type() const
+        { return _type; }
+
+    public:
+        bool evaluate(pbxsetting::Environment const &environment) const;
+
+    public:
+        static Condition
+        Parse(std::string const &condition);
+    };
+
+    /*
+     * An argument containing the option's value. When the only setting it
+     * references is `$(value)`, it's stored as literal parts so the value
+     * can be substituted without creating a new environment.
+     */
+    class Template {
+    private:
+        pbxsetting::Value                         _value;
+        bool                                      _direct;
+        std::vector<std::pair<bool, std::string>> _parts;
+
+    public:
+        explicit Template(pbxsetting::Value const &value);
+
+    public:
+        inline pbxsetting::Value const &value() const
+        { return _value; }
+        inline bool direct() const
+        { return _direct; }
+
+    public:
+        /*
+         * Substitute the option's value. Only valid for direct templates.
+         */
+        std::string substitute(std::string const &value) const;
+    };
+
+    /*
+     * Argument templates for `CommandLineArgs` and similar: either a list
+     * applied for any value, or lists keyed on the option's value.
+     */
+    class Arguments {
+    private:
+        bool                                                   _keyed;
+        std::vector<Template>                                  _arguments;
+        std::unordered_map<std::string, std::vector<Template>> _keyedArguments;
+        ext::optional<std::vector<Template>>                   _otherwise;
+
+    public:
+        explicit Arguments(plist::Object const *arguments);
+
+    public:
+        std::vector<Template> const *select(std::string const &value) const;
+    };
+
+private:
+    struct Option {
+        pbxspec::PBX::PropertyOption::shared_ptr                   option;
+        bool                                                       boolean;
+        bool                                                       list;
+        ext::optional<Condition>                                   condition;
+        ext::optional<Condition>                                   commandLineCondition;
+        ext::optional<std::unordered_set<std::string>>             architectures;
+        ext::optional<std::unordered_set<std::string>>             fileTypes;
+        std::vector<Template>                                      flag;
+        std::vector<std::pair<std::string, std::vector<Template>>> values;
+        std::vector<Template>                                      prefixFlag;
+        Arguments                                                  commandLineArgs;
+        Arguments                                                  additionalLinkerArgs;
+
+        explicit Option(pbxspec::PBX::PropertyOption::shared_ptr const &option);
+    };
+
+private:
+    std::vector<Option> _options;
+
+public:
+    OptionsProgram(
+        std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
+        std::unordered_set<std::string> const &deletedSettings);
+
+public:
+    /*
+     * Resolve the options for a single invocation.
+     */
+    OptionsResult
+    run(
+        pbxsetting::Environment const &environment,
+        std::string const &workingDirectory,
+        pbxspec::PBX::FileType::shared_ptr const &fileType) const;
+
+public:
+    /*
+     * The compiled options for a tool. Compiled on first use and shared
+     * for as long as the tool exists. Thread-safe.
+     */
+    static OptionsProgram::shared_ptr
+    ForTool(pbxspec::PBX::Tool::shared_ptr const &tool);
+};
+
+}
+}
+
+#endif // !__pbxbuild_Tool_OptionsProgram_h
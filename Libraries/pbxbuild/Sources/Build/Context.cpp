@@ -9,6 +9,10 @@
 
 #include <pbxbuild/Build/Context.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 namespace Build = pbxbuild::Build;
 namespace Target = pbxbuild::Target;
 
@@ -29,22 +33,58 @@ Context(
     _configuration       (configuration),
     _defaultConfiguration(defaultConfiguration),
     _overrideLevels      (overrideLevels),
-    _targetEnvironments  (std::make_shared<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>>())
+    _targetEnvironments     (std::make_shared<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>>()),
+    _targetEnvironmentsMutex(std::make_shared<std::mutex>())
 {
 }
 
 ext::optional<pbxbuild::Target::Environment> Build::Context::
 targetEnvironment(Build::Environment const &buildEnvironment, pbxproj::PBX::Target::shared_ptr const &target) const
 {
-    auto TEI = _targetEnvironments->find(target);
-    if (TEI != _targetEnvironments->end()) {
-        return TEI->second;
-    } else {
-        ext::optional<Target::Environment> targetEnvironment = Target::Environment::Create(buildEnvironment, *this, target);
-        if (targetEnvironment) {
-            _targetEnvironments->insert(std::make_pair(target, *targetEnvironment));
+    {
+        std::lock_guard<std::mutex> lock(*_targetEnvironmentsMutex);
+
+        auto TEI = _targetEnvironments->find(target);
+        if (TEI != _targetEnvironments->end()) {
+            return TEI->second;
         }
-        return targetEnvironment;
+    }
+
+    /* Don't hold the lock while creating; creation is independent per target. */
+    ext::optional<Target::Environment> targetEnvironment = Target::Environment::Create(buildEnvironment, *this, target);
+    if (!targetEnvironment) {
+        return ext::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(*_targetEnvironmentsMutex);
+
+    /* If another thread created the environment first, use the stored one. */
+    auto result = _targetEnvironments->insert(std::make_pair(target, *targetEnvironment));
+    return result.first->second;
+}
+
+void Build::Context::
+createTargetEnvironments(Build::Environment const &buildEnvironment, std::vector<pbxproj::PBX::Target::shared_ptr> const &targets, size_t jobs) const
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t index = next++; index < targets.size(); index = next++) {
+            (void)targetEnvironment(buildEnvironment, targets[index]);
+        }
+    };
+
+    size_t threads = std::min(jobs, targets.size());
+    if (threads <= 1) {
+        worker();
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    for (size_t n = 0; n < threads; ++n) {
+        pool.push_back(std::thread(worker));
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
     }
 }
 
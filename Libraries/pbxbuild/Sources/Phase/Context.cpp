@@ -25,7 +25,9 @@
 #include <pbxbuild/Target/BuildRules.h>
 #include <libutil/FSUtil.h>
 
+#include <atomic>
 #include <cassert>
+#include <thread>
 
 namespace Phase = pbxbuild::Phase;
 namespace Tool = pbxbuild::Tool;
@@ -33,8 +35,9 @@ namespace Target = pbxbuild::Target;
 using libutil::FSUtil;
 
 Phase::Context::
-Context(Tool::Context const &toolContext) :
-    _toolContext(toolContext)
+Context(Tool::Context const &toolContext, size_t jobs) :
+    _toolContext(toolContext),
+    _jobs       (jobs)
 {
 }
 
@@ -287,6 +290,111 @@ Group(std::vector<Phase::File> const &files)
     return result;
 }
 
+static std::string
+GroupOutputDirectory(Phase::File const &first, std::string const &outputDirectory)
+{
+    std::string fileOutputDirectory = outputDirectory;
+    if (!first.localization().empty()) {
+        fileOutputDirectory += "/" + first.localization() + ".lproj";
+    }
+    return fileOutputDirectory;
+}
+
+static std::string
+GroupToolIdentifier(Phase::File const &first, std::string const &fallbackToolIdentifier)
+{
+    std::string toolIdentifier = fallbackToolIdentifier;
+
+    if (Target::BuildRules::BuildRule::shared_ptr const &buildRule = first.buildRule()) {
+        if (pbxspec::PBX::Tool::shared_ptr const &tool = buildRule->tool()) {
+            // Some tools additionally limit their file types beyond what their build rule allows.
+            // For example, the default compiler limits itself to just source files, despite its
+            // default build rule specifying that it accepts all C-family inputs, including headers.
+            // TODO(grp): Is this the right way to make .h files not get compiled as resources?
+            if (tool->fileTypes() || tool->inputFileTypes()) {
+                std::vector<std::string> toolFileTypes;
+                if (tool->fileTypes()) {
+                    toolFileTypes.insert(toolFileTypes.end(), tool->fileTypes()->begin(), tool->fileTypes()->end());
+                }
+                if (tool->inputFileTypes()) {
+                    toolFileTypes.insert(toolFileTypes.end(), tool->inputFileTypes()->begin(), tool->inputFileTypes()->end());
+                }
+
+                std::string inputFileType = first.fileType()->identifier();
+                bool toolAcceptsInputFileType = (toolFileTypes.empty() || std::find(toolFileTypes.begin(), toolFileTypes.end(), inputFileType) != toolFileTypes.end());
+
+                if (toolAcceptsInputFileType) {
+                    toolIdentifier = tool->identifier();
+                }
+            } else {
+                toolIdentifier = tool->identifier();
+            }
+        }
+    }
+
+    return toolIdentifier;
+}
+
+std::vector<ext::optional<Tool::ClangResolver::Source>> Phase::Context::
+prepareSources(
+    Phase::Environment const &phaseEnvironment,
+    pbxsetting::Environment const &environment,
+    std::vector<std::vector<Phase::File>> const &groups,
+    std::string const &outputDirectory,
+    std::string const &fallbackToolIdentifier)
+{
+    std::vector<ext::optional<Tool::ClangResolver::Source>> sources(groups.size());
+
+    /* Find the groups compiled as sources. */
+    std::vector<size_t> indexes;
+    for (size_t index = 0; index < groups.size(); ++index) {
+        Phase::File const &first = groups[index].front();
+        if (first.buildRule() == nullptr && fallbackToolIdentifier.empty()) {
+            continue;
+        }
+        if (first.buildRule() != nullptr && !first.buildRule()->script().empty()) {
+            continue;
+        }
+
+        if (GroupToolIdentifier(first, fallbackToolIdentifier) == Tool::ClangResolver::ToolIdentifier()) {
+            indexes.push_back(index);
+        }
+    }
+
+    size_t threads = std::min(_jobs, indexes.size());
+    if (threads <= 1) {
+        return sources;
+    }
+
+    Tool::ClangResolver const *clangResolver = this->clangResolver(phaseEnvironment);
+    if (clangResolver == nullptr) {
+        return sources;
+    }
+
+    /*
+     * Preparing a source only reads from the tool context, and each source
+     * is stored in its group's slot, so threads don't share any writes.
+     */
+    Tool::Context const *toolContext = &_toolContext;
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t n = next++; n < indexes.size(); n = next++) {
+            Phase::File const &first = groups[indexes[n]].front();
+            sources[indexes[n]] = clangResolver->prepareSource(toolContext, environment, first, GroupOutputDirectory(first, outputDirectory));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t n = 0; n < threads; ++n) {
+        pool.push_back(std::thread(worker));
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    return sources;
+}
+
 bool Phase::Context::
 resolveBuildFiles(
     Phase::Environment const &phaseEnvironment,
@@ -296,14 +404,19 @@ resolveBuildFiles(
     std::string const &outputDirectory,
     std::string const &fallbackToolIdentifier)
 {
-    for (std::vector<Phase::File> const &files : groups) {
+    /*
+     * Compiling each source is independent, so resolve those up front in
+     * parallel. They are still added to the tool context in order below,
+     * so the invocations are the same as resolving everything serially.
+     */
+    std::vector<ext::optional<Tool::ClangResolver::Source>> sources = prepareSources(phaseEnvironment, environment, groups, outputDirectory, fallbackToolIdentifier);
+
+    for (size_t index = 0; index < groups.size(); ++index) {
+        std::vector<Phase::File> const &files = groups[index];
         assert(!files.empty());
         Phase::File const &first = files.front();
 
-        std::string fileOutputDirectory = outputDirectory;
-        if (!first.localization().empty()) {
-            fileOutputDirectory += "/" + first.localization() + ".lproj";
-        }
+        std::string fileOutputDirectory = GroupOutputDirectory(first, outputDirectory);
 
         Target::BuildRules::BuildRule::shared_ptr const &buildRule = first.buildRule();
         if (buildRule == nullptr && fallbackToolIdentifier.empty()) {
@@ -319,34 +432,7 @@ resolveBuildFiles(
                 return false;
             }
         } else {
-            std::string toolIdentifier = fallbackToolIdentifier;
-
-            if (buildRule != nullptr) {
-                if (pbxspec::PBX::Tool::shared_ptr const &tool = buildRule->tool()) {
-                    // Some tools additionally limit their file types beyond what their build rule allows.
-                    // For example, the default compiler limits itself to just source files, despite its
-                    // default build rule specifying that it accepts all C-family inputs, including headers.
-                    // TODO(grp): Is this the right way to make .h files not get compiled as resources?
-                    if (tool->fileTypes() || tool->inputFileTypes()) {
-                        std::vector<std::string> toolFileTypes;
-                        if (tool->fileTypes()) {
-                            toolFileTypes.insert(toolFileTypes.end(), tool->fileTypes()->begin(), tool->fileTypes()->end());
-                        }
-                        if (tool->inputFileTypes()) {
-                            toolFileTypes.insert(toolFileTypes.end(), tool->inputFileTypes()->begin(), tool->inputFileTypes()->end());
-                        }
-
-                        std::string inputFileType = first.fileType()->identifier();
-                        bool toolAcceptsInputFileType = (toolFileTypes.empty() || std::find(toolFileTypes.begin(), toolFileTypes.end(), inputFileType) != toolFileTypes.end());
-
-                        if (toolAcceptsInputFileType) {
-                            toolIdentifier = tool->identifier();
-                        }
-                    } else {
-                        toolIdentifier = tool->identifier();
-                    }
-                }
-            }
+            std::string toolIdentifier = GroupToolIdentifier(first, fallbackToolIdentifier);
 
             if (toolIdentifier.empty()) {
                 fprintf(stderr, "warning: no tool available for build rule\n");
@@ -362,7 +448,11 @@ resolveBuildFiles(
             } else if (toolIdentifier == Tool::ClangResolver::ToolIdentifier()) {
                 if (Tool::ClangResolver const *clangResolver = this->clangResolver(phaseEnvironment)) {
                     assert(files.size() == 1); // TODO(grp): Is this a valid assertion?
-                    clangResolver->resolveSource(&_toolContext, environment, first, fileOutputDirectory);
+                    if (sources[index]) {
+                        clangResolver->addSource(&_toolContext, environment, *sources[index]);
+                    } else {
+                        clangResolver->resolveSource(&_toolContext, environment, first, fileOutputDirectory);
+                    }
                 } else {
                     return false;
                 }
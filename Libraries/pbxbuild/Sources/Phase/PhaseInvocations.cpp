@@ -40,7 +40,7 @@ Phase::PhaseInvocations::
 }
 
 Phase::PhaseInvocations Phase::PhaseInvocations::
-Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_ptr const &target)
+Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_ptr const &target, size_t jobs)
 {
     Target::Environment const &targetEnvironment = phaseEnvironment.targetEnvironment();
     pbxsetting::Environment const &environment = targetEnvironment.environment();
@@ -55,7 +55,7 @@ Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_
         targetEnvironment.workingDirectory(),
         searchPaths);
 
-    Phase::Context phaseContext(toolContext);
+    Phase::Context phaseContext(toolContext, jobs);
 
     /* Filter build phases to ones appropriate for this target. */
     bool deploymentPostprocessing = pbxsetting::Type::ParseBoolean(environment.resolve("DEPLOYMENT_POSTPROCESSING"));
@@ -101,6 +101,7 @@ resolve(
      * Create the asset catalog invocation.
      */
     Tool::Invocation invocation;
+    invocation.toolIdentifier() = _tool->identifier();
     invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
     invocation.arguments() = arguments;
     invocation.environment() = environmentVariables;
@@ -184,6 +184,7 @@ resolvePrecompiledHeader(
     }
 
     Tool::Invocation invocation;
+    invocation.toolIdentifier() = tool->identifier();
     invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
     invocation.arguments() = arguments;
     invocation.environment() = options.environment();
@@ -202,6 +203,16 @@ resolveSource(
     pbxsetting::Environment const &environment,
     Phase::File const &input,
     std::string const &outputDirectory) const
+{
+    addSource(toolContext, environment, prepareSource(toolContext, environment, input, outputDirectory));
+}
+
+Tool::ClangResolver::Source Tool::ClangResolver::
+prepareSource(
+    Tool::Context const *toolContext,
+    pbxsetting::Environment const &environment,
+    Phase::File const &input,
+    std::string const &outputDirectory) const
 {
     Tool::HeadermapInfo const &headermapInfo = toolContext->headermapInfo();
 
@@ -282,6 +293,7 @@ resolveSource(
     }
 
     Tool::Invocation invocation;
+    invocation.toolIdentifier() = tool->identifier();
     invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
     invocation.arguments() = arguments;
     invocation.environment() = options.environment();
@@ -292,31 +304,45 @@ resolveSource(
     invocation.dependencyInfo() = dependencyInfo;
     invocation.logMessage() = logMessage;
 
+    Tool::ClangResolver::Source source;
+    source._invocation = invocation;
+    source._variantArchitecture = std::make_pair(environment.resolve("variant"), environment.resolve("arch"));
+    source._precompiledHeaderInfo = precompiledHeaderInfo;
+    source._cPlusPlus = DialectIsCPlusPlus(fileType->GCCDialectName());
+    source._linkerArgs = options.linkerArgs();
+    return source;
+}
+
+void Tool::ClangResolver::
+addSource(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &environment,
+    Source const &source) const
+{
     /* Add the compilation invocation to the context. */
-    toolContext->invocations().push_back(invocation);
-    auto variantArchitectureKey = std::make_pair(environment.resolve("variant"), environment.resolve("arch"));
-    toolContext->variantArchitectureInvocations()[variantArchitectureKey].push_back(invocation);
+    toolContext->invocations().push_back(source._invocation);
+    toolContext->variantArchitectureInvocations()[source._variantArchitecture].push_back(source._invocation);
 
     Tool::CompilationInfo *compilationInfo = &toolContext->compilationInfo();
 
     /* If we have precompiled header info, create an invocation for the precompiled header. */
-    if (precompiledHeaderInfo != nullptr) {
-        std::string hash = precompiledHeaderInfo->hash();
+    if (source._precompiledHeaderInfo != nullptr) {
+        std::string hash = source._precompiledHeaderInfo->hash();
 
         auto precompiledHeaderInfoMap = &compilationInfo->precompiledHeaderInfo();
         if (precompiledHeaderInfoMap->find(hash) == precompiledHeaderInfoMap->end()) {
             /* This precompiled header wasn't already created, create it now. */
-            precompiledHeaderInfoMap->insert({ hash, *precompiledHeaderInfo });
+            precompiledHeaderInfoMap->insert({ hash, *source._precompiledHeaderInfo });
 
             resolvePrecompiledHeader(
                 toolContext,
                 environment,
-                *precompiledHeaderInfo
+                *source._precompiledHeaderInfo
             );
         }
     }
 
-    if (DialectIsCPlusPlus(fileType->GCCDialectName()) && _compiler->execCPlusPlusLinkerPath()) {
+    if (source._cPlusPlus && _compiler->execCPlusPlusLinkerPath()) {
         /* If a single C++ file is seen, use the C++ linker driver. */
         compilationInfo->linkerDriver() = *_compiler->execCPlusPlusLinkerPath();
     } else if (compilationInfo->linkerDriver().empty() && _compiler->execPath()) {
@@ -324,7 +350,7 @@ resolveSource(
         compilationInfo->linkerDriver() = _compiler->execPath()->raw();
     }
 
-    for (std::string const &linkerArg : options.linkerArgs()) {
+    for (std::string const &linkerArg : source._linkerArgs) {
         std::vector<std::string> *linkerArguments = &compilationInfo->linkerArguments();
 
         /* Avoid duplicating arguments for multiple compiler invocations. */
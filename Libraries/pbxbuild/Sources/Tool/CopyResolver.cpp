@@ -91,6 +91,7 @@ ResolveInternal(
      * Create the copy invocation.
      */
     Tool::Invocation invocation;
+    invocation.toolIdentifier() = tool->identifier();
     invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
     invocation.arguments() = tokens.arguments();
     invocation.environment() = options.environment();
@@ -29,6 +29,7 @@ resolve(
     std::string logMessage = "Ditto " + targetPath + " " + sourcePath;
 
     Tool::Invocation invocation;
+    invocation.toolIdentifier() = _tool->identifier();
     invocation.executable() = Tool::Invocation::Executable::External("/usr/bin/ditto"); // TODO(grp): Ditto is not portable.
     invocation.arguments() = { "-rsrc", sourcePath, targetPath };
     invocation.workingDirectory() = toolContext->workingDirectory();
@@ -126,6 +126,12 @@ CreateInternal(
      */
     pbxsetting::Environment environment = pbxsetting::Environment(baseEnvironment);
 
+    /*
+     * Tool options resolve many of the same settings for each input. The environment
+     * is private to this tool invocation, so it is safe to memoize the resolution.
+     */
+    environment.setCacheEnabled(true);
+
     /*
      * Add default settings from the tool itself.
      */
@@ -120,6 +120,7 @@ resolve(
     }
 
     Tool::Invocation invocation;
+    invocation.toolIdentifier() = tool->identifier();
     invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
     invocation.arguments() = arguments;
     invocation.environment() = options.environment();
@@ -0,0 +1,657 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxbuild/Tool/OptionsProgram.h>
+#include <pbxbuild/Tool/SearchPaths.h>
+#include <pbxsetting/Environment.h>
+#include <pbxsetting/Type.h>
+#include <plist/Array.h>
+#include <plist/Dictionary.h>
+#include <plist/Object.h>
+#include <plist/String.h>
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <mutex>
+
+namespace Tool = pbxbuild::Tool;
+
+Tool::OptionsProgram::Condition::
+Condition(Type type, std::vector<pbxsetting::Value> const &values, std::vector<std::shared_ptr<Condition const>> const &conditions) :
+    _type      (type),
+    _values    (values),
+    _conditions(conditions)
+{
+}
+
+static bool
+EvaluateExpression(std::string const &expression)
+{
+    /* The original evaluation: split the expanded expression on the first comparison. */
+    std::string::size_type eq = expression.find(" == ");
+    if (eq != std::string::npos) {
+        std::string lhs = expression.substr(0, eq);
+        std::string rhs = expression.substr(eq + 4);
+        return (lhs == rhs);
+    }
+
+    std::string::size_type noteq = expression.find(" != ");
+    if (noteq != std::string::npos) {
+        std::string lhs = expression.substr(0, noteq);
+        std::string rhs = expression.substr(noteq + 4);
+        return (lhs != rhs);
+    }
+
+    return expression != "NO";
+}
+
+bool Tool::OptionsProgram::Condition::
+evaluate(pbxsetting::Environment const &environment) const
+{
+    switch (_type) {
+        case Type::Operand:
+            return environment.expand(_values[0]) != "NO";
+        case Type::Equal:
+            return environment.expand(_values[0]) == environment.expand(_values[1]);
+        case Type::NotEqual:
+            return environment.expand(_values[0]) != environment.expand(_values[1]);
+        case Type::Not:
+            return !_conditions[0]->evaluate(environment);
+        case Type::And:
+            for (std::shared_ptr<Condition const> const &condition : _conditions) {
+                if (!condition->evaluate(environment)) {
+                    return false;
+                }
+            }
+            return true;
+        case Type::Or:
+            for (std::shared_ptr<Condition const> const &condition : _conditions) {
+                if (condition->evaluate(environment)) {
+                    return true;
+                }
+            }
+            return false;
+        case Type::Expression:
+            return EvaluateExpression(environment.expand(_values[0]));
+    }
+
+    return false;
+}
+
+namespace {
+
+struct ConditionToken {
+    enum class Type {
+        Operand,
+        Equal,
+        NotEqual,
+        Not,
+        And,
+        Or,
+        Open,
+        Close,
+    };
+
+    Type        type;
+    std::string text;
+};
+
+typedef Tool::OptionsProgram::Condition Condition;
+typedef std::shared_ptr<Condition const> ConditionPointer;
+
+}
+
+static bool
+IsOperator(std::string const &string, size_t offset)
+{
+    return (string.compare(offset, 2, "&&") == 0 ||
+            string.compare(offset, 2, "||") == 0 ||
+            string.compare(offset, 2, "==") == 0 ||
+            string.compare(offset, 2, "!=") == 0);
+}
+
+static bool
+TokenizeCondition(std::string const &condition, std::vector<ConditionToken> *tokens)
+{
+    size_t offset = 0;
+    while (offset < condition.size()) {
+        char c = condition[offset];
+
+        if (isspace(static_cast<unsigned char>(c))) {
+            offset++;
+        } else if (condition.compare(offset, 2, "&&") == 0) {
+            tokens->push_back({ ConditionToken::Type::And, std::string() });
+            offset += 2;
+        } else if (condition.compare(offset, 2, "||") == 0) {
+            tokens->push_back({ ConditionToken::Type::Or, std::string() });
+            offset += 2;
+        } else if (condition.compare(offset, 2, "==") == 0) {
+            tokens->push_back({ ConditionToken::Type::Equal, std::string() });
+            offset += 2;
+        } else if (condition.compare(offset, 2, "!=") == 0) {
+            tokens->push_back({ ConditionToken::Type::NotEqual, std::string() });
+            offset += 2;
+        } else if (c == '!') {
+            tokens->push_back({ ConditionToken::Type::Not, std::string() });
+            offset++;
+        } else if (c == '(') {
+            tokens->push_back({ ConditionToken::Type::Open, std::string() });
+            offset++;
+        } else if (c == ')') {
+            tokens->push_back({ ConditionToken::Type::Close, std::string() });
+            offset++;
+        } else {
+            /*
+             * An operand extends to the next operator or unmatched close
+             * parenthesis. Setting references and quoted strings are kept
+             * whole, so they can contain operators.
+             */
+            size_t start = offset;
+            size_t depth = 0;
+
+            while (offset < condition.size()) {
+                c = condition[offset];
+
+                if (c == '$' && offset + 1 < condition.size() && (condition[offset + 1] == '(' || condition[offset + 1] == '{')) {
+                    char open = condition[offset + 1];
+                    char close = (open == '(' ? ')' : '}');
+                    size_t level = 0;
+
+                    for (offset++; offset < condition.size(); offset++) {
+                        if (condition[offset] == open) {
+                            level++;
+                        } else if (condition[offset] == close && --level == 0) {
+                            break;
+                        }
+                    }
+
+                    if (offset == condition.size()) {
+                        return false;
+                    }
+                    offset++;
+                } else if (c == '"' || c == '\'') {
+                    size_t end = condition.find(c, offset + 1);
+                    if (end == std::string::npos) {
+                        return false;
+                    }
+                    offset = end + 1;
+                } else if (c == '(') {
+                    depth++;
+                    offset++;
+                } else if (c == ')') {
+                    if (depth == 0) {
+                        break;
+                    }
+                    depth--;
+                    offset++;
+                } else if (depth == 0 && IsOperator(condition, offset)) {
+                    break;
+                } else {
+                    offset++;
+                }
+            }
+
+            size_t end = offset;
+            while (end > start && isspace(static_cast<unsigned char>(condition[end - 1]))) {
+                end--;
+            }
+
+            tokens->push_back({ ConditionToken::Type::Operand, condition.substr(start, end - start) });
+        }
+    }
+
+    return true;
+}
+
+static pbxsetting::Value
+OperandValue(std::string const &text)
+{
+    /* Quotes only delimit the operand; the contents can still reference settings. */
+    if (text.size() >= 2 && (text.front() == '"' || text.front() == '\'') && text.back() == text.front()) {
+        return pbxsetting::Value::Parse(text.substr(1, text.size() - 2));
+    }
+
+    return pbxsetting::Value::Parse(text);
+}
+
+static ConditionPointer
+ParseOr(std::vector<ConditionToken> const &tokens, size_t *index);
+
+static ConditionPointer
+ParsePrimary(std::vector<ConditionToken> const &tokens, size_t *index)
+{
+    if (*index >= tokens.size()) {
+        return nullptr;
+    }
+
+    if (tokens[*index].type == ConditionToken::Type::Open) {
+        (*index)++;
+
+        ConditionPointer condition = ParseOr(tokens, index);
+        if (condition == nullptr || *index >= tokens.size() || tokens[*index].type != ConditionToken::Type::Close) {
+            return nullptr;
+        }
+
+        (*index)++;
+        return condition;
+    }
+
+    if (tokens[*index].type != ConditionToken::Type::Operand) {
+        return nullptr;
+    }
+
+    pbxsetting::Value lhs = OperandValue(tokens[*index].text);
+    (*index)++;
+
+    if (*index < tokens.size() && (tokens[*index].type == ConditionToken::Type::Equal || tokens[*index].type == ConditionToken::Type::NotEqual)) {
+        Condition::Type type = (tokens[*index].type == ConditionToken::Type::Equal ? Condition::Type::Equal : Condition::Type::NotEqual);
+        (*index)++;
+
+        if (*index >= tokens.size() || tokens[*index].type != ConditionToken::Type::Operand) {
+            return nullptr;
+        }
+
+        pbxsetting::Value rhs = OperandValue(tokens[*index].text);
+        (*index)++;
+
+        return std::make_shared<Condition>(type, std::vector<pbxsetting::Value>({ lhs, rhs }), std::vector<ConditionPointer>());
+    }
+
+    return std::make_shared<Condition>(Condition::Type::Operand, std::vector<pbxsetting::Value>({ lhs }), std::vector<ConditionPointer>());
+}
+
+static ConditionPointer
+ParseNot(std::vector<ConditionToken> const &tokens, size_t *index)
+{
+    if (*index < tokens.size() && tokens[*index].type == ConditionToken::Type::Not) {
+        (*index)++;
+
+        ConditionPointer condition = ParseNot(tokens, index);
+        if (condition == nullptr) {
+            return nullptr;
+        }
+
+        return std::make_shared<Condition>(Condition::Type::Not, std::vector<pbxsetting::Value>(), std::vector<ConditionPointer>({ condition }));
+    }
+
+    return ParsePrimary(tokens, index);
+}
+
+static ConditionPointer
+ParseBinary(
+    std::vector<ConditionToken> const &tokens,
+    size_t *index,
+    ConditionToken::Type token,
+    Condition::Type type,
+    ConditionPointer (*parseOperand)(std::vector<ConditionToken> const &, size_t *))
+{
+    std::vector<ConditionPointer> conditions;
+
+    do {
+        if (!conditions.empty()) {
+            (*index)++;
+        }
+
+        ConditionPointer condition = parseOperand(tokens, index);
+        if (condition == nullptr) {
+            return nullptr;
+        }
+        conditions.push_back(condition);
+    } while (*index < tokens.size() && tokens[*index].type == token);
+
+    if (conditions.size() == 1) {
+        return conditions.front();
+    }
+
+    return std::make_shared<Condition>(type, std::vector<pbxsetting::Value>(), conditions);
+}
+
+static ConditionPointer
+ParseAnd(std::vector<ConditionToken> const &tokens, size_t *index)
+{
+    return ParseBinary(tokens, index, ConditionToken::Type::And, Condition::Type::And, &ParseNot);
+}
+
+static ConditionPointer
+ParseOr(std::vector<ConditionToken> const &tokens, size_t *index)
+{
+    return ParseBinary(tokens, index, ConditionToken::Type::Or, Condition::Type::Or, &ParseAnd);
+}
+
+Tool::OptionsProgram::Condition Tool::OptionsProgram::Condition::
+Parse(std::string const &condition)
+{
+    std::vector<ConditionToken> tokens;
+    if (TokenizeCondition(condition, &tokens)) {
+        size_t index = 0;
+        ConditionPointer result = ParseOr(tokens, &index);
+        if (result != nullptr && index == tokens.size()) {
+            return *result;
+        }
+    }
+
+    /* Fall back to evaluating the expanded expression as a whole. */
+    return Condition(Type::Expression, { pbxsetting::Value::Parse(condition) }, { });
+}
+
+Tool::OptionsProgram::Template::
+Template(pbxsetting::Value const &value) :
+    _value (value),
+    _direct(true)
+{
+    for (pbxsetting::Value::Entry const &entry : _value.entries()) {
+        if (entry.type() == pbxsetting::Value::Entry::Type::String) {
+            _parts.push_back({ false, *entry.string() });
+        } else if (entry.reference() != nullptr && entry.reference()->setting() == "value" && entry.reference()->operations().empty()) {
+            _parts.push_back({ true, std::string() });
+        } else {
+            /* References other settings; needs a full expansion. */
+            _direct = false;
+            _parts.clear();
+            break;
+        }
+    }
+}
+
+std::string Tool::OptionsProgram::Template::
+substitute(std::string const &value) const
+{
+    std::string result;
+    for (std::pair<bool, std::string> const &part : _parts) {
+        result += (part.first ? value : part.second);
+    }
+    return result;
+}
+
+static std::vector<Tool::OptionsProgram::Template>
+TemplatesFromArray(plist::Array const *args)
+{
+    std::vector<Tool::OptionsProgram::Template> templates;
+    for (size_t n = 0; n < args->count(); n++) {
+        if (auto arg = args->value <plist::String> (n)) {
+            templates.push_back(Tool::OptionsProgram::Template(pbxsetting::Value::Parse(arg->value())));
+        }
+    }
+    return templates;
+}
+
+Tool::OptionsProgram::Arguments::
+Arguments(plist::Object const *arguments) :
+    _keyed(false)
+{
+    /*
+     * `CommandLineArgs` and `AdditionalLinkerArgs` are either arrays of arguments or dictionaries
+     * mapping values to arrays of arguments. The key `<<otherwise>>` is special-cased as a fallback.
+     */
+
+    if (auto args = plist::CastTo <plist::Array> (arguments)) {
+        _arguments = TemplatesFromArray(args);
+    } else if (auto argsValues = plist::CastTo <plist::Dictionary> (arguments)) {
+        _keyed = true;
+
+        for (size_t n = 0; n < argsValues->count(); n++) {
+            if (auto args = argsValues->value <plist::Array> (n)) {
+                std::string const &key = argsValues->key(n);
+                if (key == "<<otherwise>>") {
+                    _otherwise = TemplatesFromArray(args);
+                }
+                _keyedArguments.insert({ key, TemplatesFromArray(args) });
+            }
+        }
+    }
+}
+
+std::vector<Tool::OptionsProgram::Template> const *Tool::OptionsProgram::Arguments::
+select(std::string const &value) const
+{
+    if (!_keyed) {
+        return &_arguments;
+    }
+
+    auto it = _keyedArguments.find(value);
+    if (it != _keyedArguments.end()) {
+        return &it->second;
+    } else if (_otherwise) {
+        return &*_otherwise;
+    } else {
+        return nullptr;
+    }
+}
+
+static void
+AddValuesTemplates(std::vector<std::pair<std::string, std::vector<Tool::OptionsProgram::Template>>> *result, plist::Array const *values)
+{
+    if (values == nullptr) {
+        return;
+    }
+
+    /*
+     * `Values` and `AllowedValues` are arrays of value dictoinaries. Each value has a key `Value`
+     * with the expected value itself and `CommandLineFlag` / `CommandLineArguments` to add for it.
+     */
+
+    for (size_t n = 0; n < values->count(); n++) {
+        if (auto entry = values->value <plist::Dictionary> (n)) {
+            if (auto entryValue = entry->value <plist::String> ("Value")) {
+                if (auto entryFlag = entry->value <plist::String> ("CommandLineFlag")) {
+                    result->push_back({ entryValue->value(), { Tool::OptionsProgram::Template(pbxsetting::Value::Parse(entryFlag->value())) } });
+                } else if (auto entryArgs = entry->value <plist::Array> ("CommandLineArgs")) {
+                    result->push_back({ entryValue->value(), TemplatesFromArray(entryArgs) });
+                }
+            }
+        }
+    }
+}
+
+Tool::OptionsProgram::Option::
+Option(pbxspec::PBX::PropertyOption::shared_ptr const &option) :
+    option              (option),
+    boolean             (option->type() == "Boolean" || option->type() == "bool"),
+    list                ((option->type() == "StringList" || option->type() == "stringlist") ||
+                         (option->type() == "PathList" || option->type() == "pathlist")),
+    commandLineArgs     (option->commandLineArgs()),
+    additionalLinkerArgs(option->additionalLinkerArgs())
+{
+    if (option->condition()) {
+        condition = Condition::Parse(*option->condition());
+    }
+    if (option->commandLineCondition()) {
+        commandLineCondition = Condition::Parse(*option->commandLineCondition());
+    }
+
+    if (option->architectures()) {
+        architectures = std::unordered_set<std::string>(option->architectures()->begin(), option->architectures()->end());
+    }
+    if (option->fileTypes()) {
+        fileTypes = std::unordered_set<std::string>(option->fileTypes()->begin(), option->fileTypes()->end());
+    }
+
+    if (option->commandLineFlag()) {
+        /* Pass both the command line flag and the option value itself. */
+        flag = { Template(*option->commandLineFlag()), Template(pbxsetting::Value::Variable("value")) };
+    }
+
+    AddValuesTemplates(&values, plist::CastTo<plist::Array>(option->values()));
+    AddValuesTemplates(&values, plist::CastTo<plist::Array>(option->allowedValues()));
+
+    if (option->commandLinePrefixFlag()) {
+        /* Pass the prefix then the option value in the same argument. */
+        prefixFlag = { Template(*option->commandLinePrefixFlag() + pbxsetting::Value::Variable("value")) };
+    }
+}
+
+Tool::OptionsProgram::
+OptionsProgram(
+    std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
+    std::unordered_set<std::string> const &deletedSettings)
+{
+    for (pbxspec::PBX::PropertyOption::shared_ptr const &option : options) {
+        if (deletedSettings.find(option->name()) != deletedSettings.end()) {
+            continue;
+        }
+
+        _options.push_back(Option(option));
+    }
+}
+
+static void
+AddArgumentValue(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::vector<Tool::OptionsProgram::Template> const &templates, std::string const &value)
+{
+    bool direct = std::all_of(templates.begin(), templates.end(), [](Tool::OptionsProgram::Template const &arg) {
+        return arg.direct();
+    });
+
+    if (direct) {
+        for (Tool::OptionsProgram::Template const &arg : templates) {
+            arguments->push_back(arg.substitute(value));
+        }
+    } else {
+        pbxsetting::Environment argEnvironment = pbxsetting::Environment(environment);
+        argEnvironment.insertFront(pbxsetting::Level({
+            pbxsetting::Setting::Create("value", value),
+        }), false);
+
+        for (Tool::OptionsProgram::Template const &arg : templates) {
+            arguments->push_back(argEnvironment.expand(arg.value()));
+        }
+    }
+}
+
+Tool::OptionsResult Tool::OptionsProgram::
+run(
+    pbxsetting::Environment const &environment,
+    std::string const &workingDirectory,
+    pbxspec::PBX::FileType::shared_ptr const &fileType) const
+{
+    std::vector<std::string> arguments;
+    std::unordered_map<std::string, std::string> environmentVariables;
+    std::vector<std::string> linkerArgs;
+
+    std::string architecture = environment.resolve("arch");
+
+    for (Option const &entry : _options) {
+        pbxspec::PBX::PropertyOption::shared_ptr const &option = entry.option;
+
+        if (entry.condition && !entry.condition->evaluate(environment)) {
+            continue;
+        }
+        if (entry.commandLineCondition && !entry.commandLineCondition->evaluate(environment)) {
+            continue;
+        }
+
+        if (entry.architectures && entry.architectures->find(architecture) == entry.architectures->end()) {
+            continue;
+        }
+
+        if (entry.fileTypes && fileType != nullptr && entry.fileTypes->find(fileType->identifier()) == entry.fileTypes->end()) {
+            continue;
+        }
+
+        // TODO(grp): Use PropertyOption::conditionFlavors().
+        std::string value = environment.resolve(option->name());
+
+        /* List options add their arguments once for each item in the list. */
+        ext::optional<std::vector<std::string>> listValues;
+        auto add = [&](std::vector<std::string> *output, std::vector<Template> const &templates) {
+            /* Nothing to add; avoid splitting and expanding the list for nothing. */
+            if (templates.empty()) {
+                return;
+            }
+
+            if (entry.list) {
+                if (!listValues) {
+                    listValues = pbxsetting::Type::ParseList(value);
+                    if (option->flattenRecursiveSearchPathsInValue()) {
+                        listValues = Tool::SearchPaths::ExpandRecursive(*listValues, environment, workingDirectory);
+                    }
+                }
+
+                for (std::string const &listValue : *listValues) {
+                    AddArgumentValue(output, environment, templates, listValue);
+                }
+            } else {
+                AddArgumentValue(output, environment, templates, value);
+            }
+        };
+
+        if (entry.boolean) {
+            bool booleanValue = pbxsetting::Type::ParseBoolean(value);
+            ext::optional<pbxsetting::Value> const &flag = (booleanValue ? option->commandLineFlag() : option->commandLineFlagIfFalse());
+
+            if (flag) {
+                /* Boolean flags don't get the flag value after, since that would be just YES or NO. */
+                arguments.push_back(environment.expand(*flag));
+            }
+        } else {
+            if (!value.empty() && !entry.flag.empty()) {
+                add(&arguments, entry.flag);
+            }
+        }
+
+        for (std::pair<std::string, std::vector<Template>> const &values : entry.values) {
+            if (values.first == value) {
+                add(&arguments, values.second);
+            }
+        }
+
+        if (!value.empty() && !entry.prefixFlag.empty()) {
+            add(&arguments, entry.prefixFlag);
+        }
+
+        if (std::vector<Template> const *templates = entry.commandLineArgs.select(value)) {
+            add(&arguments, *templates);
+        }
+        if (std::vector<Template> const *templates = entry.additionalLinkerArgs.select(value)) {
+            add(&linkerArgs, *templates);
+        }
+
+        if (option->setValueInEnvironmentVariable()) {
+            std::string const &variable = environment.expand(*option->setValueInEnvironmentVariable());
+            environmentVariables.insert({ variable, value });
+        }
+
+        // TODO(grp): Use PropertyOption::conditionFlavors().
+        // TODO(grp): Use PropertyOption::isCommand{Input,Output}().
+        // TODO(grp): Use PropertyOption::isInputDependency(), PropertyOption::outputDependencies().
+        // TODO(grp): Use PropertyOption::outputsAreSourceFiles().
+    }
+
+    return Tool::OptionsResult(arguments, environmentVariables, linkerArgs);
+}
+
+Tool::OptionsProgram::shared_ptr Tool::OptionsProgram::
+ForTool(pbxspec::PBX::Tool::shared_ptr const &tool)
+{
+    typedef std::map<std::weak_ptr<pbxspec::PBX::Tool>, OptionsProgram::shared_ptr, std::owner_less<std::weak_ptr<pbxspec::PBX::Tool>>> ProgramMap;
+    static std::mutex mutex;
+    static ProgramMap programs;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = programs.find(tool);
+    if (it != programs.end()) {
+        return it->second;
+    }
+
+    /* Drop programs for tools that no longer exist. */
+    for (auto pit = programs.begin(); pit != programs.end();) {
+        if (pit->first.expired()) {
+            pit = programs.erase(pit);
+        } else {
+            ++pit;
+        }
+    }
+
+    OptionsProgram::shared_ptr program = std::make_shared<OptionsProgram>(
+        tool->options().value_or(pbxspec::PBX::PropertyOption::vector()),
+        tool->deletedProperties().value_or(std::unordered_set<std::string>()));
+    programs.insert({ tool, program });
+    return program;
+}
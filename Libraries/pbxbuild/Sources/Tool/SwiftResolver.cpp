@@ -395,6 +395,7 @@ resolve(
      * Add the invocation.
      */
     Tool::Invocation invocation;
+    invocation.toolIdentifier() = _compiler->identifier();
     invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
     invocation.arguments() = arguments;
     invocation.environment() = options.environment();
@@ -0,0 +1,78 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/FileTypeResolver.h>
+#include <pbxspec/Manager.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxbuild::FileTypeResolver;
+using libutil::MemoryFilesystem;
+
+/*
+ * File types covering each kind of check, with a file type based on
+ * another that matches the same extension.
+ */
+static std::string const Specifications = R"((
+    { Type = FileType; Identifier = file; },
+    { Type = FileType; Identifier = folder; IsFolder = YES; },
+    { Type = FileType; Identifier = text; Extensions = (strings, txt); },
+    { Type = FileType; Identifier = text.plist.strings; BasedOn = text; Extensions = (strings); },
+    { Type = FileType; Identifier = sourcecode.c.c; Extensions = (c); },
+    { Type = FileType; Identifier = wrapper.cfbundle; IsFolder = YES; Extensions = (bundle); },
+    { Type = FileType; Identifier = archive.prefixed; Prefix = (lib); },
+    { Type = FileType; Identifier = text.plist.info; FilenamePatterns = ("Info*.plist"); },
+))";
+
+static std::string
+Identifier(pbxspec::PBX::FileType::shared_ptr const &fileType)
+{
+    return (fileType != nullptr ? fileType->identifier() : std::string());
+}
+
+TEST(FileTypeResolver, Resolve)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("spec", {
+            MemoryFilesystem::Entry::File("Types.xcspec", std::vector<uint8_t>(Specifications.begin(), Specifications.end())),
+        }),
+        MemoryFilesystem::Entry::Directory("src", {
+            MemoryFilesystem::Entry::File("main.c", std::vector<uint8_t>()),
+            MemoryFilesystem::Entry::Directory("Resources.bundle", { }),
+            MemoryFilesystem::Entry::Directory("Other.dir", { }),
+        }),
+    });
+
+    auto specManager = pbxspec::Manager::Create();
+    specManager->registerDomains(&filesystem, { { "test", "/spec" } });
+    std::vector<std::string> const domains = { "test" };
+
+    /* Extensions, case insensitively. */
+    EXPECT_EQ("sourcecode.c.c", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/main.c")));
+    EXPECT_EQ("sourcecode.c.c", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/other.C")));
+    EXPECT_EQ("text", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/notes.txt")));
+
+    /* More specific file types are checked before their base types. */
+    EXPECT_EQ("text.plist.strings", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/Localizable.strings")));
+
+    /* Folders only match folder types. */
+    EXPECT_EQ("wrapper.cfbundle", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/Resources.bundle")));
+    EXPECT_EQ("folder", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/Other.dir")));
+
+    /* Prefixes and filename patterns. */
+    EXPECT_EQ("archive.prefixed", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/libfoo")));
+    EXPECT_EQ("text.plist.info", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/Info-iOS.plist")));
+    EXPECT_EQ("file", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/Other.plist")));
+
+    /* Unknown files fall back to a generic type. */
+    EXPECT_EQ("file", Identifier(FileTypeResolver::Resolve(&filesystem, specManager, domains, "/src/unknown")));
+
+    /* The classifier is built once per set of domains. */
+    EXPECT_EQ(specManager->fileTypeClassifier(domains), specManager->fileTypeClassifier(domains));
+}
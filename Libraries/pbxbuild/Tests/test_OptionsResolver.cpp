@@ -632,6 +632,79 @@ TEST(OptionsResolver, Architectures)
     }));
 }
 
+/*
+ * Test `Condition` and `CommandLineCondition` expressions are evaluated.
+ */
+TEST(OptionsResolver, Conditions)
+{
+    std::vector<pbxspec::PBX::PropertyOption::shared_ptr> options = {
+        OPTION({
+            Name = EQUAL;
+            Type = Boolean;
+            Condition = "$(ENABLED) == YES";
+            CommandLineFlag = "equal";
+        }),
+        OPTION({
+            Name = NOT_EQUAL;
+            Type = Boolean;
+            CommandLineCondition = "$(ENABLED) != YES";
+            CommandLineFlag = "not-equal";
+        }),
+        OPTION({
+            Name = AND;
+            Type = Boolean;
+            Condition = "$(ENABLED) == YES && $(DISABLED) == NO";
+            CommandLineFlag = "and";
+        }),
+        OPTION({
+            Name = OR;
+            Type = Boolean;
+            Condition = "$(DISABLED) == YES || $(ENABLED) == YES";
+            CommandLineFlag = "or";
+        }),
+        OPTION({
+            Name = NOT_GROUPED;
+            Type = Boolean;
+            Condition = "!($(DISABLED) == YES || $(ENABLED) == NO)";
+            CommandLineFlag = "not-grouped";
+        }),
+        OPTION({
+            Name = QUOTED;
+            Type = Boolean;
+            Condition = "$(EMPTY) != ''";
+            CommandLineFlag = "quoted";
+        }),
+        OPTION({
+            Name = OPERAND;
+            Type = Boolean;
+            Condition = "$(DISABLED)";
+            CommandLineFlag = "operand";
+        }),
+    };
+
+    auto environment = Environment({
+        pbxsetting::Setting::Create("EQUAL", "YES"),
+        pbxsetting::Setting::Create("NOT_EQUAL", "YES"),
+        pbxsetting::Setting::Create("AND", "YES"),
+        pbxsetting::Setting::Create("OR", "YES"),
+        pbxsetting::Setting::Create("NOT_GROUPED", "YES"),
+        pbxsetting::Setting::Create("QUOTED", "YES"),
+        pbxsetting::Setting::Create("OPERAND", "YES"),
+
+        pbxsetting::Setting::Create("ENABLED", "YES"),
+        pbxsetting::Setting::Create("DISABLED", "NO"),
+        pbxsetting::Setting::Create("EMPTY", ""),
+    });
+
+    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    EXPECT_EQ(result.arguments(), std::vector<std::string>({
+        "equal",
+        "and",
+        "or",
+        "not-grouped",
+    }));
+}
+
 /*
 
 To test:
@@ -640,8 +713,6 @@ To test:
     PropertyOption::flattenRecursiveSearchPathsInValue()
 
 Unsupported:
-    PropertyOption::commandLineCondition()
-    PropertyOption::condition()
     PropertyOption::conditionFlavors()
     PropertyOption::isCommandInput()
     PropertyOption::isCommandOutput()
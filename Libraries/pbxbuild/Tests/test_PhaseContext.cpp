@@ -0,0 +1,154 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Phase/Context.h>
+#include <pbxbuild/Phase/Environment.h>
+#include <pbxbuild/Phase/File.h>
+#include <pbxbuild/Build/Context.h>
+#include <pbxbuild/Build/Environment.h>
+#include <pbxbuild/Target/Environment.h>
+#include <pbxbuild/Target/BuildRules.h>
+#include <pbxbuild/Tool/ClangResolver.h>
+#include <pbxbuild/Tool/Context.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <pbxbuild/WorkspaceContext.h>
+#include <pbxproj/PBX/AggregateTarget.h>
+#include <pbxproj/PBX/BuildFile.h>
+#include <pbxsetting/Environment.h>
+#include <pbxsetting/Level.h>
+#include <pbxsetting/Setting.h>
+#include <pbxspec/Manager.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <string>
+#include <vector>
+
+namespace Build = pbxbuild::Build;
+namespace Phase = pbxbuild::Phase;
+namespace Target = pbxbuild::Target;
+namespace Tool = pbxbuild::Tool;
+using libutil::MemoryFilesystem;
+
+static std::string const Specifications = R"SPEC(
+(
+    {
+        Type = Compiler;
+        Identifier = com.apple.compilers.llvm.clang.1_0.compiler;
+        Name = "Clang";
+        ExecPath = clang;
+        ExecCPlusPlusLinkerPath = "clang++";
+        OutputDir = "$(OBJECT_FILE_DIR_$(variant))/$(arch)";
+        Options = (
+            {
+                Name = GCC_OPTIMIZATION_LEVEL;
+                Type = Enumeration;
+                Values = ( 0, s );
+                DefaultValue = s;
+                CommandLineArgs = ( "-O$(value)" );
+            },
+            {
+                Name = CLANG_ENABLE_OBJC_ARC;
+                Type = Boolean;
+                DefaultValue = YES;
+                CommandLineArgs = { YES = ( "-fobjc-arc" ); NO = (); };
+                AdditionalLinkerArgs = { YES = ( "-fobjc-arc" ); NO = (); };
+            },
+        );
+    },
+    {
+        Type = FileType;
+        Identifier = sourcecode.c.c;
+        Extensions = ( c );
+        GccDialectName = c;
+    },
+    {
+        Type = FileType;
+        Identifier = sourcecode.cpp.cpp;
+        Extensions = ( cpp );
+        GccDialectName = "c++";
+    },
+)
+)SPEC";
+
+/*
+ * Resolves sources into a fresh tool context using the given number of jobs.
+ */
+static Tool::Context
+ResolveSources(Phase::Environment const &phaseEnvironment, pbxsetting::Environment const &environment, std::vector<std::vector<Phase::File>> const &groups, size_t jobs)
+{
+    Tool::Context toolContext = Tool::Context(nullptr, { }, "/src", Tool::SearchPaths({ }, { }, { }, { }));
+    Phase::Context phaseContext(toolContext, jobs);
+    EXPECT_TRUE(phaseContext.resolveBuildFiles(phaseEnvironment, environment, nullptr, groups, "/obj", Tool::ClangResolver::ToolIdentifier()));
+    return phaseContext.toolContext();
+}
+
+TEST(PhaseContext, ParallelSourcesMatchSerial)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Specifications", {
+            MemoryFilesystem::Entry::File("Clang.xcspec", std::vector<uint8_t>(Specifications.begin(), Specifications.end())),
+        }),
+    });
+
+    auto specManager = pbxspec::Manager::Create();
+    specManager->registerDomains(&filesystem, { { "test", "/Specifications" } });
+    std::vector<std::string> const specDomains = { "test" };
+
+    pbxspec::PBX::FileType::shared_ptr c = specManager->fileType("sourcecode.c.c", specDomains);
+    pbxspec::PBX::FileType::shared_ptr cpp = specManager->fileType("sourcecode.cpp.cpp", specDomains);
+    ASSERT_NE(c, nullptr);
+    ASSERT_NE(cpp, nullptr);
+
+    pbxsetting::Environment environment;
+    environment.insertFront(pbxsetting::Level({
+        pbxsetting::Setting::Create("variant", "normal"),
+        pbxsetting::Setting::Create("arch", "arm64"),
+        pbxsetting::Setting::Create("OBJECT_FILE_DIR_normal", "/obj/Objects-normal"),
+        pbxsetting::Setting::Create("GCC_PREFIX_HEADER", "Prefix.pch"),
+        pbxsetting::Setting::Create("GCC_PRECOMPILE_PREFIX_HEADER", "YES"),
+    }), false);
+
+    /* Enough sources for each thread to resolve several. */
+    auto buildFile = std::make_shared<pbxproj::PBX::BuildFile>();
+    std::vector<std::vector<Phase::File>> groups;
+    for (size_t i = 0; i < 40; ++i) {
+        bool isCPlusPlus = (i % 7 == 3);
+        std::string name = "File" + std::to_string(i) + (isCPlusPlus ? ".cpp" : ".c");
+        std::string disambiguator = (i % 11 == 5 ? "File" + std::to_string(i) + "-1" : std::string());
+        groups.push_back({ Phase::File(buildFile, nullptr, (isCPlusPlus ? cpp : c), "/src/" + name, std::string(), disambiguator) });
+    }
+
+    auto target = std::make_shared<pbxproj::PBX::AggregateTarget>();
+    Build::Environment buildEnvironment = Build::Environment(specManager, nullptr, pbxsetting::Environment());
+    pbxbuild::WorkspaceContext workspaceContext = pbxbuild::WorkspaceContext("/src", pbxbuild::DerivedDataHash("Test", "hash"), nullptr, nullptr, { }, { }, { });
+    Build::Context buildContext = Build::Context(workspaceContext, nullptr, nullptr, "build", "Debug", false, { });
+    Target::Environment targetEnvironment = Target::Environment(nullptr, { }, { }, Target::BuildRules::Create(specManager, specDomains, target), specDomains, nullptr, nullptr, nullptr, environment, { "normal" }, { "arm64" }, "/src", { });
+    Phase::Environment phaseEnvironment = Phase::Environment(buildEnvironment, buildContext, target, targetEnvironment);
+
+    Tool::Context serial = ResolveSources(phaseEnvironment, environment, groups, 1);
+    Tool::Context parallel = ResolveSources(phaseEnvironment, environment, groups, 4);
+
+    /* A precompiled header for each dialect, and each source, in order. */
+    ASSERT_EQ(serial.invocations().size(), groups.size() + 2);
+    ASSERT_EQ(parallel.invocations().size(), serial.invocations().size());
+    for (size_t i = 0; i < serial.invocations().size(); ++i) {
+        Tool::Invocation const &expected = serial.invocations()[i];
+        Tool::Invocation const &actual = parallel.invocations()[i];
+        EXPECT_EQ(actual.arguments(), expected.arguments());
+        EXPECT_EQ(actual.inputs(), expected.inputs());
+        EXPECT_EQ(actual.outputs(), expected.outputs());
+        EXPECT_EQ(actual.inputDependencies(), expected.inputDependencies());
+        EXPECT_EQ(actual.logMessage(), expected.logMessage());
+    }
+
+    EXPECT_EQ(parallel.compilationInfo().linkerDriver(), serial.compilationInfo().linkerDriver());
+    EXPECT_EQ(parallel.compilationInfo().linkerArguments(), serial.compilationInfo().linkerArguments());
+    EXPECT_EQ(parallel.compilationInfo().precompiledHeaderInfo().size(), serial.compilationInfo().precompiledHeaderInfo().size());
+}
@@ -0,0 +1,136 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxbuild/FileTypeResolver.h>
+#include <pbxspec/Manager.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using libutil::DefaultFilesystem;
+using libutil::MemoryFilesystem;
+
+/*
+ * Files in a target, held in memory. Unlike on disk, memory files are all
+ * executable, which would match them to executable file types.
+ */
+class TargetFilesystem : public MemoryFilesystem {
+public:
+    using MemoryFilesystem::MemoryFilesystem;
+
+public:
+    virtual bool isExecutable(std::string const &path) const
+    { return false; }
+};
+
+int
+main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "usage: %s <specifications> [files]\n", argv[0]);
+        return 1;
+    }
+
+    size_t count = (argc == 3 ? std::max(1, atoi(argv[2])) : 50000);
+
+    DefaultFilesystem filesystem = DefaultFilesystem();
+    auto specManager = pbxspec::Manager::Create();
+    specManager->registerDomains(&filesystem, { { "bench", argv[1] } });
+    std::vector<std::string> const domains = { "bench" };
+
+    /*
+     * Collect the names a synthetic target could contain: one for each
+     * extension, prefix and filename pattern, plus names no type matches.
+     */
+    std::vector<std::string> names;
+    for (pbxspec::PBX::FileType::shared_ptr const &fileType : specManager->fileTypes(domains)) {
+        if (fileType->isFolder()) {
+            continue;
+        }
+
+        for (std::string const &extension : fileType->extensions().value_or(std::vector<std::string>())) {
+            names.push_back("File." + extension);
+        }
+        for (std::string const &prefix : fileType->prefix().value_or(std::vector<std::string>())) {
+            names.push_back(prefix + "File");
+        }
+        for (std::string const &pattern : fileType->filenamePatterns().value_or(std::vector<std::string>())) {
+            std::string name = pattern;
+            std::replace(name.begin(), name.end(), '*', 'X');
+            std::replace(name.begin(), name.end(), '?', 'X');
+            names.push_back(name);
+        }
+    }
+    names.push_back("File.unknown");
+    names.push_back("README");
+
+    /*
+     * Spread the files over directories, like the groups of a large target.
+     * Names are unique within each directory.
+     */
+    size_t const perDirectory = std::min<size_t>(100, names.size());
+    std::vector<MemoryFilesystem::Entry> directories;
+    std::vector<std::string> paths;
+    for (size_t index = 0; index < count; index += perDirectory) {
+        std::string directory = "Group" + std::to_string(index / perDirectory);
+
+        std::vector<MemoryFilesystem::Entry> files;
+        for (size_t file = index; file < std::min(count, index + perDirectory); ++file) {
+            std::string name = names[file % names.size()];
+            files.push_back(MemoryFilesystem::Entry::File(name, std::vector<uint8_t>()));
+            paths.push_back("/src/" + directory + "/" + name);
+        }
+
+        directories.push_back(MemoryFilesystem::Entry::Directory(directory, files));
+    }
+    TargetFilesystem target = TargetFilesystem({ MemoryFilesystem::Entry::Directory("src", directories) });
+
+    printf("%zu file types, %zu names, %zu files\n\n", specManager->fileTypes(domains).size(), names.size(), paths.size());
+    printf("%-12s %12s %12s\n", "phase", "total ms", "us/file");
+
+    /* The first file also builds the classifier. */
+    auto start = std::chrono::steady_clock::now();
+    pbxbuild::FileTypeResolver::Resolve(&target, specManager, domains, paths.front());
+    auto end = std::chrono::steady_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12.1f %12s\n", "first", ms, "");
+
+    /* For comparison, the cost of only looking up each file. */
+    start = std::chrono::steady_clock::now();
+    for (std::string const &path : paths) {
+        target.stat(path);
+    }
+    end = std::chrono::steady_clock::now();
+
+    ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12.1f %12.3f\n", "stat", ms, ms * 1000.0 / paths.size());
+
+    std::unordered_map<std::string, size_t> types;
+    start = std::chrono::steady_clock::now();
+    for (std::string const &path : paths) {
+        pbxspec::PBX::FileType::shared_ptr fileType = pbxbuild::FileTypeResolver::Resolve(&target, specManager, domains, path);
+        types[fileType != nullptr ? fileType->identifier() : std::string()]++;
+    }
+    end = std::chrono::steady_clock::now();
+
+    ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12.1f %12.3f\n", "resolve", ms, ms * 1000.0 / paths.size());
+
+    printf("\n%zu distinct file types resolved\n", types.size());
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxbuild/Tool/OptionsProgram.h>
+#include <pbxbuild/Tool/OptionsResult.h>
+#include <pbxspec/Manager.h>
+#include <pbxsetting/Environment.h>
+#include <pbxsetting/Level.h>
+#include <pbxsetting/Setting.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace Tool = pbxbuild::Tool;
+using libutil::DefaultFilesystem;
+
+int
+main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "usage: %s <specifications> [files]\n", argv[0]);
+        return 1;
+    }
+
+    int count = (argc == 3 ? std::max(1, atoi(argv[2])) : 1000);
+
+    /*
+     * Load the specifications, each kind from its own directory.
+     */
+    DefaultFilesystem filesystem = DefaultFilesystem();
+    std::vector<std::pair<std::string, std::string>> directories;
+    filesystem.enumerateDirectory(argv[1], [&](std::string const &name) {
+        std::string path = std::string(argv[1]) + "/" + name;
+        if (filesystem.isDirectory(path)) {
+            directories.push_back({ "bench", path });
+        }
+    });
+
+    auto specManager = pbxspec::Manager::Create();
+    specManager->registerDomains(&filesystem, directories);
+    std::vector<std::string> const domains = { "bench" };
+
+    pbxspec::PBX::Compiler::shared_ptr clang = specManager->compiler("com.apple.compilers.llvm.clang.1_0", domains);
+    if (clang == nullptr) {
+        fprintf(stderr, "error: clang specification not found in %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<pbxspec::PBX::PropertyOption::shared_ptr> options = clang->options().value_or(pbxspec::PBX::PropertyOption::vector());
+    std::unordered_set<std::string> deletedSettings = clang->deletedProperties().value_or(std::unordered_set<std::string>());
+    pbxspec::PBX::FileType::shared_ptr fileType = specManager->fileType("sourcecode.c.objc", domains);
+
+    /*
+     * Evaluate against the compiler's defaults and a typical target.
+     */
+    pbxsetting::Environment environment;
+    environment.insertBack(clang->defaultSettings(), false);
+    environment.insertFront(pbxsetting::Level({
+        pbxsetting::Setting::Create("arch", "arm64"),
+        pbxsetting::Setting::Create("CURRENT_ARCH", "arm64"),
+        pbxsetting::Setting::Create("CURRENT_VARIANT", "normal"),
+        pbxsetting::Setting::Create("SDKROOT", "/SDKs/iPhoneOS.sdk"),
+        pbxsetting::Setting::Create("GCC_OPTIMIZATION_LEVEL", "s"),
+        pbxsetting::Setting::Create("CLANG_ENABLE_OBJC_ARC", "YES"),
+        pbxsetting::Setting::Create("CLANG_ENABLE_MODULES", "YES"),
+        pbxsetting::Setting::Create("HEADER_SEARCH_PATHS", "/src/include /src/vendor/include"),
+        pbxsetting::Setting::Create("GCC_PREPROCESSOR_DEFINITIONS", "DEBUG=1 FEATURE=1"),
+    }), false);
+
+    std::string workingDirectory = "/src";
+
+    printf("%zu clang options, %d files\n\n", options.size(), count);
+    printf("%-12s %12s %12s\n", "phase", "total ms", "us/file");
+
+    /*
+     * Compiling the options and running them for each file, as when options
+     * are not compiled once per tool.
+     */
+    size_t arguments = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        arguments += Tool::OptionsResult::Create(environment, workingDirectory, options, fileType, deletedSettings).arguments().size();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12.1f %12.3f\n", "uncompiled", ms, ms * 1000.0 / count);
+
+    /*
+     * Running the compiled options for each file.
+     */
+    Tool::OptionsProgram::shared_ptr program = Tool::OptionsProgram::ForTool(clang);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        arguments += program->run(environment, workingDirectory, fileType).arguments().size();
+    }
+    end = std::chrono::steady_clock::now();
+
+    ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12.1f %12.3f\n", "compiled", ms, ms * 1000.0 / count);
+
+    /* Keep the results from being optimized out. */
+    printf("\n%zu arguments\n", arguments);
+
+    return 0;
+}
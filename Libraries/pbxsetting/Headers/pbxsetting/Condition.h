@@ -24,6 +24,10 @@ public:
     Condition(std::unordered_map<std::string, std::string> const &values);
     ~Condition();
 
+public:
+    bool operator==(Condition const &rhs) const;
+    bool operator!=(Condition const &rhs) const;
+
 public:
     friend struct std::hash<Condition>;
 
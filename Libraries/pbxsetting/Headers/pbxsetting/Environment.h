@@ -13,27 +13,58 @@
 #include <pbxsetting/Condition.h>
 #include <pbxsetting/Level.h>
 
-#include <list>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace pbxsetting {
 
 /*
  * Represents a hierarchical list of build settings (an ordered list of build
  * setting levels). Can use those levels to evaluate build setting values.
+ *
+ * Copies share their levels with the environment they were copied from until
+ * either adds a level, so layering a few levels over a large environment
+ * doesn't copy the levels underneath.
  */
 class Environment {
 private:
-    std::list<Level> _levels;
-    size_t           _offset;
+    struct CacheKey {
+        std::string setting;
+        Condition   condition;
+
+        bool operator==(CacheKey const &rhs) const
+        { return setting == rhs.setting && condition == rhs.condition; }
+    };
+
+    struct CacheKeyHash {
+        size_t operator()(CacheKey const &key) const
+        { return std::hash<std::string>()(key.setting) ^ std::hash<Condition>()(key.condition); }
+    };
+
+    /*
+     * Memoized results of resolving a setting under a condition. Only
+     * valid for the current level stack; cleared when levels change.
+     */
+    struct Cache {
+        bool                                                    enabled;
+        std::unordered_map<CacheKey, std::string, CacheKeyHash> values;
+        size_t                                                  hits;
+        size_t                                                  misses;
+    };
+
+private:
+    std::shared_ptr<std::vector<Level>> _levels;
+    size_t                              _offset;
+    mutable Cache                       _cache;
 
 public:
     explicit Environment();
-    explicit Environment(Environment const &) = default;
+    explicit Environment(Environment const &environment);
     Environment const &operator=(Environment const &) = delete;
-    Environment(Environment &&) = default;
-    Environment &operator=(Environment &&) = default;
+    Environment(Environment &&environment);
+    Environment &operator=(Environment &&environment);
 
 public:
     /*
@@ -75,21 +106,54 @@ public:
      */
     void insertBack(Level const &level, bool isDefault);
 
+public:
+    /*
+     * Enables or disables memoization of resolved settings. When enabled,
+     * each (setting, condition) pair is resolved once until the levels
+     * in the environment change. The cache is not thread-safe: don't
+     * enable it on an environment shared between threads. Copies of the
+     * environment inherit whether caching is enabled, but not its contents.
+     */
+    void setCacheEnabled(bool enabled);
+
+    /*
+     * If resolved settings are being memoized.
+     */
+    bool cacheEnabled() const
+    { return _cache.enabled; }
+
+    /*
+     * Number of resolutions answered from the cache.
+     */
+    size_t cacheHits() const
+    { return _cache.hits; }
+
+    /*
+     * Number of resolutions that had to be computed with caching enabled.
+     */
+    size_t cacheMisses() const
+    { return _cache.misses; }
+
 public:
     /*
      * For debugging: print out the contents of all levels.
      */
     void dump() const;
 
+private:
+    std::vector<Level> &mutableLevels();
+
 private:
     struct InheritanceContext {
         bool valid;
         std::string setting;
-        std::list<Level>::const_iterator it;
+        std::vector<Level>::const_iterator it;
     };
     std::string resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context) const;
+    std::string resolveReference(Condition const &condition, Value::Reference const &reference, InheritanceContext const &context) const;
     std::string resolveInheritance(Condition const &condition, InheritanceContext const &context) const;
     std::string resolveAssignment(Condition const &condition, std::string const &setting) const;
+    std::string resolveAssignmentUncached(Condition const &condition, std::string const &setting) const;
 };
 
 }
@@ -14,6 +14,8 @@
 #include <pbxsetting/Setting.h>
 #include <pbxsetting/Value.h>
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <memory>
@@ -29,6 +31,13 @@ class Level {
 private:
     std::shared_ptr<std::vector<Setting>> _settings;
 
+private:
+    /*
+     * Indexes into the settings for each setting name, in order. Built
+     * once on creation and shared between copies of the level.
+     */
+    std::shared_ptr<std::unordered_map<std::string, std::vector<size_t>>> _index;
+
 public:
     /*
      * Creates a level with the given settings.
@@ -45,10 +54,12 @@ public:
 
 public:
     /*
-     * Fetches a setting from a level. Fails if the setting is not bound
-     * in this level, or is bound but for a condition that doesn't match.
+     * Fetches a setting from a level. Returns `nullptr` if the setting is
+     * not bound in this level, or is bound but for a condition that doesn't
+     * match. If multiple bindings match, the last one wins. The returned
+     * value is owned by the level.
      */
-    std::pair<bool, Value>
+    Value const *
     get(std::string const &setting, Condition const &condition) const;
 };
 
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <ext/optional>
 
@@ -30,6 +31,67 @@ namespace pbxsetting {
  * This class stores, not resolves, build setting value.
  */
 class Value {
+public:
+    /*
+     * A setting reference split into the referenced setting and the
+     * operations to apply to its value, in order. For example:
+     *
+     *     $(PRODUCT_NAME:rfc1034identifier:lower)
+     *
+     * References with a literal name are split once, when parsed.
+     */
+    class Reference {
+    public:
+        enum class Operation {
+            Identifier,
+            C99ExtIdentifier,
+            RFC1034Identifier,
+            Quote,
+            Lower,
+            Upper,
+            StandardizePath,
+            Base,
+            Dir,
+            File,
+            Suffix,
+            Unknown,
+        };
+
+    private:
+        std::string                                     _raw;
+        std::string                                     _setting;
+        std::vector<std::pair<Operation, std::string>> _operations;
+
+    public:
+        Reference(std::string const &raw, std::string const &setting, std::vector<std::pair<Operation, std::string>> const &operations);
+
+    public:
+        /*
+         * The full reference, including operations.
+         */
+        std::string const &raw() const
+        { return _raw; }
+
+        /*
+         * The name of the referenced setting.
+         */
+        std::string const &setting() const
+        { return _setting; }
+
+        /*
+         * The operations to apply, with their original names.
+         */
+        std::vector<std::pair<Operation, std::string>> const &operations() const
+        { return _operations; }
+
+    public:
+        /*
+         * Splits a resolved reference like `SETTING:lower` into parts.
+         */
+        static Reference
+        Parse(std::string const &raw);
+    };
+
 public:
     /*
      * A node in the AST describing the value. Can be a literal
@@ -47,6 +109,7 @@ public:
         Type                       _type;
         ext::optional<std::string> _string;
         std::shared_ptr<Value>     _value;
+        std::shared_ptr<Reference> _reference;
 
     public:
         Entry(std::string const &string);
@@ -63,6 +126,13 @@ public:
         { return _string; }
         std::shared_ptr<Value> const &value() const
         { return _value; }
+
+        /*
+         * For references with a literal name, the pre-split reference.
+         * Null for strings and for references with nested references.
+         */
+        Reference const *reference() const
+        { return _reference.get(); }
     };
 
 private:
@@ -24,6 +24,18 @@ Condition::
 {
 }
 
+bool Condition::
+operator==(Condition const &rhs) const
+{
+    return _values == rhs._values;
+}
+
+bool Condition::
+operator!=(Condition const &rhs) const
+{
+    return !(*this == rhs);
+}
+
 bool Condition::
 match(Condition const &condition) const
 {
@@ -11,6 +11,7 @@
 #include <libutil/FSUtil.h>
 
 #include <algorithm>
+#include <atomic>
 #include <sstream>
 
 using pbxsetting::Environment;
@@ -20,19 +21,70 @@ using pbxsetting::Setting;
 using pbxsetting::Value;
 using libutil::FSUtil;
 
+/*
+ * Levels for environments that were moved from. Shared, so it's never
+ * modified in place: adding a level to one copies it first.
+ */
+static std::shared_ptr<std::vector<Level>> const &
+EmptyLevels()
+{
+    static std::shared_ptr<std::vector<Level>> const levels = std::make_shared<std::vector<Level>>();
+    return levels;
+}
+
 Environment::
 Environment() :
-    _offset(0)
+    _levels(std::make_shared<std::vector<Level>>()),
+    _offset(0),
+    _cache({ .enabled = false, .hits = 0, .misses = 0 })
+{
+}
+
+Environment::
+Environment(Environment const &environment) :
+    _levels(environment._levels),
+    _offset(environment._offset),
+    _cache({ .enabled = environment._cache.enabled, .hits = 0, .misses = 0 })
 {
 }
 
+Environment::
+Environment(Environment &&environment) :
+    _levels(std::move(environment._levels)),
+    _offset(environment._offset),
+    _cache(std::move(environment._cache))
+{
+    /* Leave the moved-from environment empty, but still usable. */
+    environment._levels = EmptyLevels();
+    environment._offset = 0;
+    environment._cache.values.clear();
+}
+
+Environment &Environment::
+operator=(Environment &&environment)
+{
+    if (this != &environment) {
+        _levels = std::move(environment._levels);
+        _offset = environment._offset;
+        _cache = std::move(environment._cache);
+
+        environment._levels = EmptyLevels();
+        environment._offset = 0;
+        environment._cache.values.clear();
+    }
+
+    return *this;
+}
+
 static std::string
-ProcessOperation(std::string const &value, std::string const &operation)
+ProcessOperation(std::string const &value, Value::Reference::Operation operation, std::string const &name)
 {
+    using Operation = Value::Reference::Operation;
+
     const std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
     const std::string digits = "0123456789";
 
-    if (operation == "identifier" || operation == "c99extidentifier") {
+    if (operation == Operation::Identifier || operation == Operation::C99ExtIdentifier) {
         // TODO(grp): Support c99extidentifier correctly. Requires Unicode handling.
 
         const std::string begin = alphabet + "_";
@@ -46,7 +98,7 @@ ProcessOperation(std::string const &value, std::string const &operation)
         }
 
         return result;
-    } else if (operation == "rfc1034identifier") {
+    } else if (operation == Operation::RFC1034Identifier) {
         const std::string begin = alphabet;
         const std::string subsequent = alphabet + digits + "-";
         const std::string end = alphabet + digits;
@@ -77,7 +129,7 @@ ProcessOperation(std::string const &value, std::string const &operation)
         }
 
         return result;
-    } else if (operation == "quote") {
+    } else if (operation == Operation::Quote) {
         // FIXME(grp): This is (probably) valid, but not necessarily compatible. Algorithm from Python's shlex.quote().
         if (value.find_first_not_of(alphabet + digits + "@%_-+=:,./") == std::string::npos) {
             return value;
@@ -90,26 +142,26 @@ ProcessOperation(std::string const &value, std::string const &operation)
             }
             return "'" + result + "'";
         }
-    } else if (operation == "lower") {
+    } else if (operation == Operation::Lower) {
         std::string result = value;
         std::transform(result.begin(), result.end(), result.begin(), ::tolower);
         return result;
-    } else if (operation == "upper") {
+    } else if (operation == Operation::Upper) {
         std::string result = value;
         std::transform(result.begin(), result.end(), result.begin(), ::toupper);
         return result;
-    } else if (operation == "standardizepath") {
+    } else if (operation == Operation::StandardizePath) {
         return FSUtil::NormalizePath(value);
-    } else if (operation == "base") {
+    } else if (operation == Operation::Base) {
         return FSUtil::GetBaseNameWithoutExtension(value);
-    } else if (operation == "dir") {
+    } else if (operation == Operation::Dir) {
         return FSUtil::GetDirectoryName(value);
-    } else if (operation == "file") {
+    } else if (operation == Operation::File) {
         return FSUtil::GetBaseName(value);
-    } else if (operation == "suffix") {
+    } else if (operation == Operation::Suffix) {
         return "." + FSUtil::GetFileExtension(value);
     } else {
-        fprintf(stderr, "warning: unknown build setting operation '%s'\n", operation.c_str());
+        fprintf(stderr, "warning: unknown build setting operation '%s'\n", name.c_str());
         return value;
     }
 }
@@ -125,29 +177,12 @@ resolveValue(Condition const &condition, Value const &value, InheritanceContext
                 break;
             }
             case Value::Entry::Type::Value: {
-                std::string resolved = resolveValue(condition, *entry.value(), context);
-                if (context.valid && (resolved == context.setting || resolved == "inherited")) {
-                    result += resolveInheritance(condition, context);
+                if (Value::Reference const *reference = entry.reference()) {
+                    result += resolveReference(condition, *reference, context);
                 } else {
-                    std::string setting = resolved;
-
-                    std::string::size_type colon = resolved.find(':');
-                    if (colon != std::string::npos) {
-                        setting = resolved.substr(0, colon);
-                    }
-
-                    std::string value = resolveAssignment(condition, setting);
-
-                    while (colon != std::string::npos) {
-                        std::string::size_type next = resolved.find(':', colon + 1);
-
-                        std::string operation = resolved.substr(colon + 1, next == std::string::npos ? next : next - colon - 1);
-                        value = ProcessOperation(value, operation);
-
-                        colon = next;
-                    }
-
-                    result += value;
+                    /* Nested references must be resolved to find the referenced setting. */
+                    std::string resolved = resolveValue(condition, *entry.value(), context);
+                    result += resolveReference(condition, Value::Reference::Parse(resolved), context);
                 }
                 break;
             }
@@ -156,14 +191,27 @@ resolveValue(Condition const &condition, Value const &value, InheritanceContext
     return result;
 }
 
+std::string Environment::
+resolveReference(Condition const &condition, Value::Reference const &reference, InheritanceContext const &context) const
+{
+    if (context.valid && (reference.raw() == context.setting || reference.raw() == "inherited")) {
+        return resolveInheritance(condition, context);
+    }
+
+    std::string value = resolveAssignment(condition, reference.setting());
+    for (auto const &operation : reference.operations()) {
+        value = ProcessOperation(value, operation.first, operation.second);
+    }
+    return value;
+}
+
 std::string Environment::
 resolveInheritance(Condition const &condition, InheritanceContext const &context) const
 {
     InheritanceContext ctx = context;
-    for (++ctx.it; ctx.it != _levels.end(); ++ctx.it) {
-        auto result = ctx.it->get(ctx.setting, condition);
-        if (result.first) {
-            return resolveValue(condition, result.second, ctx);
+    for (++ctx.it; ctx.it != _levels->end(); ++ctx.it) {
+        if (Value const *value = ctx.it->get(ctx.setting, condition)) {
+            return resolveValue(condition, *value, ctx);
         }
     }
 
@@ -172,14 +220,33 @@ resolveInheritance(Condition const &condition, InheritanceContext const &context
 
 std::string Environment::
 resolveAssignment(Condition const &condition, std::string const &setting) const
+{
+    if (!_cache.enabled) {
+        return resolveAssignmentUncached(condition, setting);
+    }
+
+    CacheKey key = { .setting = setting, .condition = condition };
+    auto it = _cache.values.find(key);
+    if (it != _cache.values.end()) {
+        _cache.hits++;
+        return it->second;
+    }
+
+    _cache.misses++;
+    std::string value = resolveAssignmentUncached(condition, setting);
+    _cache.values.insert({ key, value });
+    return value;
+}
+
+std::string Environment::
+resolveAssignmentUncached(Condition const &condition, std::string const &setting) const
 {
     InheritanceContext context = { .valid = true, .setting = setting };
 
-    for (context.it = _levels.begin(); context.it != _levels.end(); ++context.it) {
+    for (context.it = _levels->begin(); context.it != _levels->end(); ++context.it) {
         Level const &level = *context.it;
-        auto result = level.get(setting, condition);
-        if (result.first) {
-            return resolveValue(condition, result.second, context);
+        if (Value const *value = level.get(setting, condition)) {
+            return resolveValue(condition, *value, context);
         }
     }
 
@@ -219,7 +286,7 @@ computeValues(Condition const &condition) const
 {
     std::unordered_map<std::string, std::string> values;
 
-    for (Level const &level : _levels) {
+    for (Level const &level : *_levels) {
         for (Setting const &setting : level.settings()) {
             if (values.find(setting.name()) == values.end()) {
                 values[setting.name()] = resolve(setting.name(), condition);
@@ -230,25 +297,63 @@ computeValues(Condition const &condition) const
     return values;
 }
 
+std::vector<Level> &Environment::
+mutableLevels()
+{
+    if (_levels.use_count() == 1) {
+        /* Pairs with the release when the last other owner went away. */
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return *_levels;
+    }
+
+    /*
+     * Shared with a copy of this environment: copy before modifying. The
+     * levels themselves share their settings, so this only copies handles.
+     * Leave room for the few levels usually added on top of a copy.
+     */
+    auto levels = std::make_shared<std::vector<Level>>();
+    levels->reserve(_levels->size() + 8);
+    levels->insert(levels->end(), _levels->begin(), _levels->end());
+    _levels = levels;
+    return *_levels;
+}
+
 void Environment::
 insertFront(Level const &level, bool isDefault)
 {
+    /* Any resolved value could depend on the new level. */
+    _cache.values.clear();
+
+    std::vector<Level> &levels = mutableLevels();
     if (!isDefault) {
-        _levels.push_front(level);
+        levels.insert(levels.begin(), level);
         ++_offset;
     } else {
-        _levels.insert(std::next(_levels.begin(), _offset), level);
+        levels.insert(std::next(levels.begin(), _offset), level);
     }
 }
 
 void Environment::
 insertBack(Level const &level, bool isDefault)
 {
+    /* Any resolved value could depend on the new level. */
+    _cache.values.clear();
+
+    std::vector<Level> &levels = mutableLevels();
     if (!isDefault) {
-        _levels.insert(std::next(_levels.begin(), _offset), level);
+        levels.insert(std::next(levels.begin(), _offset), level);
         ++_offset;
     } else {
-        _levels.push_back(level);
+        levels.push_back(level);
+    }
+}
+
+void Environment::
+setCacheEnabled(bool enabled)
+{
+    _cache.enabled = enabled;
+    if (!enabled) {
+        _cache.values.clear();
     }
 }
 
@@ -257,7 +362,7 @@ dump() const
 {
     size_t offset = 0;
 
-    for (Level const &level : _levels) {
+    for (Level const &level : *_levels) {
         if (offset == _offset) {
             printf("=== Default Levels ===\n");
         } else if (offset == 0) {
@@ -272,5 +377,10 @@ dump() const
 
         ++offset;
     }
+
+    if (_cache.enabled) {
+        printf("=== Cache ===\n");
+        printf("    %zu hits, %zu misses\n", _cache.hits, _cache.misses);
+    }
 }
 
@@ -16,8 +16,12 @@ using pbxsetting::Value;
 
 Level::
 Level(std::vector<Setting> const &settings) :
-    _settings(std::make_shared<std::vector<Setting>>(settings))
+    _settings(std::make_shared<std::vector<Setting>>(settings)),
+    _index   (std::make_shared<std::unordered_map<std::string, std::vector<size_t>>>())
 {
+    for (size_t i = 0; i < _settings->size(); ++i) {
+        (*_index)[_settings->at(i).name()].push_back(i);
+    }
 }
 
 Level::
@@ -25,15 +29,22 @@ Level::
 {
 }
 
-std::pair<bool, Value> Level::
+Value const *Level::
 get(std::string const &setting, Condition const &condition) const
 {
-    for (auto it = _settings->rbegin(); it != _settings->rend(); ++it) {
-        if (it->match(setting, condition)) {
-            return std::make_pair(true, it->value());
+    auto it = _index->find(setting);
+    if (it == _index->end()) {
+        return nullptr;
+    }
+
+    /* Later settings override earlier ones. */
+    for (auto index = it->second.rbegin(); index != it->second.rend(); ++index) {
+        Setting const &candidate = (*_settings)[*index];
+        if (candidate.condition().match(condition)) {
+            return &candidate.value();
         }
     }
 
-    return std::make_pair(false, Value::Empty());
+    return nullptr;
 }
 
@@ -31,6 +31,10 @@ Entry(std::shared_ptr<Value> const &value) :
     _type (Type::Value),
     _value(value)
 {
+    /* Split literal references now, rather than on every resolution. */
+    if (_value->entries().size() == 1 && _value->entries().front().type() == Type::String) {
+        _reference = std::make_shared<Reference>(Reference::Parse(*_value->entries().front().string()));
+    }
 }
 
 bool Value::Entry::
@@ -54,6 +58,65 @@ operator!=(Entry const &entry) const
     return !(*this == entry);
 }
 
+Value::Reference::
+Reference(std::string const &raw, std::string const &setting, std::vector<std::pair<Operation, std::string>> const &operations) :
+    _raw       (raw),
+    _setting   (setting),
+    _operations(operations)
+{
+}
+
+static Value::Reference::Operation
+ParseOperation(std::string const &operation)
+{
+    using Operation = Value::Reference::Operation;
+
+    if (operation == "identifier") {
+        return Operation::Identifier;
+    } else if (operation == "c99extidentifier") {
+        return Operation::C99ExtIdentifier;
+    } else if (operation == "rfc1034identifier") {
+        return Operation::RFC1034Identifier;
+    } else if (operation == "quote") {
+        return Operation::Quote;
+    } else if (operation == "lower") {
+        return Operation::Lower;
+    } else if (operation == "upper") {
+        return Operation::Upper;
+    } else if (operation == "standardizepath") {
+        return Operation::StandardizePath;
+    } else if (operation == "base") {
+        return Operation::Base;
+    } else if (operation == "dir") {
+        return Operation::Dir;
+    } else if (operation == "file") {
+        return Operation::File;
+    } else if (operation == "suffix") {
+        return Operation::Suffix;
+    } else {
+        return Operation::Unknown;
+    }
+}
+
+Value::Reference Value::Reference::
+Parse(std::string const &raw)
+{
+    std::string::size_type colon = raw.find(':');
+    std::string setting = raw.substr(0, colon);
+
+    std::vector<std::pair<Operation, std::string>> operations;
+    while (colon != std::string::npos) {
+        std::string::size_type next = raw.find(':', colon + 1);
+
+        std::string operation = raw.substr(colon + 1, next == std::string::npos ? next : next - colon - 1);
+        operations.push_back({ ParseOperation(operation), operation });
+
+        colon = next;
+    }
+
+    return Reference(raw, setting, operations);
+}
+
 Value::
 Value(std::vector<Entry> const &entries) :
     _entries(entries)
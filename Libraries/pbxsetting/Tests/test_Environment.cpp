@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include <pbxsetting/Environment.h>
 
+using pbxsetting::Condition;
 using pbxsetting::Environment;
 using pbxsetting::Level;
 using pbxsetting::Setting;
@@ -172,3 +173,111 @@ TEST(Environment, Default)
     EXPECT_EQ(env.resolve("THREE"), "3");
 }
 
+TEST(Environment, Copy)
+{
+    Environment base;
+    base.insertBack(Level({
+        Setting::Parse("ONE", "one"),
+        Setting::Parse("TWO", "$(ONE) two"),
+    }), false);
+    base.insertBack(Level({
+        Setting::Parse("THREE", "three"),
+    }), true);
+
+    /* Copies share levels, but adding to either doesn't affect the other. */
+    Environment copy = Environment(base);
+    copy.insertFront(Level({
+        Setting::Parse("ONE", "1"),
+    }), false);
+    copy.insertFront(Level({
+        Setting::Parse("THREE", "3, $(inherited)"),
+    }), true);
+    EXPECT_EQ(copy.resolve("TWO"), "1 two");
+    EXPECT_EQ(copy.resolve("THREE"), "3, three");
+    EXPECT_EQ(base.resolve("TWO"), "one two");
+    EXPECT_EQ(base.resolve("THREE"), "three");
+
+    base.insertFront(Level({
+        Setting::Parse("TWO", "2"),
+    }), false);
+    EXPECT_EQ(base.resolve("TWO"), "2");
+    EXPECT_EQ(copy.resolve("TWO"), "1 two");
+}
+
+TEST(Environment, Move)
+{
+    Environment base;
+    base.insertBack(Level({
+        Setting::Parse("ONE", "one"),
+    }), false);
+
+    /* A moved-from environment is empty, but can still be used. */
+    Environment moved = Environment(std::move(base));
+    EXPECT_EQ(moved.resolve("ONE"), "one");
+    EXPECT_EQ(base.resolve("ONE"), "");
+    EXPECT_TRUE(base.computeValues(Condition::Empty()).empty());
+
+    base.insertFront(Level({
+        Setting::Parse("ONE", "1"),
+    }), false);
+    EXPECT_EQ(base.resolve("ONE"), "1");
+
+    Environment assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.resolve("ONE"), "one");
+    EXPECT_EQ(moved.resolve("ONE"), "");
+
+    /* Other moved-from environments are unaffected by adding to one. */
+    EXPECT_EQ(Environment(std::move(assigned)).resolve("ONE"), "one");
+    EXPECT_EQ(assigned.resolve("ONE"), "");
+}
+
+TEST(Environment, Cache)
+{
+    Environment env;
+    env.setCacheEnabled(true);
+    env.insertBack(Level({
+        Setting::Parse("ONE", "one"),
+        Setting::Parse("TWO", "$(ONE) two"),
+    }), false);
+    EXPECT_EQ(env.resolve("TWO"), "one two");
+    EXPECT_EQ(env.cacheHits(), 0);
+    EXPECT_EQ(env.cacheMisses(), 2);
+
+    EXPECT_EQ(env.resolve("TWO"), "one two");
+    EXPECT_EQ(env.resolve("ONE"), "one");
+    EXPECT_EQ(env.cacheHits(), 2);
+    EXPECT_EQ(env.cacheMisses(), 2);
+
+    /* Changing the levels invalidates cached values. */
+    env.insertFront(Level({
+        Setting::Parse("ONE", "1"),
+    }), false);
+    EXPECT_EQ(env.resolve("TWO"), "1 two");
+    EXPECT_EQ(env.cacheMisses(), 4);
+
+    /* Copies start with an empty cache. */
+    Environment copy = Environment(env);
+    EXPECT_TRUE(copy.cacheEnabled());
+    EXPECT_EQ(copy.resolve("TWO"), "1 two");
+    EXPECT_EQ(copy.cacheHits(), 0);
+    EXPECT_EQ(copy.cacheMisses(), 2);
+}
+
+TEST(Environment, CacheCondition)
+{
+    pbxsetting::Condition x86_64 = pbxsetting::Condition(std::unordered_map<std::string, std::string>({ { "arch", "x86_64" } }));
+    pbxsetting::Condition arm64 = pbxsetting::Condition(std::unordered_map<std::string, std::string>({ { "arch", "arm64" } }));
+
+    Environment env;
+    env.setCacheEnabled(true);
+    env.insertBack(Level({
+        Setting::Parse("ARCH_FLAG", "none"),
+        Setting("ARCH_FLAG", x86_64, Value::String("x86")),
+    }), false);
+    EXPECT_EQ(env.resolve("ARCH_FLAG", x86_64), "x86");
+    EXPECT_EQ(env.resolve("ARCH_FLAG", arm64), "none");
+    EXPECT_EQ(env.resolve("ARCH_FLAG"), "none");
+    EXPECT_EQ(env.cacheHits(), 0);
+    EXPECT_EQ(env.cacheMisses(), 3);
+}
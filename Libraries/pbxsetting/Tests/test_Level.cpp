@@ -0,0 +1,60 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxsetting/Level.h>
+
+using pbxsetting::Condition;
+using pbxsetting::Level;
+using pbxsetting::Setting;
+using pbxsetting::Value;
+
+TEST(Level, Get)
+{
+    Level level = Level({
+        Setting::Parse("ONE", "one"),
+        Setting::Parse("TWO", "two"),
+    });
+
+    Value const *one = level.get("ONE", Condition::Empty());
+    ASSERT_NE(one, nullptr);
+    EXPECT_EQ(*one, Value::String("one"));
+
+    EXPECT_EQ(level.get("THREE", Condition::Empty()), nullptr);
+}
+
+TEST(Level, LastMatchWins)
+{
+    Condition x86_64 = Condition(std::unordered_map<std::string, std::string>({ { "arch", "x86_64" } }));
+    Condition arm64 = Condition(std::unordered_map<std::string, std::string>({ { "arch", "arm64" } }));
+
+    Level level = Level({
+        Setting("FLAG", x86_64, Value::String("x86")),
+        Setting::Parse("FLAG", "first"),
+        Setting::Parse("OTHER", "other"),
+        Setting::Parse("FLAG", "second"),
+        Setting("FLAG", arm64, Value::String("arm")),
+    });
+
+    EXPECT_EQ(*level.get("FLAG", Condition::Empty()), Value::String("second"));
+    EXPECT_EQ(*level.get("FLAG", x86_64), Value::String("second"));
+    EXPECT_EQ(*level.get("FLAG", arm64), Value::String("arm"));
+}
+
+TEST(Level, ConditionMismatch)
+{
+    Condition x86_64 = Condition(std::unordered_map<std::string, std::string>({ { "arch", "x86_64" } }));
+
+    Level level = Level({
+        Setting("FLAG", x86_64, Value::String("x86")),
+    });
+
+    EXPECT_EQ(level.get("FLAG", Condition::Empty()), nullptr);
+    EXPECT_EQ(*level.get("FLAG", x86_64), Value::String("x86"));
+}
@@ -209,3 +209,26 @@ TEST(Value, Add)
     ASSERT_EQ(string_string.entries().at(0).type(), Value::Entry::Type::String);
     EXPECT_EQ(*string_string.entries().at(0).string(), "teststring");
 }
+
+TEST(Value, Reference)
+{
+    Value literal = Value::Parse("$(PRODUCT_NAME:rfc1034identifier:lower)");
+    ASSERT_EQ(literal.entries().size(), 1);
+    Value::Reference const *reference = literal.entries().at(0).reference();
+    ASSERT_NE(reference, nullptr);
+    EXPECT_EQ(reference->raw(), "PRODUCT_NAME:rfc1034identifier:lower");
+    EXPECT_EQ(reference->setting(), "PRODUCT_NAME");
+    ASSERT_EQ(reference->operations().size(), 2);
+    EXPECT_EQ(reference->operations().at(0).first, Value::Reference::Operation::RFC1034Identifier);
+    EXPECT_EQ(reference->operations().at(1).first, Value::Reference::Operation::Lower);
+
+    Value nested = Value::Parse("$(VERSION_$(SUFFIX))");
+    ASSERT_EQ(nested.entries().size(), 1);
+    EXPECT_EQ(nested.entries().at(0).reference(), nullptr);
+
+    Value::Reference unknown = Value::Reference::Parse("SETTING:unknown");
+    EXPECT_EQ(unknown.setting(), "SETTING");
+    ASSERT_EQ(unknown.operations().size(), 1);
+    EXPECT_EQ(unknown.operations().at(0).first, Value::Reference::Operation::Unknown);
+    EXPECT_EQ(unknown.operations().at(0).second, "unknown");
+}
@@ -0,0 +1,121 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxsetting/Environment.h>
+#include <pbxsetting/Level.h>
+#include <pbxsetting/Setting.h>
+#include <pbxsetting/Value.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+using libutil::DefaultFilesystem;
+
+/*
+ * Reads the settings from a dump in the format printed by -showBuildSettings:
+ * one "NAME = VALUE" per line, with any other lines ignored.
+ */
+static std::vector<std::pair<std::string, std::string>>
+ReadSettings(std::string const &contents)
+{
+    std::vector<std::pair<std::string, std::string>> settings;
+
+    size_t start = 0;
+    while (start < contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos) {
+            end = contents.size();
+        }
+        std::string line = contents.substr(start, end - start);
+        start = end + 1;
+
+        size_t equals = line.find(" = ");
+        if (equals == std::string::npos) {
+            continue;
+        }
+
+        size_t name = line.find_first_not_of(" \t");
+        if (name >= equals) {
+            continue;
+        }
+
+        settings.push_back({ line.substr(name, equals - name), line.substr(equals + 3) });
+    }
+
+    return settings;
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "usage: %s <settings.txt> [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    int iterations = (argc == 3 ? std::max(1, atoi(argv[2])) : 100);
+
+    DefaultFilesystem filesystem = DefaultFilesystem();
+    std::vector<uint8_t> contents;
+    if (!filesystem.read(&contents, argv[1])) {
+        fprintf(stderr, "error: unable to read %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::string>> settings = ReadSettings(std::string(contents.begin(), contents.end()));
+    printf("%zu settings, %d iterations\n\n", settings.size(), iterations);
+    printf("%-12s %12s %12s\n", "phase", "total ms", "us/setting");
+
+    /*
+     * Parse every value, as loading specifications and project files does.
+     */
+    std::vector<pbxsetting::Setting> parsed;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        parsed.clear();
+        for (auto const &setting : settings) {
+            parsed.push_back(pbxsetting::Setting::Create(setting.first, pbxsetting::Value::Parse(setting.second)));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12.1f %12.3f\n", "parse", ms, settings.empty() ? 0.0 : ms * 1000.0 / (iterations * settings.size()));
+
+    /*
+     * Resolve every setting in a fresh environment each time, so nothing
+     * resolved in a previous iteration is reused.
+     */
+    pbxsetting::Level level = pbxsetting::Level(parsed);
+    size_t length = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        pbxsetting::Environment environment = pbxsetting::Environment();
+        environment.insertFront(level, false);
+
+        for (auto const &setting : settings) {
+            length += environment.resolve(setting.first).size();
+        }
+    }
+    end = std::chrono::steady_clock::now();
+
+    ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12.1f %12.3f\n", "resolve", ms, settings.empty() ? 0.0 : ms * 1000.0 / (iterations * settings.size()));
+
+    /* Keep the resolution from being optimized out. */
+    printf("\n%zu bytes resolved\n", length);
+
+    return 0;
+}
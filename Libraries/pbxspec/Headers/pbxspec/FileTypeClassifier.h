@@ -0,0 +1,81 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxspec_FileTypeClassifier_h
+#define __pbxspec_FileTypeClassifier_h
+
+#include <pbxspec/PBX/FileType.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libutil { class Filesystem; }
+
+namespace pbxspec {
+
+/*
+ * Classifies file paths into file types. Built once from a set of file types,
+ * most specific types first, and indexed so that classifying a path only has
+ * to check the file types that could possibly match it.
+ */
+class FileTypeClassifier {
+public:
+    typedef std::shared_ptr<FileTypeClassifier> shared_ptr;
+
+private:
+    /*
+     * A node in a trie of file name prefixes. Children are indexes into the
+     * list of nodes, types are indexes into the sorted file types.
+     */
+    struct Node {
+        std::unordered_map<char, size_t> children;
+        std::vector<size_t>              types;
+    };
+
+private:
+    PBX::FileType::vector                                _fileTypes;
+    std::unordered_map<std::string, std::vector<size_t>> _extensions;
+    std::vector<Node>                                    _prefixes;
+    std::vector<size_t>                                  _readable;
+
+public:
+    FileTypeClassifier(PBX::FileType::vector const &fileTypes);
+
+public:
+    /*
+     * The file types considered, in the order they are checked.
+     */
+    inline PBX::FileType::vector const &fileTypes() const
+    { return _fileTypes; }
+
+public:
+    /*
+     * Find the first file type matching a path. Returns null if no file
+     * type matches; callers should fall back to a generic type.
+     */
+    PBX::FileType::shared_ptr
+    classify(libutil::Filesystem const *filesystem, std::string const &filePath) const;
+
+private:
+    void insertPrefix(std::string const &prefix, size_t index);
+
+public:
+    /*
+     * Create a classifier from file types, ordering types before the types
+     * they are based on. Returns null if the file types' bases form a cycle.
+     */
+    static FileTypeClassifier::shared_ptr
+    Create(PBX::FileType::vector const &fileTypes);
+};
+
+}
+
+#endif  // !__pbxspec_FileTypeClassifier_h
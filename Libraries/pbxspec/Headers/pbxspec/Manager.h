@@ -23,9 +23,11 @@
 #include <pbxspec/PBX/ProductType.h>
 #include <pbxspec/PBX/Specification.h>
 #include <pbxspec/PBX/Tool.h>
+#include <pbxspec/FileTypeClassifier.h>
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -44,6 +46,10 @@ private:
     std::map<std::string, std::map<char const *, PBX::Specification::vector>> _specifications;
     PBX::BuildRule::vector                                                    _buildRules;
 
+private:
+    mutable std::mutex                                                        _fileTypeClassifiersMutex;
+    mutable std::map<std::vector<std::string>, FileTypeClassifier::shared_ptr> _fileTypeClassifiers;
+
 public:
     Manager();
     ~Manager();
@@ -96,6 +102,13 @@ public:
     PBX::FileType::vector
     fileTypes(std::vector<std::string> const &domains) const;
 
+    /*
+     * Classifier for the file types in the domains. Built on first use and
+     * shared afterwards; null if the file types can't be ordered.
+     */
+    FileTypeClassifier::shared_ptr
+    fileTypeClassifier(std::vector<std::string> const &domains) const;
+
 public:
     PBX::Linker::shared_ptr
     linker(std::string const &identifier, std::vector<std::string> const &domains) const;
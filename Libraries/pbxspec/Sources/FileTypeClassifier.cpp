@@ -0,0 +1,363 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxspec/FileTypeClassifier.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Wildcard.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <list>
+#include <unordered_set>
+#include <strings.h>
+
+using pbxspec::FileTypeClassifier;
+using pbxspec::PBX::FileType;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::Wildcard;
+
+static std::string
+LowercaseExtension(std::string const &extension)
+{
+    std::string result = extension;
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) -> char {
+        return static_cast<char>(::tolower(c));
+    });
+    return result;
+}
+
+static std::string
+PatternLiteralPrefix(std::string const &pattern)
+{
+    /* Everything before the first wildcard must match the file name exactly. */
+    return pattern.substr(0, pattern.find_first_of("*["));
+}
+
+FileTypeClassifier::
+FileTypeClassifier(FileType::vector const &fileTypes) :
+    _fileTypes(fileTypes),
+    _prefixes(1)
+{
+    for (size_t index = 0; index < _fileTypes.size(); ++index) {
+        FileType::shared_ptr const &fileType = _fileTypes[index];
+
+        /*
+         * A file type must match all of its checks, so it only needs to be
+         * indexed by one of them. Prefer the most selective one available.
+         */
+        if (fileType->extensions()) {
+            std::unordered_set<std::string> inserted;
+            for (std::string const &extension : *fileType->extensions()) {
+                std::string key = LowercaseExtension(extension);
+                if (inserted.insert(key).second) {
+                    _extensions[key].push_back(index);
+                }
+            }
+        } else if (fileType->prefix()) {
+            for (std::string const &prefix : *fileType->prefix()) {
+                insertPrefix(prefix, index);
+            }
+        } else if (fileType->filenamePatterns()) {
+            for (std::string const &pattern : *fileType->filenamePatterns()) {
+                insertPrefix(PatternLiteralPrefix(pattern), index);
+            }
+        } else if (fileType->permissions() || fileType->magicWords()) {
+            /* These checks only apply to files that exist. */
+            _readable.push_back(index);
+        }
+
+        /* File types without any checks never match. */
+    }
+}
+
+void FileTypeClassifier::
+insertPrefix(std::string const &prefix, size_t index)
+{
+    size_t node = 0;
+    for (char c : prefix) {
+        auto it = _prefixes[node].children.find(c);
+        if (it != _prefixes[node].children.end()) {
+            node = it->second;
+        } else {
+            size_t child = _prefixes.size();
+            _prefixes[node].children.insert({ c, child });
+            _prefixes.emplace_back();
+            node = child;
+        }
+    }
+
+    std::vector<size_t> &types = _prefixes[node].types;
+    if (types.empty() || types.back() != index) {
+        types.push_back(index);
+    }
+}
+
+static bool
+MatchFileType(
+    Filesystem const *filesystem,
+    FileType::shared_ptr const &fileType,
+    std::string const &filePath,
+    std::string const &fileName,
+    std::string const &fileExtension,
+    bool isReadable,
+    bool isFolder,
+    std::vector<uint8_t> *fileContents)
+{
+    if (isReadable && fileType->isFolder() != isFolder) {
+        return false;
+    }
+
+    bool empty = true;
+
+    if (fileType->extensions()) {
+        empty = false;
+        bool matched = false;
+
+        for (std::string const &extension : *fileType->extensions()) {
+            // TODO(grp): Is this correct? Needed for handling ".S" as ".s", but might be over-broad.
+            if (strcasecmp(extension.c_str(), fileExtension.c_str()) == 0) {
+                matched = true;
+            }
+        }
+
+        if (!matched) {
+            return false;
+        }
+    }
+
+    if (fileType->prefix()) {
+        empty = false;
+        bool matched = false;
+
+        for (std::string const &prefix : *fileType->prefix()) {
+            if (fileName.find(prefix) == 0) {
+                matched = true;
+            }
+        }
+
+        if (!matched) {
+            return false;
+        }
+    }
+
+    if (fileType->filenamePatterns()) {
+        empty = false;
+        bool matched = false;
+
+        for (std::string const &pattern : *fileType->filenamePatterns()) {
+            if (Wildcard::Match(pattern, fileName)) {
+                matched = true;
+            }
+        }
+
+        if (!matched) {
+            return false;
+        }
+    }
+
+    if (isReadable && fileType->permissions()) {
+        empty = false;
+        bool matched = false;
+
+        std::string const &permissions = *fileType->permissions();
+        if (permissions == "read") {
+            matched = isReadable;
+        } else if (permissions == "write") {
+            matched = filesystem->isWritable(filePath);
+        } else if (permissions == "executable") {
+            matched = filesystem->isExecutable(filePath);
+        } else {
+            fprintf(stderr, "warning: unhandled permission %s\n", permissions.c_str());
+        }
+
+        if (!matched) {
+            return false;
+        }
+    }
+
+    // TODO(grp): Support TypeCodes. Not very important.
+
+    if (isReadable && fileType->magicWords()) {
+        empty = false;
+        bool matched = false;
+
+        /* Contents are read lazily and shared between candidates. */
+        for (std::vector<uint8_t> const &magicWord : *fileType->magicWords()) {
+            if (fileContents->size() < magicWord.size()) {
+                std::vector<uint8_t> next;
+                if (!filesystem->read(&next, fileName, fileContents->size(), magicWord.size() - fileContents->size())) {
+                    continue;
+                }
+
+                fileContents->insert(fileContents->end(), next.begin(), next.end());
+            }
+
+            assert(fileContents->size() == magicWord.size());
+            if (std::equal(magicWord.begin(), magicWord.end(), fileContents->begin())) {
+                matched = true;
+            }
+        }
+
+        if (!matched) {
+            return false;
+        }
+    }
+
+    /*
+     * Matched no checks.
+     */
+    if (empty) {
+        return false;
+    }
+
+    /*
+     * Matched all checks.
+     */
+    return true;
+}
+
+FileType::shared_ptr FileTypeClassifier::
+classify(Filesystem const *filesystem, std::string const &filePath) const
+{
+    bool isReadable = filesystem->isReadable(filePath);
+    bool isFolder = isReadable && filesystem->isDirectory(filePath);
+
+    std::string fileExtension = FSUtil::GetFileExtension(filePath);
+    std::string fileName = FSUtil::GetBaseName(filePath);
+
+    /*
+     * Collect the file types that could match this path.
+     */
+    std::vector<size_t> candidates;
+
+    auto it = _extensions.find(LowercaseExtension(fileExtension));
+    if (it != _extensions.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+
+    size_t node = 0;
+    candidates.insert(candidates.end(), _prefixes[node].types.begin(), _prefixes[node].types.end());
+    for (char c : fileName) {
+        auto child = _prefixes[node].children.find(c);
+        if (child == _prefixes[node].children.end()) {
+            break;
+        }
+
+        node = child->second;
+        candidates.insert(candidates.end(), _prefixes[node].types.begin(), _prefixes[node].types.end());
+    }
+
+    if (isReadable) {
+        candidates.insert(candidates.end(), _readable.begin(), _readable.end());
+    }
+
+    /*
+     * Check candidates in the same order as the sorted file types, so the
+     * first match is the same as checking every file type would find.
+     */
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<uint8_t> fileContents;
+    for (size_t index : candidates) {
+        FileType::shared_ptr const &fileType = _fileTypes[index];
+        if (MatchFileType(filesystem, fileType, filePath, fileName, fileExtension, isReadable, isFolder, &fileContents)) {
+            return fileType;
+        }
+    }
+
+    return nullptr;
+}
+
+static ext::optional<FileType::vector>
+SortedFileTypes(FileType::vector const &fileTypes)
+{
+    /*
+     * Topologically sort so file types come before the types they are based
+     * on. This follows the same graph construction and traversal as used in
+     * pbxbuild::DirectedGraph, so the resulting order is the same.
+     */
+    std::unordered_map<FileType::shared_ptr, std::unordered_set<FileType::shared_ptr>> adjacency;
+
+    auto insert = [&adjacency](FileType::shared_ptr const &node, std::unordered_set<FileType::shared_ptr> const &adjacent) {
+        auto it = adjacency.find(node);
+        if (it == adjacency.end()) {
+            adjacency.insert(std::make_pair(node, adjacent));
+        } else {
+            it->second.insert(adjacent.begin(), adjacent.end());
+        }
+    };
+
+    for (FileType::shared_ptr const &fileType : fileTypes) {
+        if (fileType->base() != nullptr) {
+            insert(fileType->base(), { fileType });
+        }
+        const std::unordered_set<FileType::shared_ptr> emptySet;
+        insert(fileType, emptySet);
+    }
+
+    FileType::vector result;
+
+    std::list<FileType::shared_ptr> toExplore;
+    std::transform(adjacency.begin(), adjacency.end(), std::back_inserter(toExplore), [](std::pair<FileType::shared_ptr const, std::unordered_set<FileType::shared_ptr>> const &pair) {
+        return pair.first;
+    });
+
+    std::unordered_set<FileType::shared_ptr> inProgress;
+    std::unordered_set<FileType::shared_ptr> explored;
+
+    while (!toExplore.empty()) {
+        FileType::shared_ptr node = toExplore.front();
+        if (explored.find(node) != explored.end()) {
+            toExplore.pop_front();
+            continue;
+        }
+
+        size_t stack = toExplore.size();
+        inProgress.insert(node);
+
+        auto it = adjacency.find(node);
+        if (it != adjacency.end()) {
+            for (FileType::shared_ptr const &child : it->second) {
+                if (inProgress.find(child) != inProgress.end()) {
+                    return ext::nullopt;
+                }
+
+                if (explored.find(child) == explored.end()) {
+                    toExplore.push_front(child);
+                    break;
+                }
+            }
+        }
+
+        if (stack == toExplore.size()) {
+            toExplore.pop_front();
+            inProgress.erase(node);
+            explored.insert(node);
+            result.push_back(node);
+        }
+    }
+
+    assert(inProgress.empty());
+    return result;
+}
+
+FileTypeClassifier::shared_ptr FileTypeClassifier::
+Create(FileType::vector const &fileTypes)
+{
+    ext::optional<FileType::vector> sorted = SortedFileTypes(fileTypes);
+    if (!sorted) {
+        return nullptr;
+    }
+
+    return std::make_shared<FileTypeClassifier>(*sorted);
+}
@@ -18,6 +18,7 @@
 
 using pbxspec::Manager;
 using pbxspec::Context;
+using pbxspec::FileTypeClassifier;
 using pbxspec::PBX::Specification;
 using pbxspec::PBX::Architecture;
 using pbxspec::PBX::BuildPhase;
@@ -193,6 +194,21 @@ fileTypes(std::vector<std::string> const &domains) const
     return findSpecifications <FileType> (domains);
 }
 
+FileTypeClassifier::shared_ptr Manager::
+fileTypeClassifier(std::vector<std::string> const &domains) const
+{
+    std::lock_guard<std::mutex> lock(_fileTypeClassifiersMutex);
+
+    auto it = _fileTypeClassifiers.find(domains);
+    if (it != _fileTypeClassifiers.end()) {
+        return it->second;
+    }
+
+    FileTypeClassifier::shared_ptr classifier = FileTypeClassifier::Create(fileTypes(domains));
+    _fileTypeClassifiers.insert({ domains, classifier });
+    return classifier;
+}
+
 Linker::shared_ptr Manager::
 linker(std::string const &identifier, std::vector<std::string> const &domains) const
 {
@@ -424,17 +440,23 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
             continue;
         }
     }
+
+    /*
+     * New file types may be in domains used by existing classifiers.
+     */
+    std::lock_guard<std::mutex> lock(_fileTypeClassifiersMutex);
+    _fileTypeClassifiers.clear();
 }
 
 bool Manager::
 registerBuildRules(Filesystem const *filesystem, std::string const &path)
 {
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, path)) {
+    std::unique_ptr<libutil::FileContents> contents = filesystem->map(path);
+    if (contents == nullptr) {
         return false;
     }
 
-    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents->data(), contents->size()).first;
     if (plist == nullptr) {
         return false;
     }
@@ -203,8 +203,8 @@ Open(Filesystem const *filesystem, Context *context, std::string const &filename
         return ext::nullopt;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    std::unique_ptr<libutil::FileContents> contents = filesystem->map(realPath);
+    if (contents == nullptr) {
         fprintf(stderr, "error: unable to read specification plist\n");
         return ext::nullopt;
     }
@@ -212,7 +212,7 @@ Open(Filesystem const *filesystem, Context *context, std::string const &filename
     //
     // Parse property list
     //
-    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents->data(), contents->size()).first;
     if (plist == nullptr) {
         fprintf(stderr, "error: unable to parse specification plist\n");
         return ext::nullopt;
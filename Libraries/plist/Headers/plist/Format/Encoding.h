@@ -12,6 +12,7 @@
 
 #include <plist/Base.h>
 
+#include <utility>
 #include <vector>
 
 namespace plist {
@@ -32,11 +33,26 @@ private:
 
 public:
     static Encoding
-    Detect(std::vector<uint8_t> const &contents);
+    Detect(uint8_t const *data, size_t size);
+    static Encoding
+    Detect(std::vector<uint8_t> const &contents)
+    { return Detect(contents.data(), contents.size()); }
 
 public:
     static std::vector<uint8_t>
-    Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to);
+    Convert(uint8_t const *data, size_t size, Encoding from, Encoding to);
+    static std::vector<uint8_t>
+    Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
+    { return Convert(contents.data(), contents.size(), from, to); }
+
+public:
+    /*
+     * Prepare contents for parsing as UTF-8. Contents already in UTF-8 are
+     * used in place, without any BOM; others are converted into `buffer`.
+     * Returns the start and length of the UTF-8 contents.
+     */
+    static std::pair<uint8_t const *, size_t>
+    ToUTF8(uint8_t const *data, size_t size, Encoding from, std::vector<uint8_t> *buffer);
 
 public:
     static std::vector<uint8_t>
@@ -25,22 +25,47 @@ protected:
     ~Format() { };
 
 public:
+    /*
+     * Determine if the contents are in this format.
+     */
     static std::unique_ptr<T>
-    Identify(std::vector<uint8_t> const &contents);
+    Identify(uint8_t const *data, size_t size);
+
+    static std::unique_ptr<T>
+    Identify(std::vector<uint8_t> const &contents)
+    {
+        return Identify(contents.data(), contents.size());
+    }
 
 public:
+    /*
+     * Parse the contents in this format. The contents are only read from
+     * during the call, so they can be directly mapped from a file.
+     */
     static std::pair<std::unique_ptr<Object>, std::string>
-    Deserialize(std::vector<uint8_t> const &contents, T const &format);
+    Deserialize(uint8_t const *data, size_t size, T const &format);
 
     static std::pair<std::unique_ptr<Object>, std::string>
-    Deserialize(std::vector<uint8_t> const &contents)
+    Deserialize(uint8_t const *data, size_t size)
     {
-        std::unique_ptr<T> format = Identify(contents);
+        std::unique_ptr<T> format = Identify(data, size);
         if (format == nullptr) {
             return std::make_pair(nullptr, "couldn't identify format");
         }
 
-        return Deserialize(contents, *format);
+        return Deserialize(data, size, *format);
+    }
+
+    static std::pair<std::unique_ptr<Object>, std::string>
+    Deserialize(std::vector<uint8_t> const &contents, T const &format)
+    {
+        return Deserialize(contents.data(), contents.size(), format);
+    }
+
+    static std::pair<std::unique_ptr<Object>, std::string>
+    Deserialize(std::vector<uint8_t> const &contents)
+    {
+        return Deserialize(contents.data(), contents.size());
     }
 
 public:
@@ -41,7 +41,7 @@ public:
     XMLParser();
 
 public:
-    Object *parse(std::vector<uint8_t> const &contents);
+    Object *parse(uint8_t const *data, size_t size);
 
 private:
     virtual void onBeginParse();
@@ -57,9 +57,9 @@ namespace plist { namespace Format {
 
 template<typename T>
 static std::unique_ptr<Any>
-IdentifyImpl(std::vector<uint8_t> const &contents)
+IdentifyImpl(uint8_t const *data, size_t size)
 {
-    std::unique_ptr<T> format = T::Identify(contents);
+    std::unique_ptr<T> format = T::Identify(data, size);
     if (format != nullptr) {
         return std::unique_ptr<Any>(new Any(Any::Create<T>(*format)));
     }
@@ -69,11 +69,11 @@ IdentifyImpl(std::vector<uint8_t> const &contents)
 
 template<>
 std::unique_ptr<Any> Format<Any>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(uint8_t const *data, size_t size)
 {
 #define FORMAT(T) \
     { \
-        std::unique_ptr<Any> result = IdentifyImpl<T>(contents); \
+        std::unique_ptr<Any> result = IdentifyImpl<T>(data, size); \
         if (result != nullptr) { \
             return result; \
         } \
@@ -90,22 +90,22 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<typename T>
 static std::pair<std::unique_ptr<Object>, std::string>
-DeserializeImpl(std::vector<uint8_t> const &contents, Any const &format)
+DeserializeImpl(uint8_t const *data, size_t size, Any const &format)
 {
-    return T::Deserialize(contents, *format.format<T>());
+    return T::Deserialize(data, size, *format.format<T>());
 }
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<Any>::
-Deserialize(std::vector<uint8_t> const &contents, Any const &format)
+Deserialize(uint8_t const *data, size_t size, Any const &format)
 {
     switch (format.type()) {
         case Type::Binary:
-            return DeserializeImpl<Binary>(contents, format);
+            return DeserializeImpl<Binary>(data, size, format);
         case Type::XML:
-            return DeserializeImpl<XML>(contents, format);
+            return DeserializeImpl<XML>(data, size, format);
         case Type::ASCII:
-            return DeserializeImpl<ASCII>(contents, format);
+            return DeserializeImpl<ASCII>(data, size, format);
     }
 
     abort();
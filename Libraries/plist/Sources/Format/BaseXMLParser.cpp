@@ -21,10 +21,10 @@ BaseXMLParser::BaseXMLParser() :
 }
 
 bool BaseXMLParser::
-parse(std::vector<uint8_t> const &contents)
+parse(uint8_t const *data, size_t size)
 {
     _depth  = 0;
-    _parser = ::xmlReaderForMemory(reinterpret_cast<char const *>(contents.data()), contents.size(), nullptr, nullptr, XML_PARSE_NOENT | XML_PARSE_NONET);
+    _parser = ::xmlReaderForMemory(reinterpret_cast<char const *>(data), size, nullptr, nullptr, XML_PARSE_NOENT | XML_PARSE_NONET);
     if (_parser == nullptr) {
         return false;
     }
@@ -48,15 +48,15 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<Binary> Format<Binary>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(uint8_t const *data, size_t size)
 {
     size_t length = strlen(ABPLIST_MAGIC ABPLIST_VERSION);
 
-    if (contents.size() < length) {
+    if (size < length) {
         return nullptr;
     }
 
-    if (std::memcmp(contents.data(), ABPLIST_MAGIC ABPLIST_VERSION, length) == 0) {
+    if (std::memcmp(data, ABPLIST_MAGIC ABPLIST_VERSION, length) == 0) {
         return std::unique_ptr<Binary>(new Binary(Binary::Create()));
     }
 
@@ -68,10 +68,11 @@ struct BinaryParseContext {
     ABPStreamCallBacks            streamCallBacks;
     ABPCreateCallBacks            createCallBacks;
 
-    std::vector<uint8_t> const   *contents;
+    uint8_t const                *data;
+    size_t                        size;
     off_t                         offset;
 
-    std::unordered_set<Object *>  seen;
+    std::unordered_set<Object *>  owned;
     std::string                   error;
 };
 
@@ -88,13 +89,13 @@ ReadSeek(void *opaque, off_t offset, int whence)
             self->offset += offset;
             break;
         case SEEK_END:
-            self->offset = self->contents->size() + offset;
+            self->offset = self->size + offset;
         default:
             break;
     }
 
     /* Error if past the end. */
-    if (self->offset > self->contents->size()) {
+    if (self->offset > self->size) {
         return -1;
     }
 
@@ -108,18 +109,33 @@ ReadData(void *opaque, void *buffer, size_t size)
     auto self = reinterpret_cast <BinaryParseContext *> (opaque);
 
     /* Adjust size for remaining contents. */
-    size_t remaining = self->contents->size() - self->offset;
+    size_t remaining = self->size - self->offset;
     if (remaining < size) {
         size = remaining;
     }
 
     /* Copy into read buffer. */
-    ::memcpy(buffer, self->contents->data() + self->offset, size);
+    ::memcpy(buffer, self->data + self->offset, size);
 
     self->offset += size;
     return size;
 }
 
+/*
+ * Take ownership of an object from the reader's object table. The first
+ * reference to an object moves it out of the table; objects shared between
+ * containers in the file are copied for any further references.
+ */
+static std::unique_ptr<Object>
+TakeObject(BinaryParseContext *self, Object *object)
+{
+    if (self->owned.insert(object).second) {
+        return std::unique_ptr<Object>(object);
+    } else {
+        return object->copy();
+    }
+}
+
 static Object *
 Create(void *opaque, ABPRecordType type, void *arg1, void *arg2, void *arg3)
 {
@@ -229,16 +245,7 @@ Create(void *opaque, ABPRecordType type, void *arg1, void *arg2, void *arg3)
                     return nullptr;
                 }
 
-                //
-                // Due to the memory layout of the `plist' objects,
-                // we must always copy objects.
-                //
-                if (self->seen.find(object) != self->seen.end()) {
-                    self->seen.insert(object);
-                }
-                object = object->copy().release();
-
-                array->append(std::unique_ptr<Object>(object));
+                array->append(TakeObject(self, object));
             }
             return array.release();
         }
@@ -268,16 +275,7 @@ Create(void *opaque, ABPRecordType type, void *arg1, void *arg2, void *arg3)
                     return nullptr;
                 }
 
-                //
-                // Due to the memory layout of the `plist' objects,
-                // we must always copy objects.
-                //
-                if (self->seen.find(object) != self->seen.end()) {
-                    self->seen.insert(object);
-                }
-                object = object->copy().release();
-
-                dict->set(keyString->value(), std::unique_ptr<Object>(object));
+                dict->set(keyString->value(), TakeObject(self, object));
             }
             return dict.release();
         }
@@ -297,7 +295,7 @@ Error(void *opaque, char const *message)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<Binary>::
-Deserialize(std::vector<uint8_t> const &contents, Binary const &format)
+Deserialize(uint8_t const *data, size_t size, Binary const &format)
 {
     BinaryParseContext parseContext;
 
@@ -313,7 +311,8 @@ Deserialize(std::vector<uint8_t> const &contents, Binary const &format)
     parseContext.createCallBacks.create  = &Create;
     parseContext.createCallBacks.error   = &Error;
 
-    parseContext.contents                = &contents;
+    parseContext.data                    = data;
+    parseContext.size                    = size;
     parseContext.offset                  = 0;
 
     ::ABPReaderInit(&parseContext.context, &parseContext.streamCallBacks, &parseContext.createCallBacks);
@@ -322,8 +321,16 @@ Deserialize(std::vector<uint8_t> const &contents, Binary const &format)
     if (::ABPReaderOpen(&parseContext.context)) {
         Object *topObject = ::ABPReadTopLevelObject(&parseContext.context);
         if (topObject != nullptr) {
-            object = topObject->copy();
+            object = TakeObject(&parseContext, topObject);
         }
+
+        /* Objects moved out of the table are no longer the reader's to free. */
+        for (size_t n = 0; n < parseContext.context.trailer.objectsCount; n++) {
+            if (parseContext.owned.find(parseContext.context.objects[n]) != parseContext.owned.end()) {
+                parseContext.context.objects[n] = nullptr;
+            }
+        }
+
         ::ABPReaderClose(&parseContext.context);
     }
 
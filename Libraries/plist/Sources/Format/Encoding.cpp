@@ -20,19 +20,19 @@ using plist::Format::Encoding;
 using plist::Format::Encodings;
 
 Encoding Encodings::
-Detect(std::vector<uint8_t> const &contents)
+Detect(uint8_t const *data, size_t size)
 {
     /*
      * Check for a UTF-32 BOM. First as bytes overlap with UTF-16 LE.
      */
-    if (contents.size() >= 4) {
+    if (size >= 4) {
         std::vector<uint8_t> UTF32BE_BOM = Encodings::BOM(Encoding::UTF32BE);
-        if (std::equal(UTF32BE_BOM.begin(), UTF32BE_BOM.end(), contents.begin())) {
+        if (std::equal(UTF32BE_BOM.begin(), UTF32BE_BOM.end(), data)) {
             return Encoding::UTF32BE;
         }
 
         std::vector<uint8_t> UTF32LE_BOM = Encodings::BOM(Encoding::UTF32LE);
-        if (std::equal(UTF32LE_BOM.begin(), UTF32LE_BOM.end(), contents.begin())) {
+        if (std::equal(UTF32LE_BOM.begin(), UTF32LE_BOM.end(), data)) {
             return Encoding::UTF32LE;
         }
     }
@@ -40,14 +40,14 @@ Detect(std::vector<uint8_t> const &contents)
     /*
      * Check for a UTF-16 BOM.
      */
-    if (contents.size() >= 2) {
+    if (size >= 2) {
         std::vector<uint8_t> UTF16BE_BOM = Encodings::BOM(Encoding::UTF16BE);
-        if (std::equal(UTF16BE_BOM.begin(), UTF16BE_BOM.end(), contents.begin())) {
+        if (std::equal(UTF16BE_BOM.begin(), UTF16BE_BOM.end(), data)) {
             return Encoding::UTF16BE;
         }
 
         std::vector<uint8_t> UTF16LE_BOM = Encodings::BOM(Encoding::UTF16LE);
-        if (std::equal(UTF16LE_BOM.begin(), UTF16LE_BOM.end(), contents.begin())) {
+        if (std::equal(UTF16LE_BOM.begin(), UTF16LE_BOM.end(), data)) {
             return Encoding::UTF16LE;
         }
     }
@@ -56,6 +56,23 @@ Detect(std::vector<uint8_t> const &contents)
     return Encoding::UTF8;
 }
 
+std::pair<uint8_t const *, size_t> Encodings::
+ToUTF8(uint8_t const *data, size_t size, Encoding from, std::vector<uint8_t> *buffer)
+{
+    if (from != Encoding::UTF8) {
+        *buffer = Encodings::Convert(data, size, from, Encoding::UTF8);
+        return std::make_pair(buffer->data(), buffer->size());
+    }
+
+    std::vector<uint8_t> BOM = Encodings::BOM(Encoding::UTF8);
+    if (size >= BOM.size() && std::equal(BOM.begin(), BOM.end(), data)) {
+        data += BOM.size();
+        size -= BOM.size();
+    }
+
+    return std::make_pair(data, size);
+}
+
 std::vector<uint8_t> Encodings::
 BOM(Encoding encoding)
 {
@@ -133,16 +150,17 @@ EndianSwapBuffer(std::vector<uint8_t> *buffer, Endian src, Endian dest)
 }
 
 std::vector<uint8_t> Encodings::
-Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
+Convert(uint8_t const *data, size_t size, Encoding from, Encoding to)
 {
-    std::vector<uint8_t> input = contents;
-
     /* Remove any BOM at the start. */
     std::vector<uint8_t> BOM = Encodings::BOM(from);
-    if (input.size() >= BOM.size() && std::equal(BOM.begin(), BOM.end(), contents.begin())) {
-        input.erase(input.begin(), input.begin() + BOM.size());
+    if (size >= BOM.size() && std::equal(BOM.begin(), BOM.end(), data)) {
+        data += BOM.size();
+        size -= BOM.size();
     }
 
+    std::vector<uint8_t> input = std::vector<uint8_t>(data, data + size);
+
     /* No conversion needed, just byte swap if necessary. */
     if (from == to) {
         return input;
@@ -195,7 +213,7 @@ Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
         std::vector<uint8_t> result;
 
         if (to == Encoding::UTF16LE || to == Encoding::UTF16BE) {
-            result.resize(contents.size() * sizeof(uint16_t) * 3);
+            result.resize(size * sizeof(uint16_t) * 3);
             size_t length = ::utf8_to_utf16(
                 reinterpret_cast<uint16_t *>(result.data()), result.size() / sizeof(uint16_t),
                 reinterpret_cast<char *>(intermediate.data()), intermediate.size() / sizeof(char),
@@ -35,7 +35,7 @@ namespace plist { namespace Format {
 
 template<>
 std::unique_ptr<XML> Format<XML>::
-Identify(std::vector<uint8_t> const &contents)
+Identify(uint8_t const *data, size_t size)
 {
     /*
      * To identify XML document, we look for a <? or <!, ignoring
@@ -44,7 +44,7 @@ Identify(std::vector<uint8_t> const &contents)
 
     uint8_t last = '\0';
 
-    for (auto bp = contents.begin(); bp != contents.end();) {
+    for (uint8_t const *bp = data; bp != data + size;) {
         /* Conceal zeroes for UTF-16/32 encodings. */
         if (*bp == 0 || isspace(*bp)) {
             bp++;
@@ -55,9 +55,9 @@ Identify(std::vector<uint8_t> const &contents)
                 /* Found <? or <! */
             }
 
-            Encoding encoding = Encodings::Detect(contents);
+            Encoding encoding = Encodings::Detect(data, size);
             return std::unique_ptr<XML>(new XML(XML::Create(encoding)));
-        } else if (bp - contents.begin() < 4) {
+        } else if (bp - data < 4) {
             /*
              * We conceal some BOM chars for UTF encodings in the first
              * four bytes.
@@ -83,12 +83,13 @@ Identify(std::vector<uint8_t> const &contents)
 
 template<>
 std::pair<std::unique_ptr<Object>, std::string> Format<XML>::
-Deserialize(std::vector<uint8_t> const &contents, XML const &format)
+Deserialize(uint8_t const *data, size_t size, XML const &format)
 {
-    std::vector<uint8_t> const data = Encodings::Convert(contents, format.encoding(), Encoding::UTF8);
+    std::vector<uint8_t> buffer;
+    std::pair<uint8_t const *, size_t> converted = Encodings::ToUTF8(data, size, format.encoding(), &buffer);
 
     XMLParser parser;
-    std::unique_ptr<Object> root = std::unique_ptr<Object>(parser.parse(data));
+    std::unique_ptr<Object> root = std::unique_ptr<Object>(parser.parse(converted.first, converted.second));
     if (root == nullptr) {
         return std::make_pair(nullptr, parser.error());
     }
@@ -13,7 +13,9 @@
 
 using plist::Format::Binary;
 using plist::String;
+using plist::Array;
 using plist::Dictionary;
+using plist::Integer;
 
 TEST(Binary, UnicodeString)
 {
@@ -42,3 +44,27 @@ TEST(Binary, UnicodeString)
     EXPECT_EQ(*serialize.first, contents);
 }
 
+TEST(Binary, SharedObjects)
+{
+    /* Equal values are written once and referenced from each container. */
+    auto nested = Dictionary::New();
+    nested->set("d", String::New("same"));
+
+    auto array = Array::New();
+    array->append(String::New("same"));
+    array->append(std::move(nested));
+
+    auto dict = Dictionary::New();
+    dict->set("a", String::New("same"));
+    dict->set("b", String::New("same"));
+    dict->set("c", std::move(array));
+    dict->set("e", Integer::New(1));
+    dict->set("f", Integer::New(1));
+
+    auto serialize = Binary::Serialize(dict.get(), Binary::Create());
+    ASSERT_NE(serialize.first, nullptr);
+
+    auto deserialize = Binary::Deserialize(*serialize.first, Binary::Create());
+    ASSERT_NE(deserialize.first, nullptr);
+    EXPECT_TRUE(deserialize.first->equals(dict.get()));
+}
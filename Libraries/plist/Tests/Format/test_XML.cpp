@@ -70,3 +70,14 @@ TEST(XML, UID)
     EXPECT_EQ(*serialize.first, contents);
 }
 
+TEST(XML, ByteOrderMark)
+{
+    auto contents = Contents("\xEF\xBB\xBF" + std::string(XMLHeader) + "<string>value</string>\n" + std::string(XMLFooter));
+    EXPECT_NE(XML::Identify(contents), nullptr);
+
+    auto deserialize = XML::Deserialize(contents.data(), contents.size(), XML::Create(Encoding::UTF8));
+    ASSERT_NE(deserialize.first, nullptr);
+
+    auto string = String::New("value");
+    EXPECT_TRUE(deserialize.first->equals(string.get()));
+}
@@ -0,0 +1,95 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <plist/Object.h>
+#include <plist/Format/Any.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/FileContents.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+using libutil::DefaultFilesystem;
+using libutil::FileContents;
+
+/*
+ * Peak resident set size of this process so far, in KiB.
+ */
+static size_t
+PeakResidentSize()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+#if defined(__APPLE__)
+    /* Reported in bytes. */
+    return usage.ru_maxrss / 1024;
+#else
+    /* Reported in kilobytes. */
+    return usage.ru_maxrss;
+#endif
+}
+
+int
+main(int argc, char **argv)
+{
+    /*
+     * Peak memory only grows, so each way of loading is measured in a
+     * separate process: run once with -read and once with -map.
+     */
+    if (argc != 3 || (strcmp(argv[1], "-read") != 0 && strcmp(argv[1], "-map") != 0)) {
+        fprintf(stderr, "usage: %s -read|-map <file.plist>\n", argv[0]);
+        return 1;
+    }
+
+    bool map = (strcmp(argv[1], "-map") == 0);
+    DefaultFilesystem filesystem = DefaultFilesystem();
+
+    size_t baseline = PeakResidentSize();
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<FileContents> contents;
+    if (map) {
+        contents = filesystem.map(argv[2]);
+    } else {
+        std::vector<uint8_t> buffer;
+        if (filesystem.read(&buffer, argv[2])) {
+            contents = std::unique_ptr<FileContents>(new FileContents(std::move(buffer)));
+        }
+    }
+    if (contents == nullptr) {
+        fprintf(stderr, "error: unable to read %s\n", argv[2]);
+        return 1;
+    }
+
+    size_t loaded = PeakResidentSize();
+
+    auto result = plist::Format::Any::Deserialize(contents->data(), contents->size());
+    if (result.first == nullptr) {
+        fprintf(stderr, "error: %s\n", result.second.c_str());
+        return 1;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    size_t parsed = PeakResidentSize();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("%-12s %12s %14s %14s %10s\n", "mode", "file KiB", "load peak KiB", "parse peak KiB", "ms");
+    printf("%-12s %12zu %14zu %14zu %10.1f\n", argv[1] + 1, contents->size() / 1024, loaded - baseline, parsed - baseline, ms);
+
+    return 0;
+}
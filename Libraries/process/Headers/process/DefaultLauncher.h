@@ -12,20 +12,51 @@
 
 #include <process/Launcher.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <sys/types.h>
+
 namespace libutil { class Filesystem; }
 
 namespace process {
 
 /*
- * Abstract process launcher.
+ * Launches processes on the system. Processes are started with `posix_spawn`
+ * rather than forking this process, and all running processes are serviced
+ * by a single event loop: whichever thread is waiting runs it on behalf of
+ * the others, reading captured output and noticing exits.
  */
 class DefaultLauncher : public Launcher {
+private:
+    struct Running {
+        Process::shared_ptr process;
+        pid_t               pid;
+        int                 standardOutput;
+        int                 standardError;
+    };
+
+private:
+    std::mutex                            _mutex;
+    std::condition_variable               _condition;
+    bool                                  _polling;
+    std::vector<std::shared_ptr<Running>> _running;
+
 public:
     DefaultLauncher();
     ~DefaultLauncher();
 
 public:
-    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context);
+    virtual Process::shared_ptr spawn(libutil::Filesystem *filesystem, Context const *context, bool captureOutput);
+    virtual void poll();
+    virtual void wait(Process::shared_ptr const &process);
+
+private:
+    /*
+     * Run one iteration of the event loop. Only one thread runs the loop
+     * at a time; see `_polling`.
+     */
+    void update(bool block);
 };
 
 }
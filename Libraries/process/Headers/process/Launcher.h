@@ -12,7 +12,9 @@
 
 #include <process/Context.h>
 
-#include <sstream>
+#include <atomic>
+#include <memory>
+#include <string>
 #include <ext/optional>
 
 namespace libutil { class Filesystem; }
@@ -23,6 +25,59 @@ namespace process {
  * Abstract process launcher.
  */
 class Launcher {
+public:
+    /*
+     * A process started by a launcher. The launcher updates the process as
+     * it runs; it's finished once the launcher has seen it exit.
+     */
+    class Process {
+    public:
+        typedef std::shared_ptr<Process> shared_ptr;
+
+    private:
+        std::atomic<bool>  _finished;
+        ext::optional<int> _exitCode;
+        std::string        _standardOutput;
+        std::string        _standardError;
+
+    public:
+        Process();
+
+    public:
+        /*
+         * If the process has exited.
+         */
+        bool finished() const
+        { return _finished; }
+
+        /*
+         * The exit code of the process, once finished. Empty if the process
+         * could not be run or did not exit normally.
+         */
+        ext::optional<int> const &exitCode() const
+        { return _exitCode; }
+
+    public:
+        /*
+         * Output written by the process, if launched capturing output.
+         * Only complete once the process has finished.
+         */
+        std::string const &standardOutput() const
+        { return _standardOutput; }
+        std::string const &standardError() const
+        { return _standardError; }
+
+    public:
+        /*
+         * For launchers: record output and completion.
+         */
+        void appendStandardOutput(char const *data, size_t size)
+        { _standardOutput.append(data, size); }
+        void appendStandardError(char const *data, size_t size)
+        { _standardError.append(data, size); }
+        void finish(ext::optional<int> const &exitCode);
+    };
+
 protected:
     Launcher();
     ~Launcher();
@@ -32,7 +87,29 @@ public:
      * Launch and wait for a process. The filesystem is symbolic, to note
      * that launching a process could arbitrarily affect the filesystem.
      */
-    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context) = 0;
+    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context);
+
+public:
+    /*
+     * Start a process without waiting for it. If capturing output, the
+     * process's standard output and error are collected in the returned
+     * process rather than written to this process's. Returns null if the
+     * process could not be started.
+     */
+    virtual Process::shared_ptr spawn(libutil::Filesystem *filesystem, Context const *context, bool captureOutput) = 0;
+
+    /*
+     * Collect output from and check for exits of all running processes,
+     * without blocking.
+     */
+    virtual void poll() = 0;
+
+    /*
+     * Block until a process finishes. Output from other running processes
+     * continues to be collected while waiting. Safe to call from multiple
+     * threads at once, each waiting on its own process.
+     */
+    virtual void wait(Process::shared_ptr const &process) = 0;
 
 public:
     /*
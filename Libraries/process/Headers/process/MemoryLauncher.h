@@ -11,11 +11,17 @@
 #define __process_MemoryLauncher_h
 
 #include <process/Launcher.h>
+#include <process/MemoryContext.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 namespace process {
 
 /*
- * In-memory simulated process launcher.
+ * In-memory simulated process launcher. Spawned processes are simulated
+ * when next polled or waited on, so they run after `spawn()` returns.
  */
 class MemoryLauncher : public Launcher {
 public:
@@ -24,15 +30,45 @@ public:
      */
     using Handler = std::function<ext::optional<int>(libutil::Filesystem *filesystem, Context const *context)>;
 
+    /*
+     * Handler for a simulated process launch that writes output. Output is
+     * recorded on the process only when captured.
+     */
+    using OutputHandler = std::function<ext::optional<int>(libutil::Filesystem *filesystem, Context const *context, std::string *standardOutput, std::string *standardError)>;
+
 private:
-    std::unordered_map<std::string, Handler> _handlers;
+    struct Pending {
+        Process::shared_ptr process;
+        OutputHandler       handler;
+        libutil::Filesystem *filesystem;
+        MemoryContext       context;
+        bool                captureOutput;
+    };
+
+    struct Queue {
+        std::mutex              mutex;
+        std::condition_variable condition;
+        std::deque<Pending>     pending;
+    };
+
+private:
+    std::unordered_map<std::string, OutputHandler> _handlers;
+    std::unique_ptr<Queue>                         _queue;
 
 public:
-    MemoryLauncher(std::unordered_map<std::string, Handler> const &handlers);
+    MemoryLauncher(
+        std::unordered_map<std::string, Handler> const &handlers,
+        std::unordered_map<std::string, OutputHandler> const &outputHandlers = { });
+    MemoryLauncher(MemoryLauncher &&) = default;
     ~MemoryLauncher();
 
 public:
-    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context);
+    virtual Process::shared_ptr spawn(libutil::Filesystem *filesystem, Context const *context, bool captureOutput);
+    virtual void poll();
+    virtual void wait(Process::shared_ptr const &process);
+
+private:
+    bool runPending(std::unique_lock<std::mutex> *lock);
 };
 
 }
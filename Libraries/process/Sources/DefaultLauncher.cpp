@@ -10,16 +10,109 @@
 #include <process/DefaultLauncher.h>
 #include <libutil/Filesystem.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#if defined(__APPLE__)
+#include <Availability.h>
+#include <TargetConditionals.h>
+/* Changing directory when spawning is new in macOS 10.15; older systems fork. */
+#if (TARGET_OS_OSX && __MAC_10_15 && __MAC_OS_X_VERSION_MIN_REQUIRED >= __MAC_10_15)
+#define HAVE_POSIX_SPAWN_CHDIR 1
+#endif
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define HAVE_POSIX_SPAWN_CHDIR 1
+#endif
+
 using process::DefaultLauncher;
+using process::Launcher;
 using libutil::Filesystem;
 
+/*
+ * Written to when a child exits or a process is started, to wake up the
+ * event loop. Shared by all launchers, as is the signal handler.
+ */
+static int WakeupPipe[2] = { -1, -1 };
+
+static void
+Wakeup()
+{
+    int saved = errno;
+    ssize_t result = ::write(WakeupPipe[1], "", 1);
+    (void)result;
+    errno = saved;
+}
+
+static void
+ChildSignalHandler(int signal)
+{
+    (void)signal;
+    Wakeup();
+}
+
+static bool
+CreatePipe(int fds[2])
+{
+#if defined(__linux__)
+    if (::pipe2(fds, O_CLOEXEC) != 0) {
+        return false;
+    }
+#else
+    if (::pipe(fds) != 0) {
+        return false;
+    }
+
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+    /* Only the read end is used by this process, and never blocks. */
+    ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+static void
+ClosePipe(int fds[2])
+{
+    for (int i = 0; i < 2; ++i) {
+        if (fds[i] != -1) {
+            ::close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
 DefaultLauncher::
 DefaultLauncher() :
-    Launcher()
+    Launcher(),
+    _polling(false)
 {
+    static std::once_flag once;
+    std::call_once(once, []{
+        if (!CreatePipe(WakeupPipe)) {
+            return;
+        }
+        ::fcntl(WakeupPipe[1], F_SETFL, ::fcntl(WakeupPipe[1], F_GETFL) | O_NONBLOCK);
+
+        /*
+         * Don't replace a handler installed by someone else; exits are still
+         * noticed, just less promptly.
+         */
+        struct sigaction previous;
+        if (::sigaction(SIGCHLD, nullptr, &previous) == 0 && previous.sa_handler == SIG_DFL) {
+            struct sigaction action = { };
+            action.sa_handler = &ChildSignalHandler;
+            action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+            sigemptyset(&action.sa_mask);
+            ::sigaction(SIGCHLD, &action, nullptr);
+        }
+    });
 }
 
 DefaultLauncher::
@@ -27,24 +120,94 @@ DefaultLauncher::
 {
 }
 
-ext::optional<int> DefaultLauncher::
-launch(Filesystem *filesystem, Context const *context)
+static bool
+SpawnProcess(
+    pid_t *pid,
+    char const *path,
+    char *const *arguments,
+    char *const *environment,
+    char const *directory,
+    uid_t uid,
+    gid_t gid,
+    int const output[2],
+    int const error[2])
 {
+#if defined(HAVE_POSIX_SPAWN_CHDIR)
     /*
-     * Extract input data for exec, so no C++ is required after fork.
+     * Spawning can't change users, but that's only needed when running
+     * processes as a different user than this one.
      */
+    if (uid == ::getuid() && gid == ::getgid()) {
+        posix_spawn_file_actions_t actions;
+        if (::posix_spawn_file_actions_init(&actions) != 0) {
+            return false;
+        }
+
+        /* The pipes are close-on-exec; the duplicates aren't. */
+        if (output[1] != -1) {
+            ::posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+        }
+        if (error[1] != -1) {
+            ::posix_spawn_file_actions_adddup2(&actions, error[1], STDERR_FILENO);
+        }
+        ::posix_spawn_file_actions_addchdir_np(&actions, directory);
+
+        int result = ::posix_spawn(pid, path, &actions, nullptr, arguments, environment);
+        ::posix_spawn_file_actions_destroy(&actions);
+        return (result == 0);
+    }
+#endif
+
+    /*
+     * Fall back to forking. Only system calls are made after the fork.
+     */
+    *pid = ::fork();
+    if (*pid < 0) {
+        /* Fork failed. */
+        return false;
+    } else if (*pid == 0) {
+        /* Fork succeeded, new process. */
+        if (output[1] != -1 && ::dup2(output[1], STDOUT_FILENO) == -1) {
+            ::_exit(1);
+        }
+        if (error[1] != -1 && ::dup2(error[1], STDERR_FILENO) == -1) {
+            ::_exit(1);
+        }
+
+        if (::chdir(directory) == -1) {
+            ::perror("chdir");
+            ::_exit(1);
+        }
+
+        if (::setgid(gid) == -1) {
+            ::perror("setgid");
+            ::_exit(1);
+        }
+
+        if (::setuid(uid) == -1) {
+            ::perror("setuid");
+            ::_exit(1);
+        }
+
+        ::execve(path, arguments, environment);
+        ::_exit(-1);
+    }
+
+    /* Fork succeeded, existing process. */
+    return true;
+}
+
+Launcher::Process::shared_ptr DefaultLauncher::
+spawn(Filesystem *filesystem, Context const *context, bool captureOutput)
+{
     std::string path = context->executablePath();
     if (!filesystem->isExecutable(path)) {
-        return ext::nullopt;
+        return nullptr;
     }
-    char const *cPath = path.c_str();
-
-    std::string directory = context->currentDirectory();
-    char const *cDirectory = directory.c_str();
 
     /* Compute command-line arguments. */
     std::vector<char const *> execArgs;
-    execArgs.push_back(cPath);
+    execArgs.push_back(path.c_str());
 
     std::vector<std::string> arguments = context->commandLineArguments();
     for (std::string const &argument : arguments) {
@@ -67,42 +230,186 @@ launch(Filesystem *filesystem, Context const *context)
     execEnv.push_back(nullptr);
     char *const *cExecEnv = const_cast<char *const *>(execEnv.data());
 
-    /* Compute user. */
-    uid_t uid = context->userID();
-    gid_t gid = context->groupID();
+    /* Create pipes to capture output. */
+    int output[2] = { -1, -1 };
+    int error[2] = { -1, -1 };
+    if (captureOutput) {
+        if (!CreatePipe(output) || !CreatePipe(error)) {
+            ClosePipe(output);
+            ClosePipe(error);
+            return nullptr;
+        }
+    }
+
+    pid_t pid;
+    std::string directory = context->currentDirectory();
+    if (!SpawnProcess(&pid, path.c_str(), cExecArgs, cExecEnv, directory.c_str(), context->userID(), context->groupID(), output, error)) {
+        ClosePipe(output);
+        ClosePipe(error);
+        return nullptr;
+    }
+
+    /* Only the child writes to the pipes. */
+    if (captureOutput) {
+        ::close(output[1]);
+        ::close(error[1]);
+    }
+
+    auto running = std::make_shared<Running>();
+    running->process = std::make_shared<Process>();
+    running->pid = pid;
+    running->standardOutput = output[0];
+    running->standardError = error[0];
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running.push_back(running);
+    }
+
+    /* If another thread is in the event loop, it needs to watch this process too. */
+    Wakeup();
+
+    return running->process;
+}
+
+static void
+ReadOutput(int *fd, Launcher::Process *process, bool error)
+{
+    if (*fd == -1) {
+        return;
+    }
+
+    char buffer[16384];
+    while (true) {
+        ssize_t size = ::read(*fd, buffer, sizeof(buffer));
+        if (size > 0) {
+            if (error) {
+                process->appendStandardError(buffer, size);
+            } else {
+                process->appendStandardOutput(buffer, size);
+            }
+        } else if (size < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                /* End of output. */
+                ::close(*fd);
+                *fd = -1;
+            }
+            break;
+        }
+    }
+}
+
+void DefaultLauncher::
+update(bool block)
+{
+    std::vector<std::shared_ptr<Running>> running;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        running = _running;
+    }
 
     /*
-     * Fork new process.
+     * Wait for output or for a child to exit. Exits are signaled through
+     * the wakeup pipe; time out in case that signal isn't available.
      */
-    pid_t pid = fork();
-    if (pid < 0) {
-        /* Fork failed. */
-        return ext::nullopt;
-    } else if (pid == 0) {
-        /* Fork succeeded, new process. */
-        if (::chdir(cDirectory) == -1) {
-            ::perror("chdir");
-            ::_exit(1);
+    std::vector<struct pollfd> fds;
+    fds.push_back({ WakeupPipe[0], POLLIN, 0 });
+    for (std::shared_ptr<Running> const &entry : running) {
+        for (int fd : { entry->standardOutput, entry->standardError }) {
+            if (fd != -1) {
+                fds.push_back({ fd, POLLIN, 0 });
+            }
         }
+    }
 
-        if (::setuid(uid) == -1) {
-            ::perror("setuid");
-            ::_exit(1);
+    if (::poll(fds.data(), fds.size(), block ? 100 : 0) > 0 && (fds.front().revents & POLLIN) != 0) {
+        char buffer[64];
+        while (::read(WakeupPipe[0], buffer, sizeof(buffer)) > 0) {
         }
+    }
 
-        if (::setgid(gid) == -1) {
-            ::perror("setgid");
-            ::_exit(1);
+    std::vector<std::pair<Process::shared_ptr, ext::optional<int>>> finished;
+    for (std::shared_ptr<Running> const &entry : running) {
+        ReadOutput(&entry->standardOutput, entry->process.get(), false);
+        ReadOutput(&entry->standardError, entry->process.get(), true);
+
+        int status;
+        pid_t result = ::waitpid(entry->pid, &status, WNOHANG);
+        if (result == 0 || (result < 0 && errno == EINTR)) {
+            continue;
         }
 
-        ::execve(cPath, cExecArgs, cExecEnv);
-        ::_exit(-1);
+        /*
+         * Collect any output left after exit. Descendants of the process
+         * could keep the pipes open; don't wait for them.
+         */
+        ReadOutput(&entry->standardOutput, entry->process.get(), false);
+        ReadOutput(&entry->standardError, entry->process.get(), true);
+        for (int *fd : { &entry->standardOutput, &entry->standardError }) {
+            if (*fd != -1) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
 
-        return ext::nullopt;
-    } else {
-        /* Fork succeeded, existing process. */
-        int status;
-        ::waitpid(pid, &status, 0);
-        return WEXITSTATUS(status);
+        ext::optional<int> exitCode;
+        if (result > 0 && WIFEXITED(status)) {
+            exitCode = WEXITSTATUS(status);
+        }
+        finished.push_back({ entry->process, exitCode });
+    }
+
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto const &entry : finished) {
+            entry.first->finish(entry.second);
+        }
+
+        _running.erase(std::remove_if(_running.begin(), _running.end(), [](std::shared_ptr<Running> const &entry) {
+            return entry->process->finished();
+        }), _running.end());
+    }
+}
+
+void DefaultLauncher::
+poll()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_polling) {
+            /* Another thread is already running the event loop. */
+            return;
+        }
+        _polling = true;
+    }
+
+    update(false);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _polling = false;
+    _condition.notify_all();
+}
+
+void DefaultLauncher::
+wait(Process::shared_ptr const &process)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!process->finished()) {
+        if (_polling) {
+            /* Another thread is running the event loop; it will notify. */
+            _condition.wait(lock);
+            continue;
+        }
+
+        _polling = true;
+        lock.unlock();
+
+        update(true);
+
+        lock.lock();
+        _polling = false;
+        _condition.notify_all();
     }
 }
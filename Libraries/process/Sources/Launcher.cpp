@@ -10,6 +10,20 @@
 #include <process/Launcher.h>
 
 using process::Launcher;
+using libutil::Filesystem;
+
+Launcher::Process::
+Process() :
+    _finished(false)
+{
+}
+
+void Launcher::Process::
+finish(ext::optional<int> const &exitCode)
+{
+    _exitCode = exitCode;
+    _finished = true;
+}
 
 Launcher::
 Launcher()
@@ -21,6 +35,18 @@ Launcher::
 {
 }
 
+ext::optional<int> Launcher::
+launch(Filesystem *filesystem, Context const *context)
+{
+    Process::shared_ptr process = spawn(filesystem, context, false);
+    if (process == nullptr) {
+        return ext::nullopt;
+    }
+
+    wait(process);
+    return process->exitCode();
+}
+
 #include <process/DefaultLauncher.h>
 
 using process::DefaultLauncher;
@@ -35,4 +61,3 @@ GetDefaultUNSAFE()
 
     return defaultLauncher;
 }
-
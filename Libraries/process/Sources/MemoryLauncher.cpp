@@ -11,13 +11,23 @@
 #include <libutil/Filesystem.h>
 
 using process::MemoryLauncher;
+using process::Launcher;
 using libutil::Filesystem;
 
 MemoryLauncher::
-MemoryLauncher(std::unordered_map<std::string, Handler> const &handlers) :
+MemoryLauncher(
+    std::unordered_map<std::string, Handler> const &handlers,
+    std::unordered_map<std::string, OutputHandler> const &outputHandlers) :
     Launcher (),
-    _handlers(handlers)
+    _handlers(outputHandlers),
+    _queue(new Queue())
 {
+    for (auto const &entry : handlers) {
+        Handler handler = entry.second;
+        _handlers.insert({ entry.first, [handler](Filesystem *filesystem, Context const *context, std::string *standardOutput, std::string *standardError) {
+            return handler(filesystem, context);
+        } });
+    }
 }
 
 MemoryLauncher::
@@ -25,13 +35,65 @@ MemoryLauncher::
 {
 }
 
-ext::optional<int> MemoryLauncher::
-launch(Filesystem *filesystem, Context const *context)
+Launcher::Process::shared_ptr MemoryLauncher::
+spawn(Filesystem *filesystem, Context const *context, bool captureOutput)
 {
     auto it = _handlers.find(context->executablePath());
-    if (it != _handlers.end()) {
-        return it->second(filesystem, context);
+    if (it == _handlers.end()) {
+        return nullptr;
+    }
+
+    auto process = std::make_shared<Process>();
+
+    std::lock_guard<std::mutex> lock(_queue->mutex);
+    _queue->pending.push_back({ process, it->second, filesystem, MemoryContext(context), captureOutput });
+    return process;
+}
+
+bool MemoryLauncher::
+runPending(std::unique_lock<std::mutex> *lock)
+{
+    if (_queue->pending.empty()) {
+        return false;
+    }
+
+    Pending pending = std::move(_queue->pending.front());
+    _queue->pending.pop_front();
+    lock->unlock();
+
+    std::string standardOutput;
+    std::string standardError;
+    ext::optional<int> exitCode = pending.handler(pending.filesystem, &pending.context, &standardOutput, &standardError);
+    if (pending.captureOutput) {
+        pending.process->appendStandardOutput(standardOutput.data(), standardOutput.size());
+        pending.process->appendStandardError(standardError.data(), standardError.size());
     } else {
-        return ext::nullopt;
+        fputs(standardOutput.c_str(), stdout);
+        fputs(standardError.c_str(), stderr);
+    }
+
+    lock->lock();
+    pending.process->finish(exitCode);
+    _queue->condition.notify_all();
+    return true;
+}
+
+void MemoryLauncher::
+poll()
+{
+    std::unique_lock<std::mutex> lock(_queue->mutex);
+    while (runPending(&lock)) {
+    }
+}
+
+void MemoryLauncher::
+wait(Process::shared_ptr const &process)
+{
+    std::unique_lock<std::mutex> lock(_queue->mutex);
+    while (!process->finished()) {
+        if (!runPending(&lock)) {
+            /* Being simulated on another thread. */
+            _queue->condition.wait(lock);
+        }
     }
 }
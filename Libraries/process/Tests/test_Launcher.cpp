@@ -0,0 +1,135 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <process/DefaultContext.h>
+#include <process/DefaultLauncher.h>
+#include <process/MemoryContext.h>
+#include <process/MemoryLauncher.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <thread>
+
+using process::Launcher;
+using process::DefaultLauncher;
+using process::MemoryLauncher;
+using process::MemoryContext;
+using libutil::DefaultFilesystem;
+using libutil::MemoryFilesystem;
+
+static MemoryContext
+ShellContext(std::string const &script)
+{
+    process::DefaultContext processContext;
+    return MemoryContext(
+        "/bin/sh",
+        "/",
+        { "-c", script },
+        processContext.environmentVariables(),
+        processContext.userID(),
+        processContext.groupID(),
+        processContext.userName(),
+        processContext.groupName());
+}
+
+TEST(DefaultLauncher, Launch)
+{
+    DefaultFilesystem filesystem;
+    DefaultLauncher launcher;
+
+    MemoryContext success = ShellContext("exit 0");
+    EXPECT_EQ(0, launcher.launch(&filesystem, &success));
+
+    MemoryContext failure = ShellContext("exit 3");
+    EXPECT_EQ(3, launcher.launch(&filesystem, &failure));
+
+    MemoryContext missing = ShellContext("");
+    missing.executablePath() = "/nonexistent";
+    EXPECT_EQ(ext::nullopt, launcher.launch(&filesystem, &missing));
+}
+
+TEST(DefaultLauncher, CaptureOutput)
+{
+    DefaultFilesystem filesystem;
+    DefaultLauncher launcher;
+
+    MemoryContext context = ShellContext("pwd; echo error >&2; exit 1");
+    Launcher::Process::shared_ptr process = launcher.spawn(&filesystem, &context, true);
+    ASSERT_NE(nullptr, process);
+
+    launcher.wait(process);
+    EXPECT_TRUE(process->finished());
+    EXPECT_EQ(1, process->exitCode());
+    EXPECT_EQ("/\n", process->standardOutput());
+    EXPECT_EQ("error\n", process->standardError());
+}
+
+TEST(DefaultLauncher, Concurrent)
+{
+    DefaultFilesystem filesystem;
+    DefaultLauncher launcher;
+
+    /* More output than fits in a pipe, so each process needs its output read to exit. */
+    std::vector<Launcher::Process::shared_ptr> processes;
+    for (int i = 0; i < 4; ++i) {
+        MemoryContext context = ShellContext("i=0; while [ $i -lt 2000 ]; do echo 0123456789012345678901234567890123456789; i=$((i+1)); done; exit " + std::to_string(i));
+        processes.push_back(launcher.spawn(&filesystem, &context, true));
+        ASSERT_NE(nullptr, processes.back());
+    }
+
+    /* Wait from several threads at once. */
+    std::vector<std::thread> threads;
+    for (Launcher::Process::shared_ptr const &process : processes) {
+        threads.push_back(std::thread([&launcher, process] {
+            launcher.wait(process);
+        }));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < processes.size(); ++i) {
+        EXPECT_TRUE(processes[i]->finished());
+        EXPECT_EQ(static_cast<int>(i), processes[i]->exitCode());
+        EXPECT_EQ(2000 * 41, processes[i]->standardOutput().size());
+    }
+}
+
+TEST(MemoryLauncher, Spawn)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({ });
+    MemoryLauncher launcher = MemoryLauncher({
+        { "/bin/true", [](libutil::Filesystem *filesystem, process::Context const *context) -> ext::optional<int> {
+            return 0;
+        } },
+    }, {
+        { "/bin/echo", [](libutil::Filesystem *filesystem, process::Context const *context, std::string *standardOutput, std::string *standardError) -> ext::optional<int> {
+            *standardOutput = context->commandLineArguments().front() + "\n";
+            return 2;
+        } },
+    });
+
+    MemoryContext context = MemoryContext("/bin/echo", "/", { "hello" }, { }, 0, 0, "root", "wheel");
+    Launcher::Process::shared_ptr process = launcher.spawn(&filesystem, &context, true);
+    ASSERT_NE(nullptr, process);
+
+    /* Simulated processes run once polled or waited on. */
+    EXPECT_FALSE(process->finished());
+    launcher.poll();
+    EXPECT_TRUE(process->finished());
+    EXPECT_EQ(2, process->exitCode());
+    EXPECT_EQ("hello\n", process->standardOutput());
+
+    context.executablePath() = "/bin/true";
+    EXPECT_EQ(0, launcher.launch(&filesystem, &context));
+
+    context.executablePath() = "/bin/false";
+    EXPECT_EQ(nullptr, launcher.spawn(&filesystem, &context, false));
+}
@@ -266,15 +266,15 @@ LoadContents(Filesystem const *filesystem, std::string const &path, std::unique_
         /*
          * Read in the contents file.
          */
-        std::vector<uint8_t> contents;
-        if (!filesystem->read(&contents, contentsPath)) {
+        std::unique_ptr<libutil::FileContents> contents = filesystem->map(contentsPath);
+        if (contents == nullptr) {
             return false;
         }
 
         /*
          * If the Contents.json file exists, it must be JSON.
          */
-        auto deserialized = plist::Format::JSON::Deserialize(contents, plist::Format::JSON::Create());
+        auto deserialized = plist::Format::JSON::Deserialize(contents->data(), contents->size(), plist::Format::JSON::Create());
         if (!deserialized.first) {
             return false;
         }
@@ -49,6 +49,8 @@ private:
     ext::optional<std::string> _formatter;
     ext::optional<std::string> _executor;
     ext::optional<bool>        _generate;
+    ext::optional<bool>        _incremental;
+    ext::optional<bool>        _cacheFilesystem;
 
 private:
     ext::optional<bool>        _parallelizeTargets;
@@ -158,6 +160,12 @@ public:
     /* Extension. */
     bool generate() const
     { return _generate.value_or(false); }
+    /* Extension. */
+    bool incremental() const
+    { return _incremental.value_or(false); }
+    /* Extension. */
+    bool cacheFilesystem() const
+    { return _cacheFilesystem.value_or(false); }
 
 public:
     bool parallelizeTargets() const
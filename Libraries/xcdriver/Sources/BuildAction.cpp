@@ -16,6 +16,7 @@
 #include <xcformatter/NullFormatter.h>
 #include <builtin/Registry.h>
 #include <libutil/Base.h>
+#include <libutil/CachedFilesystem.h>
 #include <libutil/Filesystem.h>
 #include <process/Context.h>
 
@@ -57,14 +58,16 @@ CreateExecutor(
     ext::optional<std::string> const &executor,
     std::shared_ptr<xcformatter::Formatter> const &formatter,
     bool dryRun,
-    bool generate)
+    bool generate,
+    size_t jobs,
+    bool incremental)
 {
     if (!executor || *executor == "simple") {
         auto registry = builtin::Registry::Default();
-        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, registry);
+        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, jobs, incremental, registry);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     } else if (*executor == "ninja") {
-        auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate);
+        auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate, jobs);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     }
 
@@ -78,7 +81,7 @@ VerifySupportedOptions(Options const &options)
         fprintf(stderr, "warning: toolchain option not implemented\n");
     }
 
-    if (options.quiet() || options.verbose() || options.json() || options.hideShellScriptEnvironment()) {
+    if (options.quiet() || options.json() || options.hideShellScriptEnvironment()) {
         fprintf(stderr, "warning: output options not implemented\n");
     }
 
@@ -86,10 +89,15 @@ VerifySupportedOptions(Options const &options)
         fprintf(stderr, "warning: destination option not implemented\n");
     }
 
-    if (options.parallelizeTargets() || options.jobs()) {
+    if (options.parallelizeTargets()) {
         fprintf(stderr, "warning: job control option not implemented\n");
     }
 
+    if (options.jobs() && *options.jobs() < 1) {
+        fprintf(stderr, "error: jobs must be at least one\n");
+        return false;
+    }
+
     if (options.enableAddressSanitizer() || options.enableThreadSanitizer() || options.enableCodeCoverage()) {
         fprintf(stderr, "warning: build mode option not implemented\n");
     }
@@ -140,12 +148,23 @@ Run(process::Context const *processContext, process::Launcher *processLauncher,
     /*
      * Create the executor used to perform the build.
      */
-    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate());
+    size_t jobs = static_cast<size_t>(options.jobs().value_or(1));
+    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate(), jobs, options.incremental());
     if (executor == nullptr) {
         fprintf(stderr, "error: unknown executor '%s'\n", options.executor()->c_str());
         return -1;
     }
 
+    /*
+     * The same paths are checked many times during a build. If requested,
+     * remember what's found for the duration of the build, rather than
+     * asking each time.
+     */
+    libutil::CachedFilesystem cachedFilesystem(filesystem);
+    if (options.cacheFilesystem()) {
+        filesystem = &cachedFilesystem;
+    }
+
     /*
      * Use the default build environment. We don't need anything custom here.
      */
@@ -173,6 +192,11 @@ Run(process::Context const *processContext, process::Launcher *processLauncher,
      * Perform the build!
      */
     bool success = executor->build(processContext, processLauncher, filesystem, *buildEnvironment, parameters);
+
+    if (options.cacheFilesystem() && options.verbose()) {
+        fprintf(stderr, "note: filesystem cache answered %zu of %zu lookups without a system call\n", cachedFilesystem.hits(), cachedFilesystem.hits() + cachedFilesystem.misses());
+    }
+
     if (!success) {
         return 1;
     }
@@ -72,6 +72,16 @@ Run(process::Context const *processContext)
         "    -generate                                   "
         "specify that an execution engine based on generating another build "
         "language should regenerate\n");
+    fprintf(
+        stdout,
+        "    -incremental                                "
+        "skip invocations that are up to date. only affects the 'simple' "
+        "execution engine\n");
+    fprintf(
+        stdout,
+        "    -cacheFilesystem                            "
+        "remember filesystem metadata for the duration of the build. "
+        "external changes made outside of build invocations are not seen\n");
     fprintf(
         stdout,
         "    -project NAME                               "
@@ -130,6 +130,10 @@ parseArgument(std::vector<std::string> const &args, std::vector<std::string>::co
         return libutil::Options::Next<std::string>(&_formatter, args, it);
     } else if (arg == "-generate") {
         return libutil::Options::Current<bool>(&_generate, arg);
+    } else if (arg == "-incremental") {
+        return libutil::Options::Current<bool>(&_incremental, arg);
+    } else if (arg == "-cacheFilesystem") {
+        return libutil::Options::Current<bool>(&_cacheFilesystem, arg);
     } else if (!arg.empty() && arg[0] != '-') {
         if (arg.find('=') != std::string::npos) {
             if (ext::optional<pbxsetting::Setting> setting = pbxsetting::Setting::Parse(arg)) {
@@ -19,6 +19,6 @@ main(int argc, char **argv)
 {
     DefaultFilesystem filesystem = DefaultFilesystem();
     process::DefaultContext processContext = process::DefaultContext();
-    process::DefaultLauncher processLauncher = process::DefaultLauncher();
+    process::DefaultLauncher processLauncher;
     return xcdriver::Driver::Run(&processContext, &processLauncher, &filesystem);
 }
@@ -0,0 +1,84 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_BuildState_h
+#define __xcexecution_BuildState_h
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace libutil { class Filesystem; }
+namespace pbxbuild { namespace Tool { class Invocation; } }
+
+namespace xcexecution {
+
+/*
+ * Persistent record of the invocations that last completed successfully,
+ * keyed by a hash of each invocation's command line. An invocation with up
+ * to date outputs can only be skipped if its command line has not changed
+ * since those outputs were produced. Only invocations seen in this build are
+ * saved, so ones no longer in the build are dropped. Safe to use from
+ * multiple threads.
+ */
+class BuildState {
+private:
+    std::unordered_set<std::string> _hashes;
+    std::unordered_set<std::string> _seen;
+    mutable std::mutex              _mutex;
+
+public:
+    BuildState();
+    ~BuildState();
+
+public:
+    /*
+     * If an invocation with the hashed command line completed successfully.
+     */
+    bool contains(std::string const &hash) const;
+
+    /*
+     * Record that an invocation is part of this build, even if it doesn't
+     * run. Inserting or removing an invocation also records it.
+     */
+    void see(std::string const &hash);
+
+    /*
+     * Record that an invocation completed successfully.
+     */
+    void insert(std::string const &hash);
+
+    /*
+     * Record that an invocation failed, or its outputs are otherwise stale.
+     */
+    void remove(std::string const &hash);
+
+public:
+    /*
+     * Load the state from a path. A missing file is an empty state.
+     */
+    bool load(libutil::Filesystem const *filesystem, std::string const &path);
+
+    /*
+     * Write the state to a path, keeping only invocations seen in this build.
+     */
+    bool save(libutil::Filesystem *filesystem, std::string const &path) const;
+
+public:
+    /*
+     * Hashes the command line of an invocation: its executable, arguments,
+     * environment, and working directory.
+     */
+    static std::string
+    Hash(pbxbuild::Tool::Invocation const &invocation);
+};
+
+}
+
+#endif // !__xcexecution_BuildState_h
@@ -38,9 +38,10 @@ protected:
     std::shared_ptr<xcformatter::Formatter> _formatter;
     bool                                    _dryRun;
     bool                                    _generate;
+    size_t                                  _jobs;
 
 protected:
-    Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, size_t jobs);
 
 public:
     virtual ~Executor();
@@ -23,7 +23,7 @@ namespace xcexecution {
  */
 class NinjaExecutor : public Executor {
 public:
-    NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, size_t jobs);
     ~NinjaExecutor();
 
 public:
@@ -54,8 +54,10 @@ private:
         process::Context const *processContext,
         libutil::Filesystem *filesystem,
         std::string const &dependencyInfoToolPath,
+        std::unordered_map<std::string, std::string> const &toolPools,
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
+        std::vector<std::string> const &dependenciesFinished,
         std::vector<pbxbuild::Tool::Invocation> const &invocations);
 
 private:
@@ -67,13 +69,46 @@ private:
         ninja::Writer *writer,
         pbxbuild::Tool::Invocation const &invocation,
         std::string const &executablePath,
+        std::string const &rule,
+        size_t ruleArguments,
+        std::string const &dependencyInfoFile,
+        std::string const &dependencyInfoExec,
+        std::string const &after);
+
+public:
+    /*
+     * How an invocation's dependency info is passed to Ninja: the Makefile-format
+     * file for Ninja to read, and the command to create it if it needs converting.
+     */
+    struct DependencyInfo {
+        std::string file;
+        std::string exec;
+    };
+
+    /*
+     * Determine how Ninja should read an invocation's dependency info. Ninja
+     * reads a Makefile file directly only if it can delete the file after
+     * reading it and the file names a single target; otherwise, the dependency
+     * info is converted into a temporary file.
+     */
+    static bool
+    CreateDependencyInfo(
+        pbxbuild::Tool::Invocation const &invocation,
         std::string const &dependencyInfoToolPath,
         std::string const &temporaryDirectory,
-        std::string const &after);
+        DependencyInfo *result);
+
+    /*
+     * Summarize the process environment for target fingerprints. The
+     * environment is part of every target's build settings, so a change
+     * to any variable can change the Ninja file generated for a target.
+     */
+    static std::string
+    EnvironmentFingerprint(process::Context const *processContext);
 
 public:
     static std::unique_ptr<NinjaExecutor>
-    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, size_t jobs);
 };
 
 }
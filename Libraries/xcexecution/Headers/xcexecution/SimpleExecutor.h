@@ -13,18 +13,24 @@
 #include <xcexecution/Executor.h>
 #include <builtin/Registry.h>
 
+#include <mutex>
+
 namespace xcexecution {
 
+class BuildState;
+
 /*
- * Simple executor that simply runs invocations in sequence. Advanced features
- * like incremental builds, dependency info, and such are not supported.
+ * Simple executor that simply runs invocations in sequence, or in parallel
+ * in dependency order when multiple jobs are requested. Incremental builds
+ * are supported by checking modification times and the last command line.
  */
 class SimpleExecutor : public Executor {
 private:
+    bool              _incremental;
     builtin::Registry _builtins;
 
 public:
-    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, size_t jobs, bool incremental, builtin::Registry const &builtins);
     ~SimpleExecutor();
 
 public:
@@ -41,13 +47,20 @@ public:
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
         std::vector<pbxbuild::Tool::Invocation> const &invocations);
+    /*
+     * Performs the invocations for one stage of a target, either the ones that
+     * create the product structure or the rest. With more than one job, the
+     * invocations run in parallel in dependency order. With a build state,
+     * invocations that ran before and are up to date are skipped.
+     */
     std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> performInvocations(
         process::Context const *processContext,
         process::Launcher *processLauncher,
         libutil::Filesystem *filesystem,
         std::vector<std::string> const &executablePaths,
         std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-        bool createProductStructure);
+        bool createProductStructure,
+        BuildState *buildState = nullptr);
     std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> buildTarget(
         process::Context const *processContext,
         process::Launcher *processLauncher,
@@ -56,9 +69,20 @@ public:
         pbxbuild::Target::Environment const &targetEnvironment,
         std::vector<pbxbuild::Tool::Invocation> const &invocations);
 
+private:
+    bool performInvocation(
+        process::Context const *processContext,
+        process::Launcher *processLauncher,
+        libutil::Filesystem *filesystem,
+        std::vector<std::string> const &executablePaths,
+        pbxbuild::Tool::Invocation const &invocation,
+        bool createProductStructure,
+        BuildState *buildState,
+        std::mutex *outputMutex);
+
 public:
     static std::unique_ptr<SimpleExecutor>
-    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, size_t jobs, bool incremental, builtin::Registry const &builtins);
 };
 
 }
@@ -0,0 +1,158 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/BuildState.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <libutil/Filesystem.h>
+#include <libutil/md5.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using xcexecution::BuildState;
+using libutil::Filesystem;
+
+BuildState::
+BuildState()
+{
+}
+
+BuildState::
+~BuildState()
+{
+}
+
+bool BuildState::
+contains(std::string const &hash) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hashes.find(hash) != _hashes.end();
+}
+
+void BuildState::
+see(std::string const &hash)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _seen.insert(hash);
+}
+
+void BuildState::
+insert(std::string const &hash)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hashes.insert(hash);
+    _seen.insert(hash);
+}
+
+void BuildState::
+remove(std::string const &hash)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hashes.erase(hash);
+    _seen.insert(hash);
+}
+
+bool BuildState::
+load(Filesystem const *filesystem, std::string const &path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hashes.clear();
+    _seen.clear();
+
+    if (!filesystem->exists(path)) {
+        return true;
+    }
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, path)) {
+        return false;
+    }
+
+    /* One hash per line. */
+    std::string text = std::string(contents.begin(), contents.end());
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty()) {
+            _hashes.insert(line);
+        }
+    }
+
+    return true;
+}
+
+bool BuildState::
+save(Filesystem *filesystem, std::string const &path) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    /* Drop invocations no longer in the build, so the state doesn't grow forever. */
+    std::vector<std::string> hashes;
+    for (std::string const &hash : _hashes) {
+        if (_seen.find(hash) != _seen.end()) {
+            hashes.push_back(hash);
+        }
+    }
+
+    /* Sort so the file is stable between builds. */
+    std::sort(hashes.begin(), hashes.end());
+
+    std::string contents;
+    for (std::string const &hash : hashes) {
+        contents += hash + "\n";
+    }
+
+    return filesystem->write(std::vector<uint8_t>(contents.begin(), contents.end()), path);
+}
+
+static void
+AppendHash(md5_state_t *state, std::string const &value)
+{
+    /* Include the terminator, so adjacent values can't run together. */
+    md5_append(state, reinterpret_cast<const md5_byte_t *>(value.c_str()), value.size() + 1);
+}
+
+std::string BuildState::
+Hash(pbxbuild::Tool::Invocation const &invocation)
+{
+    md5_state_t state;
+    md5_init(&state);
+
+    if (invocation.executable()) {
+        pbxbuild::Tool::Invocation::Executable const &executable = *invocation.executable();
+        AppendHash(&state, executable.builtin().value_or(std::string()));
+        AppendHash(&state, executable.external().value_or(std::string()));
+    }
+
+    AppendHash(&state, invocation.workingDirectory());
+
+    for (std::string const &argument : invocation.arguments()) {
+        AppendHash(&state, argument);
+    }
+
+    /* Environment iteration order is unspecified; sort first. */
+    std::map<std::string, std::string> environment = std::map<std::string, std::string>(invocation.environment().begin(), invocation.environment().end());
+    for (auto const &variable : environment) {
+        AppendHash(&state, variable.first);
+        AppendHash(&state, variable.second);
+    }
+
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t c : digest) {
+        ss << std::setw(2) << static_cast<int>(c);
+    }
+
+    return ss.str();
+}
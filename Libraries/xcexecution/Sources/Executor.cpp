@@ -12,10 +12,11 @@
 using xcexecution::Executor;
 
 Executor::
-Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate) :
+Executor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, size_t jobs) :
     _formatter(formatter),
     _dryRun   (dryRun),
-    _generate (generate)
+    _generate (generate),
+    _jobs     (jobs)
 {
 }
 
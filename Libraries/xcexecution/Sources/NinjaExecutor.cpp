@@ -12,6 +12,11 @@
 #include <xcexecution/Parameters.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
+#include <pbxbuild/Tool/AssetCatalogResolver.h>
+#include <pbxbuild/Tool/InterfaceBuilderResolver.h>
+#include <pbxbuild/Tool/InterfaceBuilderStoryboardLinkerResolver.h>
+#include <pbxbuild/Tool/LinkerResolver.h>
+#include <pbxbuild/Tool/ScriptResolver.h>
 #include <ninja/Writer.h>
 #include <ninja/Value.h>
 #include <plist/Data.h>
@@ -23,8 +28,13 @@
 #include <process/Launcher.h>
 #include <libutil/md5.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
 #include <iomanip>
+#include <map>
+#include <thread>
+#include <unordered_map>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -36,8 +46,8 @@ using libutil::Filesystem;
 using libutil::FSUtil;
 
 NinjaExecutor::
-NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate) :
-    Executor(formatter, dryRun, generate)
+NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, size_t jobs) :
+    Executor(formatter, dryRun, generate, jobs)
 {
 }
 
@@ -78,6 +88,12 @@ TargetNinjaPath(pbxproj::PBX::Target::shared_ptr const &target, pbxbuild::Target
     return temporaryDirectory + "/" + "build.ninja";
 }
 
+static std::string
+TargetNinjaFingerprintPath(pbxproj::PBX::Target::shared_ptr const &target, pbxbuild::Target::Environment const &targetEnvironment)
+{
+    return TargetNinjaPath(target, targetEnvironment) + "-fingerprint";
+}
+
 static std::string
 NinjaRuleName()
 {
@@ -114,6 +130,51 @@ NinjaHash(std::string const &input)
     return ss.str();
 }
 
+/*
+ * A class of tools that uses enough memory or other resources that running one
+ * per core can overwhelm the machine. Each class gets a Ninja pool limiting how
+ * many of its tools can run at once. The depth comes from a build setting or,
+ * if that's not set, is a fraction of the cores on the machine generating the
+ * Ninja files. That is usually the machine building, as the files are written
+ * again before each build; set the depth explicitly if they are shared. A
+ * depth of zero leaves the tools unlimited.
+ */
+struct NinjaPool {
+    std::string              name;
+    std::string              setting;
+    unsigned int             divisor;
+    std::vector<std::string> toolIdentifiers;
+};
+
+static std::vector<NinjaPool> const &
+NinjaPools()
+{
+    namespace Tool = pbxbuild::Tool;
+
+    static std::vector<NinjaPool> const pools = {
+        { "link", "NINJA_LINK_POOL_DEPTH", 4, {
+            Tool::LinkerResolver::LinkerToolIdentifier(),
+            Tool::LinkerResolver::LibtoolToolIdentifier(),
+            Tool::LinkerResolver::LipoToolIdentifier(),
+        } },
+        { "asset-catalog", "NINJA_ASSET_CATALOG_POOL_DEPTH", 4, {
+            Tool::AssetCatalogResolver::ToolIdentifier(),
+        } },
+        { "interface-builder", "NINJA_INTERFACE_BUILDER_POOL_DEPTH", 4, {
+            Tool::InterfaceBuilderResolver::CompilerToolIdentifier(),
+            Tool::InterfaceBuilderResolver::StoryboardCompilerToolIdentifier(),
+            Tool::InterfaceBuilderResolver::PostprocessorToolIdentifier(),
+            Tool::InterfaceBuilderResolver::StoryboardPostprocessorToolIdentifier(),
+            Tool::InterfaceBuilderStoryboardLinkerResolver::ToolIdentifier(),
+        } },
+        { "script", "NINJA_SCRIPT_POOL_DEPTH", 2, {
+            Tool::ScriptResolver::ToolIdentifier(),
+        } },
+    };
+
+    return pools;
+}
+
 static ext::optional<std::string>
 NinjaExecutablePath(
     process::Context const *processContext,
@@ -186,6 +247,235 @@ NinjaInvocationOutputs(pbxbuild::Tool::Invocation const &invocation)
     return outputs;
 }
 
+static std::string
+NinjaEnvironment(pbxbuild::Tool::Invocation const &invocation)
+{
+    /*
+     * Build the invocation environment. To set the environment, we use standard shell syntax.
+     * Use `env` to avoid Bash-specific limitations on environment variables. Specifically, some
+     * versions of Bash don't allow setting "UID". Pass -i to clear out the environment.
+     *
+     * Sort the variables so the same environment is always written the same way,
+     * both for pooling and so regenerating an unchanged target is a no-op.
+     */
+    std::vector<std::pair<std::string, std::string>> variables = std::vector<std::pair<std::string, std::string>>(invocation.environment().begin(), invocation.environment().end());
+    std::sort(variables.begin(), variables.end());
+
+    std::string environment;
+    for (auto it = variables.begin(); it != variables.end(); ++it) {
+        if (it != variables.begin()) {
+            environment += " ";
+        }
+        environment += it->first + "=" + Escape::Shell(it->second);
+    }
+    return environment;
+}
+
+bool NinjaExecutor::
+CreateDependencyInfo(
+    pbxbuild::Tool::Invocation const &invocation,
+    std::string const &dependencyInfoToolPath,
+    std::string const &temporaryDirectory,
+    DependencyInfo *result)
+{
+    std::vector<pbxbuild::Tool::Invocation::DependencyInfo> const &dependencyInfo = invocation.dependencyInfo();
+    if (dependencyInfo.empty()) {
+        return true;
+    }
+
+    if (dependencyInfo.size() == 1 && dependencyInfo.front().format() == dependency::DependencyInfoFormat::Makefile) {
+        std::string path = FSUtil::ResolveRelativePath(dependencyInfo.front().path(), invocation.workingDirectory());
+
+        /*
+         * Ninja reads Makefile dependency info itself, but with `deps = gcc` it
+         * deletes the file afterwards, so it can't also be a declared output
+         * (like Swift's per-file dependencies) or the output would always be
+         * missing. It also rejects files naming several targets; a single
+         * output means the file can only name that one.
+         */
+        std::vector<std::string> outputs = NinjaInvocationOutputs(invocation);
+        if (outputs.size() == 1 && outputs.front() != path) {
+            result->file = path;
+            return true;
+        }
+    }
+
+    /* Determine the first output; Ninja expects that as the Makefile rule. */
+    std::string output = NinjaInvocationOutputs(invocation).front();
+
+    /* Find where the generated dependency info should go. */
+    result->file = temporaryDirectory + "/" + ".ninja-dependency-info-" + NinjaHash(output) + ".d";
+
+    /* Build the dependency info rewriter arguments. */
+    std::vector<std::string> dependencyInfoArguments = {
+        "--name", output,
+        "--output", result->file,
+    };
+
+    /* Add the input for each dependency info. */
+    for (pbxbuild::Tool::Invocation::DependencyInfo const &info : dependencyInfo) {
+        std::string formatName;
+        if (!dependency::DependencyInfoFormats::Name(info.format(), &formatName)) {
+            return false;
+        }
+
+        dependencyInfoArguments.push_back(formatName + ":" + info.path());
+    }
+
+    /* Create the command for converting the dependency info. */
+    result->exec = Escape::Shell(dependencyInfoToolPath);
+    for (std::string const &arg : dependencyInfoArguments) {
+        result->exec += " " + Escape::Shell(arg);
+    }
+
+    return true;
+}
+
+/*
+ * Hash of the contents of a file, remembered for the rest of the generation
+ * since many targets share the same project and configuration files.
+ */
+static std::string
+NinjaFileHash(Filesystem const *filesystem, std::unordered_map<std::string, std::string> *fileHashes, std::string const &path)
+{
+    auto it = fileHashes->find(path);
+    if (it != fileHashes->end()) {
+        return it->second;
+    }
+
+    std::string hash;
+    std::vector<uint8_t> contents;
+    if (filesystem->read(&contents, path)) {
+        hash = NinjaHash(std::string(contents.begin(), contents.end()));
+    }
+
+    fileHashes->insert({ path, hash });
+    return hash;
+}
+
+std::string NinjaExecutor::
+EnvironmentFingerprint(process::Context const *processContext)
+{
+    std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(processContext->environmentVariables().begin(), processContext->environmentVariables().end());
+
+    std::string input;
+    for (auto const &entry : sortedEnvironment) {
+        input += entry.first + "=" + entry.second;
+        input += '\0';
+    }
+
+    return NinjaHash(input);
+}
+
+/*
+ * A fingerprint of what the Ninja file for a target is generated from: the
+ * generator, the build parameters, the process environment, the target's
+ * project and any project it references, configuration files, SDK, toolchains,
+ * specification domains, and how the target fits into the build. Files found on disk while creating
+ * the target's invocations (other than those) are not part of it.
+ */
+static std::string
+TargetNinjaFingerprint(
+    Filesystem const *filesystem,
+    std::unordered_map<std::string, std::string> *fileHashes,
+    std::string const &executablePath,
+    std::string const &dependencyInfoToolPath,
+    Parameters const &buildParameters,
+    std::string const &environmentFingerprint,
+    pbxbuild::WorkspaceContext const &workspaceContext,
+    std::unordered_map<std::string, std::string> const &toolPools,
+    pbxproj::PBX::Target::shared_ptr const &target,
+    pbxbuild::Target::Environment const &targetEnvironment,
+    std::vector<std::string> const &dependenciesFinished)
+{
+    std::string input = "xcbuild-ninja-target-1";
+    auto add = [&input](std::string const &value) {
+        input += '\0';
+        input += value;
+    };
+
+    /* A new generator may generate something different. */
+    add(executablePath);
+    if (ext::optional<libutil::FileInfo> info = filesystem->stat(executablePath)) {
+        add(std::to_string(info->size()) + " " + std::to_string(info->modificationTime()));
+    }
+    add(dependencyInfoToolPath);
+    add(buildParameters.canonicalHash());
+    add(environmentFingerprint);
+
+    /*
+     * The target's project. Referenced projects can contribute to the target's
+     * invocations, so if there are any, include every project.
+     */
+    pbxproj::PBX::Project::shared_ptr project = target->project();
+    add(project->dataFile());
+    add(NinjaFileHash(filesystem, fileHashes, project->dataFile()));
+    if (!project->projectReferences().empty()) {
+        std::vector<std::string> projectPaths;
+        for (auto const &entry : workspaceContext.projects()) {
+            projectPaths.push_back(entry.second->dataFile());
+        }
+        std::sort(projectPaths.begin(), projectPaths.end());
+
+        for (std::string const &projectPath : projectPaths) {
+            add(projectPath);
+            add(NinjaFileHash(filesystem, fileHashes, projectPath));
+        }
+    }
+
+    /* Configuration files can be included from each other, so include them all. */
+    std::vector<std::string> configPaths;
+    for (auto const &entry : workspaceContext.configs()) {
+        configPaths.push_back(entry.second.path());
+    }
+    std::sort(configPaths.begin(), configPaths.end());
+    for (std::string const &configPath : configPaths) {
+        add(configPath);
+        add(NinjaFileHash(filesystem, fileHashes, configPath));
+    }
+
+    /* Where tools and specifications come from. */
+    if (targetEnvironment.sdk() != nullptr) {
+        add(targetEnvironment.sdk()->path());
+        add(targetEnvironment.sdk()->version().value_or(std::string()));
+    }
+    for (xcsdk::SDK::Toolchain::shared_ptr const &toolchain : targetEnvironment.toolchains()) {
+        add(toolchain->path());
+    }
+    for (std::string const &specDomain : targetEnvironment.specDomains()) {
+        add(specDomain);
+    }
+
+    /* How the target fits into the build. */
+    add(target->name());
+    add(target->blueprintIdentifier());
+    for (std::string const &dependencyFinished : dependenciesFinished) {
+        add(dependencyFinished);
+    }
+
+    std::map<std::string, std::string> sortedToolPools = std::map<std::string, std::string>(toolPools.begin(), toolPools.end());
+    for (auto const &entry : sortedToolPools) {
+        add(entry.first + "=" + entry.second);
+    }
+
+    return NinjaHash(input);
+}
+
+static bool
+TargetNinjaUpToDate(Filesystem const *filesystem, std::string const &path, std::string const &fingerprintPath, std::string const &fingerprint)
+{
+    if (!filesystem->exists(path)) {
+        return false;
+    }
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, fingerprintPath)) {
+        return false;
+    }
+
+    return (std::string(contents.begin(), contents.end()) == fingerprint);
+}
+
 static void
 WriteNinjaRegenerate(
     ninja::Writer *writer,
@@ -244,13 +534,16 @@ WriteNinjaRegenerate(
         /* This command regenerates the Ninja files. */
         { "generator", ninja::Value::String("1") },
 
+        /* Regenerating may leave the Ninja file unchanged. */
+        { "restat", ninja::Value::String("1") },
+
         /* Use the console pool to pass through terminal settings. */
         { "pool", ninja::Value::String("console") },
     });
 }
 
 static bool
-WriteNinja(Filesystem *filesystem, ninja::Writer const &writer, std::string const &path)
+WriteNinja(Filesystem *filesystem, ninja::Writer const &writer, std::string const &path, bool preserveUnchanged = false)
 {
     if (!filesystem->createDirectory(FSUtil::GetDirectoryName(path))) {
         return false;
@@ -258,6 +551,19 @@ WriteNinja(Filesystem *filesystem, ninja::Writer const &writer, std::string cons
 
     std::string contents = writer.serialize();
     std::vector<uint8_t> copy = std::vector<uint8_t>(contents.begin(), contents.end());
+
+    /*
+     * If the existing file is identical, leave it alone. This keeps the
+     * modification time stable, so anything depending on the file (and
+     * anyone looking at it) sees that it didn't change.
+     */
+    if (preserveUnchanged && filesystem->isReadable(path)) {
+        std::vector<uint8_t> existing;
+        if (filesystem->read(&existing, path) && existing == copy) {
+            return true;
+        }
+    }
+
     if (!filesystem->write(copy, path)) {
         return false;
     }
@@ -509,16 +815,62 @@ buildAction(
     writer.newline();
 
     /*
-     * Since invocations are already resolved at this point, we can't use more specific
-     * rules at the Ninja level. Instead, add a single rule that just passes through from
-     * the build command that calls it.
+     * Add a rule that just passes through from the build command that calls it. Tool
+     * invocations get more specific rules in each target's Ninja file; see below.
      */
-    writer.rule(NinjaRuleName(), ninja::Value::Expression("cd $dir && env -i $env $exec && $depexec"));
+    writer.rule(NinjaRuleName(), ninja::Value::Expression("cd $dir && env -i $env $exec"));
+    writer.newline();
+
+    /*
+     * Declare pools to limit how many resource-intensive tools run at once, and
+     * note which tools go in each. Pools are global, so the rules written in each
+     * target's Ninja file can refer to them.
+     */
+    pbxsetting::Environment poolEnvironment = pbxsetting::Environment(buildEnvironment.baseEnvironment());
+    for (pbxsetting::Level const &level : buildContext.overrideLevels()) {
+        poolEnvironment.insertFront(level, false);
+    }
+
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::unordered_map<std::string, std::string> toolPools;
+    for (NinjaPool const &pool : NinjaPools()) {
+        int64_t depth = std::max<int64_t>(1, cores / pool.divisor);
+
+        std::string value = poolEnvironment.resolve(pool.setting);
+        if (!value.empty()) {
+            /* Anything but a whole number would otherwise parse as zero, removing the limit. */
+            char *end = nullptr;
+            long long parsed = std::strtoll(value.c_str(), &end, 10);
+            if (end == value.c_str() || *end != '\0' || parsed < 0) {
+                fprintf(stderr, "warning: invalid %s '%s', using %lld\n", pool.setting.c_str(), value.c_str(), static_cast<long long>(depth));
+            } else {
+                depth = parsed;
+            }
+        }
+
+        if (depth <= 0) {
+            continue;
+        }
+
+        writer.pool(pool.name, static_cast<int>(depth));
+        for (std::string const &toolIdentifier : pool.toolIdentifiers) {
+            toolPools.insert({ toolIdentifier, pool.name });
+        }
+    }
+    writer.newline();
+
+    /*
+     * Target environments are independent; create them up front in parallel.
+     */
+    std::vector<pbxproj::PBX::Target::shared_ptr> targets = std::vector<pbxproj::PBX::Target::shared_ptr>(targetGraph.nodes().begin(), targetGraph.nodes().end());
+    buildContext.createTargetEnvironments(buildEnvironment, targets, _jobs);
 
     /*
      * Go over each target and write out Ninja targets for the start and end of each.
      * Don't bother topologically sorting the targets now, since Ninja will do that for us.
      */
+    std::unordered_map<std::string, std::string> fileHashes;
+    std::string environmentFingerprint = EnvironmentFingerprint(processContext);
     for (pbxproj::PBX::Target::shared_ptr const &target : targetGraph.nodes()) {
 
         /*
@@ -536,10 +888,13 @@ buildAction(
          * cross-target parallelization; if the target dependency graph doesn't have an edge,
          * then they will be parallelized. Linear builds have edges from each target to all
          * previous targets.
+         *
+         * All of these are written in the target's own Ninja file, so an unchanged target's
+         * Ninja file can be used without generating its invocations again.
          */
 
         /*
-         * Resolve this target and generate its invocations.
+         * Resolve this target.
          */
         ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext.targetEnvironment(buildEnvironment, target);
         if (!targetEnvironment) {
@@ -547,87 +902,59 @@ buildAction(
             continue;
         }
 
-        pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, buildContext, target, *targetEnvironment);
-        pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
-
         /*
          * As described above, the target's begin depends on all of the target dependencies.
          */
-        std::vector<ninja::Value> dependenciesFinished;
+        std::vector<std::string> dependenciesFinished;
         for (pbxproj::PBX::Target::shared_ptr const &dependency : targetGraph.adjacent(target)) {
-            std::string targetFinished = TargetNinjaFinish(dependency);
-            dependenciesFinished.push_back(ninja::Value::String(targetFinished));
-        }
-
-        /*
-         * Add the phony target for beginning this target's build.
-         */
-        std::string targetBegin = TargetNinjaBegin(target);
-        writer.build({ ninja::Value::String(targetBegin) }, "phony", dependenciesFinished);
-
-        /*
-         * Add the phony target for the checkpoint after writing auxiliary files.
-         */
-        std::string targetWriteAuxiliaryFiles = TargetNinjaWriteAuxiliaryFiles(target);
-        std::vector<ninja::Value> auxiliaryFileOutputs = { ninja::Value::String(targetBegin) };
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
-            for (pbxbuild::Tool::Invocation::AuxiliaryFile const &auxiliaryFile : invocation.auxiliaryFiles()) {
-                auxiliaryFileOutputs.push_back(ninja::Value::String(auxiliaryFile.path()));
-            }
+            dependenciesFinished.push_back(TargetNinjaFinish(dependency));
         }
-        writer.build({ ninja::Value::String(targetWriteAuxiliaryFiles) }, "phony", auxiliaryFileOutputs);
 
         /*
-         * Write out the Ninja file to build this target.
-         */
-        if (!buildTargetInvocations(processContext, filesystem, dependencyInfoToolPath, target, *targetEnvironment, phaseInvocations.invocations())) {
-            fprintf(stderr, "error: failed to build target ninja\n");
-            return false;
-        }
-
-        /*
-         * Load the Ninja file generated for this target.
+         * Generating a target's invocations is the slowest part of generating. If
+         * nothing the target's Ninja file is generated from has changed, use the
+         * Ninja file from last time.
          */
         std::string targetPath = TargetNinjaPath(target, *targetEnvironment);
-        writer.subninja(ninja::Value::String(targetPath));
+        std::string fingerprintPath = TargetNinjaFingerprintPath(target, *targetEnvironment);
+        std::string fingerprint = TargetNinjaFingerprint(
+            filesystem,
+            &fileHashes,
+            processContext->executablePath(),
+            dependencyInfoToolPath,
+            buildParameters,
+            environmentFingerprint,
+            buildContext.workspaceContext(),
+            toolPools,
+            target,
+            *targetEnvironment,
+            dependenciesFinished);
 
-        /*
-         * As described above, the target's finish depends on all of the invocation outputs.
-         */
-        std::unordered_set<std::string> invocationOutputs;
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
-            if (!invocation.executable()) {
-                /* No outputs. */
-                continue;
-            }
+        if (!TargetNinjaUpToDate(filesystem, targetPath, fingerprintPath, fingerprint)) {
+            pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, buildContext, target, *targetEnvironment);
+            pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target, _jobs);
 
-            std::vector<std::string> outputs = NinjaInvocationOutputs(invocation);
-            invocationOutputs.insert(outputs.begin(), outputs.end());
-        }
+            /*
+             * Write out the Ninja file to build this target.
+             */
+            if (!buildTargetInvocations(processContext, filesystem, dependencyInfoToolPath, toolPools, target, *targetEnvironment, dependenciesFinished, phaseInvocations.invocations())) {
+                fprintf(stderr, "error: failed to build target ninja\n");
+                return false;
+            }
 
-        /*
-         * Add phony rules for input dependencies that we don't know if they exist.
-         * This can come up, for example, for user-specified custom script inputs.
-         * However, avoid adding the phony invocation if a real output *does* include
-         * the phony input, to avoid Ninja complaining about duplicate rules.
-         */
-        for (pbxbuild::Tool::Invocation const &invocation : phaseInvocations.invocations()) {
-            for (std::string const &phonyInput : invocation.phonyInputs()) {
-                if (invocationOutputs.find(phonyInput) == invocationOutputs.end()) {
-                    writer.build({ ninja::Value::String(phonyInput) }, "phony", { });
-                }
+            /*
+             * Record what the Ninja file was generated from, only once it's written.
+             */
+            if (!filesystem->write(std::vector<uint8_t>(fingerprint.begin(), fingerprint.end()), fingerprintPath)) {
+                fprintf(stderr, "error: unable to write target ninja fingerprint: %s\n", fingerprintPath.c_str());
+                return false;
             }
         }
 
         /*
-         * Add the phony target for ending this target's build.
+         * Load the Ninja file for this target.
          */
-        std::string targetFinish = TargetNinjaFinish(target);
-        std::vector<ninja::Value> invocationOutputsValues;
-        for (std::string const &output : invocationOutputs) {
-            invocationOutputsValues.push_back(ninja::Value::String(output));
-        }
-        writer.build({ ninja::Value::String(targetFinish) }, "phony", { }, { }, invocationOutputsValues);
+        writer.subninja(ninja::Value::String(targetPath));
     }
 
     /*
@@ -650,7 +977,7 @@ buildAction(
     /*
      * Serialize the Ninja file into the build root.
      */
-    if (!WriteNinja(filesystem, writer, ninjaPath)) {
+    if (!WriteNinja(filesystem, writer, ninjaPath, true)) {
         fprintf(stderr, "error: failed to write Ninja to %s\n", ninjaPath.c_str());
         return false;
     }
@@ -668,8 +995,10 @@ buildTargetInvocations(
     process::Context const *processContext,
     Filesystem *filesystem,
     std::string const &dependencyInfoToolPath,
+    std::unordered_map<std::string, std::string> const &toolPools,
     pbxproj::PBX::Target::shared_ptr const &target,
     pbxbuild::Target::Environment const &targetEnvironment,
+    std::vector<std::string> const &dependenciesFinished,
     std::vector<pbxbuild::Tool::Invocation> const &invocations)
 {
     /*
@@ -680,15 +1009,62 @@ buildTargetInvocations(
     writer.comment("Target: " + target->name());
     writer.newline();
 
+    /*
+     * Add the phony target for beginning this target's build.
+     */
     std::string targetBegin = TargetNinjaBegin(target);
+    std::vector<ninja::Value> dependenciesFinishedValues;
+    for (std::string const &dependencyFinished : dependenciesFinished) {
+        dependenciesFinishedValues.push_back(ninja::Value::String(dependencyFinished));
+    }
+    writer.build({ ninja::Value::String(targetBegin) }, "phony", dependenciesFinishedValues);
+
+    /*
+     * Add the phony target for the checkpoint after writing auxiliary files.
+     */
     std::string targetWriteAuxiliaryFiles = TargetNinjaWriteAuxiliaryFiles(target);
+    std::vector<ninja::Value> auxiliaryFileOutputs = { ninja::Value::String(targetBegin) };
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        for (pbxbuild::Tool::Invocation::AuxiliaryFile const &auxiliaryFile : invocation.auxiliaryFiles()) {
+            auxiliaryFileOutputs.push_back(ninja::Value::String(auxiliaryFile.path()));
+        }
+    }
+    writer.build({ ninja::Value::String(targetWriteAuxiliaryFiles) }, "phony", auxiliaryFileOutputs);
+    writer.newline();
 
     pbxsetting::Environment const &environment = targetEnvironment.environment();
     std::string temporaryDirectory = environment.resolve("TARGET_TEMP_DIR");
 
     /*
-     * Add the build command for each invocation.
+     * Invocations of the same tool share most of their command: the executable,
+     * working directory, environment, and usually leading arguments. Rather than
+     * writing that out for every build command, group invocations by tool and give
+     * each group its own rule containing the shared parts. Environments are often
+     * shared between tools, so each is written once as a variable.
      */
+    struct ToolRule {
+        std::string              name;
+        std::string              executablePath;
+        std::string              workingDirectory;
+        size_t                   environment;
+        bool                     convertDependencyInfo;
+        std::string              pool;
+        std::vector<std::string> arguments;
+    };
+
+    struct ToolInvocation {
+        pbxbuild::Tool::Invocation const *invocation;
+        size_t                            rule;
+        DependencyInfo                    dependencyInfo;
+    };
+
+    std::string rulePrefix = NinjaRuleName() + "-" + NinjaHash(TargetNinjaPath(target, targetEnvironment)).substr(0, 8) + "-";
+    std::vector<std::string> environments;
+    std::unordered_map<std::string, size_t> environmentIndexes;
+    std::vector<ToolRule> rules;
+    std::unordered_map<std::string, size_t> ruleIndexes;
+    std::vector<ToolInvocation> toolInvocations;
+
     for (pbxbuild::Tool::Invocation const &invocation : invocations) {
         /* Write auxiliary files to run first. */
         for (pbxbuild::Tool::Invocation::AuxiliaryFile const &auxiliaryFile : invocation.auxiliaryFiles()) {
@@ -698,27 +1074,147 @@ buildTargetInvocations(
         }
 
         // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
-        if (invocation.executable()) {
-            /* Find invocation executable. */
-            ext::optional<std::string> executablePath = NinjaExecutablePath(processContext, filesystem, targetEnvironment.executablePaths(), *invocation.executable());
-            if (!executablePath) {
-                fprintf(stderr, "unable to find executable: %s\n", invocation.executable()->builtin().value_or(invocation.executable()->external().value_or("<NONE>")).c_str());
+        if (!invocation.executable()) {
+            continue;
+        }
 
-                return false;
+        /* Find invocation executable. */
+        ext::optional<std::string> executablePath = NinjaExecutablePath(processContext, filesystem, targetEnvironment.executablePaths(), *invocation.executable());
+        if (!executablePath) {
+            fprintf(stderr, "unable to find executable: %s\n", invocation.executable()->builtin().value_or(invocation.executable()->external().value_or("<NONE>")).c_str());
+
+            return false;
+        }
+
+        DependencyInfo dependencyInfo;
+        if (!CreateDependencyInfo(invocation, dependencyInfoToolPath, temporaryDirectory, &dependencyInfo)) {
+            return false;
+        }
+
+        /* Pool the environment. */
+        std::string environmentValue = NinjaEnvironment(invocation);
+        auto eit = environmentIndexes.find(environmentValue);
+        if (eit == environmentIndexes.end()) {
+            eit = environmentIndexes.insert({ environmentValue, environments.size() }).first;
+            environments.push_back(environmentValue);
+        }
+
+        /* Limit resource-intensive tools with their pool. */
+        std::string pool;
+        auto pit = toolPools.find(invocation.toolIdentifier());
+        if (pit != toolPools.end()) {
+            pool = pit->second;
+        }
+
+        /* Find the rule for the tool, narrowing its arguments to those shared by all invocations. */
+        bool convertDependencyInfo = !dependencyInfo.exec.empty();
+        std::string key = *executablePath + '\0' + invocation.workingDirectory() + '\0' + std::to_string(eit->second) + '\0' + (convertDependencyInfo ? "1" : "0") + '\0' + pool;
+        auto rit = ruleIndexes.find(key);
+        if (rit == ruleIndexes.end()) {
+            rit = ruleIndexes.insert({ key, rules.size() }).first;
+            rules.push_back({ rulePrefix + std::to_string(rules.size()), *executablePath, invocation.workingDirectory(), eit->second, convertDependencyInfo, pool, invocation.arguments() });
+        } else {
+            std::vector<std::string> &arguments = rules[rit->second].arguments;
+            size_t shared = 0;
+            while (shared < arguments.size() && shared < invocation.arguments().size() && arguments[shared] == invocation.arguments()[shared]) {
+                shared++;
             }
+            arguments.resize(shared);
+        }
 
-            /* Write invocations to run after auxiliary files. */
-            if (!buildInvocation(&writer, invocation, *executablePath, dependencyInfoToolPath, temporaryDirectory, targetWriteAuxiliaryFiles)) {
-                return false;
+        toolInvocations.push_back({ &invocation, rit->second, dependencyInfo });
+    }
+
+    /*
+     * Write the shared environments and the rule for each tool.
+     */
+    for (size_t index = 0; index < environments.size(); ++index) {
+        writer.binding({ "env" + std::to_string(index), ninja::Value::String(environments[index]) });
+    }
+    writer.newline();
+
+    for (ToolRule const &rule : rules) {
+        /*
+         * Must escape for shell arguments as Ninja passes the command string
+         * directly to the shell, which would interpret spaces, etc as meaningful.
+         */
+        std::string command = "cd " + Escape::Shell(rule.workingDirectory) + " && env -i ";
+        ninja::Value value = ninja::Value::String(command) + ninja::Value::Expression("$env" + std::to_string(rule.environment));
+
+        std::string exec = " " + Escape::Shell(rule.executablePath);
+        for (std::string const &arg : rule.arguments) {
+            exec += " " + Escape::Shell(arg);
+        }
+        value = value + ninja::Value::String(exec) + ninja::Value::Expression(" $args");
+
+        if (rule.convertDependencyInfo) {
+            value = value + ninja::Value::Expression(" && $depexec");
+        }
+
+        std::vector<ninja::Binding> bindings;
+        if (!rule.pool.empty()) {
+            bindings.push_back({ "pool", ninja::Value::String(rule.pool) });
+        }
+
+        writer.rule(rule.name, value, bindings);
+    }
+
+    /*
+     * Add the build command for each invocation.
+     */
+    for (ToolInvocation const &toolInvocation : toolInvocations) {
+        ToolRule const &rule = rules[toolInvocation.rule];
+
+        /* Write invocations to run after auxiliary files. */
+        if (!buildInvocation(&writer, *toolInvocation.invocation, rule.executablePath, rule.name, rule.arguments.size(), toolInvocation.dependencyInfo.file, toolInvocation.dependencyInfo.exec, targetWriteAuxiliaryFiles)) {
+            return false;
+        }
+    }
+
+    /*
+     * The target's finish depends on all of the invocation outputs.
+     */
+    std::unordered_set<std::string> invocationOutputs;
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        if (!invocation.executable()) {
+            /* No outputs. */
+            continue;
+        }
+
+        std::vector<std::string> outputs = NinjaInvocationOutputs(invocation);
+        invocationOutputs.insert(outputs.begin(), outputs.end());
+    }
+
+    /*
+     * Add phony rules for input dependencies that we don't know if they exist.
+     * This can come up, for example, for user-specified custom script inputs.
+     * However, avoid adding the phony invocation if a real output *does* include
+     * the phony input, to avoid Ninja complaining about duplicate rules.
+     */
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        for (std::string const &phonyInput : invocation.phonyInputs()) {
+            if (invocationOutputs.find(phonyInput) == invocationOutputs.end()) {
+                writer.build({ ninja::Value::String(phonyInput) }, "phony", { });
             }
         }
     }
 
     /*
-     * Serialize the Ninja file into the build root.
+     * Add the phony target for ending this target's build.
+     */
+    std::string targetFinish = TargetNinjaFinish(target);
+    std::vector<ninja::Value> invocationOutputsValues;
+    for (std::string const &output : invocationOutputs) {
+        invocationOutputsValues.push_back(ninja::Value::String(output));
+    }
+    writer.build({ ninja::Value::String(targetFinish) }, "phony", { }, { }, invocationOutputsValues);
+
+    /*
+     * Serialize the Ninja file into the target's temporary directory. If
+     * the target's invocations are the same as before, leave the file alone.
      */
     std::string path = TargetNinjaPath(target, targetEnvironment);
-    if (!WriteNinja(filesystem, writer, path)) {
+    if (!WriteNinja(filesystem, writer, path, true)) {
         fprintf(stderr, "error: unable to write target ninja: %s\n", path.c_str());
         return false;
     }
@@ -779,7 +1275,6 @@ buildAuxiliaryFile(
         { "description", ninja::Value::String(description) },
         { "dir", ninja::Value::String("/") },
         { "exec", ninja::Value::String(exec) },
-        { "depexec", ninja::Value::String("true") },
     };
     writer->build(outputs, NinjaRuleName(), inputs, bindings, { }, orderDependencies);
 
@@ -791,30 +1286,22 @@ buildInvocation(
     ninja::Writer *writer,
     pbxbuild::Tool::Invocation const &invocation,
     std::string const &executablePath,
-    std::string const &dependencyInfoToolPath,
-    std::string const &temporaryDirectory,
+    std::string const &rule,
+    size_t ruleArguments,
+    std::string const &dependencyInfoFile,
+    std::string const &dependencyInfoExec,
     std::string const &after)
 {
     /*
-     * Build the invocation arguments. Must escape for shell arguments as Ninja passes
-     * the command string directly to the shell, which would interpret spaces, etc as meaningful.
-     */
-    std::string exec = Escape::Shell(executablePath);
-    for (std::string const &arg : invocation.arguments()) {
-        exec += " " + Escape::Shell(arg);
-    }
-
-    /*
-     * Build the invocation environment. To set the environment, we use standard shell syntax.
-     * Use `env` to avoid Bash-specific limitations on environment variables. Specifically, some
-     * versions of Bash don't allow setting "UID". Pass -i to clear out the environment.
+     * Build the arguments not already part of the rule. Must escape for shell arguments
+     * as Ninja passes the command string directly to the shell.
      */
-    std::string environment;
-    for (auto it = invocation.environment().begin(); it != invocation.environment().end(); ++it) {
-        if (it != invocation.environment().begin()) {
-            environment += " ";
+    std::string args;
+    for (auto it = std::next(invocation.arguments().begin(), ruleArguments); it != invocation.arguments().end(); ++it) {
+        if (!args.empty()) {
+            args += " ";
         }
-        environment += it->first + "=" + Escape::Shell(it->second);
+        args += Escape::Shell(*it);
     }
 
     /*
@@ -823,61 +1310,22 @@ buildInvocation(
     std::string executableDisplayName = invocation.executable()->builtin().value_or(executablePath);
     std::string description = NinjaDescription(_formatter->beginInvocation(invocation, executableDisplayName, false));
 
-    /*
-     * Add the dependency info converter & file.
-     */
-    std::string dependencyInfoFile;
-    std::string dependencyInfoExec;
-
-    if (!invocation.dependencyInfo().empty()) {
-        /* Determine the first output; Ninja expects that as the Makefile rule. */
-        std::string output = NinjaInvocationOutputs(invocation).front();
-
-        /* Find where the generated dependency info should go. */
-        dependencyInfoFile = temporaryDirectory + "/" + ".ninja-dependency-info-" + NinjaHash(output) + ".d";
-
-        /* Build the dependency info rewriter arguments. */
-        std::vector<std::string> dependencyInfoArguments = {
-            "--name", output,
-            "--output", dependencyInfoFile,
-        };
-
-        /* Add the input for each dependency info. */
-        for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
-            std::string formatName;
-            if (!dependency::DependencyInfoFormats::Name(dependencyInfo.format(), &formatName)) {
-                return false;
-            }
-
-            dependencyInfoArguments.push_back(formatName + ":" + dependencyInfo.path());
-        }
-
-        /* Create the command for converting the dependency info. */
-        dependencyInfoExec = Escape::Shell(dependencyInfoToolPath);
-        for (std::string const &arg : dependencyInfoArguments) {
-            dependencyInfoExec += " " + Escape::Shell(arg);
-        }
-    } else {
-        // TODO(grp): Avoid the need for an empty dependency info command if not used.
-        dependencyInfoExec = "true";
-    }
-
     /*
      * Build up the bindings for the invocation.
      */
     std::vector<ninja::Binding> bindings = {
         { "description", ninja::Value::String(description) },
-        { "dir", ninja::Value::String(Escape::Shell(invocation.workingDirectory())) },
-        { "exec", ninja::Value::String(exec) },
     };
-    if (!environment.empty()) {
-        bindings.push_back({ "env", ninja::Value::String(environment) });
+    if (!args.empty()) {
+        bindings.push_back({ "args", ninja::Value::String(args) });
     }
     if (!dependencyInfoExec.empty()) {
         bindings.push_back({ "depexec", ninja::Value::String(dependencyInfoExec) });
     }
     if (!dependencyInfoFile.empty()) {
+        /* Have Ninja record dependencies in its log rather than re-reading the file. */
         bindings.push_back({ "depfile", ninja::Value::String(dependencyInfoFile) });
+        bindings.push_back({ "deps", ninja::Value::String("gcc") });
     }
 
     /*
@@ -920,17 +1368,18 @@ buildInvocation(
     /*
      * Add the rule to build this invocation.
      */
-    writer->build(outputs, NinjaRuleName(), inputs, bindings, inputDependencies, orderDependencies);
+    writer->build(outputs, rule, inputs, bindings, inputDependencies, orderDependencies);
 
     return true;
 }
 
 std::unique_ptr<NinjaExecutor> NinjaExecutor::
-Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate)
+Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, size_t jobs)
 {
     return std::unique_ptr<NinjaExecutor>(new NinjaExecutor(
         formatter,
         dryRun,
-        generate
+        generate,
+        jobs
     ));
 }
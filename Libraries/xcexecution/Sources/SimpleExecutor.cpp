@@ -9,16 +9,26 @@
 
 #include <xcexecution/SimpleExecutor.h>
 
+#include <xcexecution/BuildState.h>
 #include <xcexecution/Parameters.h>
 #include <builtin/Driver.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <dependency/BinaryDependencyInfo.h>
+#include <dependency/DirectoryDependencyInfo.h>
+#include <dependency/MakefileDependencyInfo.h>
 #include <process/Context.h>
 #include <process/MemoryContext.h>
 #include <process/Launcher.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <thread>
+
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -27,9 +37,10 @@ using libutil::Filesystem;
 using libutil::FSUtil;
 
 SimpleExecutor::
-SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins) :
-    Executor (formatter, dryRun, false),
-    _builtins(builtins)
+SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, size_t jobs, bool incremental, builtin::Registry const &builtins) :
+    Executor    (formatter, dryRun, false, jobs),
+    _incremental(incremental),
+    _builtins   (builtins)
 {
 }
 
@@ -69,6 +80,9 @@ build(
         return false;
     }
 
+    /* Target environments are independent; create them up front in parallel. */
+    buildContext->createTargetEnvironments(buildEnvironment, *orderedTargets, _jobs);
+
     for (pbxproj::PBX::Target::shared_ptr const &target : *orderedTargets) {
         xcformatter::Formatter::Print(_formatter->beginTarget(*buildContext, target));
 
@@ -81,7 +95,7 @@ build(
 
         xcformatter::Formatter::Print(_formatter->beginCheckDependencies(target));
         pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, *buildContext, target, *targetEnvironment);
-        pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
+        pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target, _jobs);
         xcformatter::Formatter::Print(_formatter->finishCheckDependencies(target));
 
         auto result = buildTarget(processContext, processLauncher, filesystem, target, *targetEnvironment, phaseInvocations.invocations());
@@ -98,39 +112,49 @@ build(
     return true;
 }
 
-static ext::optional<std::vector<pbxbuild::Tool::Invocation>>
-SortInvocations(std::vector<pbxbuild::Tool::Invocation> const &invocations)
+/*
+ * Finds the invocations each invocation depends on, by index: those producing
+ * its inputs, phony inputs, input dependencies, or order dependencies.
+ */
+static std::vector<std::unordered_set<size_t>>
+InvocationDependencies(std::vector<pbxbuild::Tool::Invocation> const &invocations)
 {
-    std::unordered_map<std::string, pbxbuild::Tool::Invocation const *> outputToInvocation;
-    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
-        for (std::string const &output : invocation.outputs()) {
-            outputToInvocation.insert({ output, &invocation });
+    std::unordered_map<std::string, size_t> outputToInvocation;
+    for (size_t index = 0; index < invocations.size(); ++index) {
+        for (std::string const &output : invocations[index].outputs()) {
+            outputToInvocation.insert({ output, index });
         }
     }
 
-    pbxbuild::DirectedGraph<pbxbuild::Tool::Invocation const *> graph;
-    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
-        std::unordered_set<pbxbuild::Tool::Invocation const *> emptySet;
-        graph.insert(&invocation, emptySet);
+    std::vector<std::unordered_set<size_t>> dependencies = std::vector<std::unordered_set<size_t>>(invocations.size());
+    for (size_t index = 0; index < invocations.size(); ++index) {
+        pbxbuild::Tool::Invocation const &invocation = invocations[index];
 
-        for (std::string const &input : invocation.inputs()) {
-            auto it = outputToInvocation.find(input);
-            if (it != outputToInvocation.end()) {
-                graph.insert(&invocation, { it->second });
-            }
-        }
-        for (std::string const &phonyInputs : invocation.phonyInputs()) {
-            auto it = outputToInvocation.find(phonyInputs);
-            if (it != outputToInvocation.end()) {
-                graph.insert(&invocation, { it->second });
+        for (std::vector<std::string> const *paths : { &invocation.inputs(), &invocation.phonyInputs(), &invocation.inputDependencies(), &invocation.orderDependencies() }) {
+            for (std::string const &path : *paths) {
+                auto it = outputToInvocation.find(path);
+                if (it != outputToInvocation.end() && it->second != index) {
+                    dependencies[index].insert(it->second);
+                }
             }
         }
-        for (std::string const &inputDependency : invocation.inputDependencies()) {
-            auto it = outputToInvocation.find(inputDependency);
-            if (it != outputToInvocation.end()) {
-                graph.insert(&invocation, { it->second });
-            }
+    }
+
+    return dependencies;
+}
+
+static ext::optional<std::vector<pbxbuild::Tool::Invocation>>
+SortInvocations(std::vector<pbxbuild::Tool::Invocation> const &invocations)
+{
+    std::vector<std::unordered_set<size_t>> dependencies = InvocationDependencies(invocations);
+
+    pbxbuild::DirectedGraph<pbxbuild::Tool::Invocation const *> graph;
+    for (size_t index = 0; index < invocations.size(); ++index) {
+        std::unordered_set<pbxbuild::Tool::Invocation const *> adjacent;
+        for (size_t dependency : dependencies[index]) {
+            adjacent.insert(&invocations[dependency]);
         }
+        graph.insert(&invocations[index], adjacent);
     }
 
     std::vector<pbxbuild::Tool::Invocation> result;
@@ -203,6 +227,7 @@ writeAuxiliaryFiles(
                     if (::chmod(auxiliaryFile.path().c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0) {
                         return false;
                     }
+                    filesystem->invalidate(auxiliaryFile.path());
                 }
             }
         }
@@ -212,6 +237,291 @@ writeAuxiliaryFiles(
     return true;
 }
 
+static bool
+LoadDependencyInfoInputs(Filesystem const *filesystem, pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo, std::string const &workingDirectory, std::vector<std::string> *inputs)
+{
+    std::string path = FSUtil::ResolveRelativePath(dependencyInfo.path(), workingDirectory);
+
+    switch (dependencyInfo.format()) {
+        case dependency::DependencyInfoFormat::Binary: {
+            std::vector<uint8_t> contents;
+            if (!filesystem->read(&contents, path)) {
+                return false;
+            }
+
+            auto binaryInfo = dependency::BinaryDependencyInfo::Deserialize(contents);
+            if (!binaryInfo) {
+                return false;
+            }
+
+            std::vector<std::string> const &binaryInputs = binaryInfo->dependencyInfo().inputs();
+            inputs->insert(inputs->end(), binaryInputs.begin(), binaryInputs.end());
+            return true;
+        }
+        case dependency::DependencyInfoFormat::Directory: {
+            auto directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, path);
+            if (!directoryInfo) {
+                return false;
+            }
+
+            std::vector<std::string> const &directoryInputs = directoryInfo->dependencyInfo().inputs();
+            inputs->insert(inputs->end(), directoryInputs.begin(), directoryInputs.end());
+            return true;
+        }
+        case dependency::DependencyInfoFormat::Makefile: {
+            std::vector<uint8_t> contents;
+            if (!filesystem->read(&contents, path)) {
+                return false;
+            }
+
+            auto makefileInfo = dependency::MakefileDependencyInfo::Deserialize(std::string(contents.begin(), contents.end()));
+            if (!makefileInfo) {
+                return false;
+            }
+
+            for (dependency::DependencyInfo const &info : makefileInfo->dependencyInfo()) {
+                inputs->insert(inputs->end(), info.inputs().begin(), info.inputs().end());
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Determines if an invocation's outputs are all newer than its inputs,
+ * including the inputs discovered in its dependency info from the last
+ * time it ran. Invocations without outputs are never up to date.
+ */
+static bool
+InvocationUpToDate(Filesystem const *filesystem, pbxbuild::Tool::Invocation const &invocation)
+{
+    if (invocation.outputs().empty()) {
+        return false;
+    }
+
+    std::vector<std::string> outputs;
+    for (std::string const &output : invocation.outputs()) {
+        outputs.push_back(FSUtil::ResolveRelativePath(output, invocation.workingDirectory()));
+    }
+
+    uint64_t oldestOutput = UINT64_MAX;
+    for (ext::optional<libutil::FileInfo> const &info : filesystem->statMany(outputs)) {
+        if (!info) {
+            return false;
+        }
+
+        oldestOutput = std::min(oldestOutput, info->modificationTime());
+    }
+
+    std::vector<std::string> inputs;
+    inputs.insert(inputs.end(), invocation.inputs().begin(), invocation.inputs().end());
+    inputs.insert(inputs.end(), invocation.inputDependencies().begin(), invocation.inputDependencies().end());
+    for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+        if (!LoadDependencyInfoInputs(filesystem, dependencyInfo, invocation.workingDirectory(), &inputs)) {
+            return false;
+        }
+    }
+
+    for (std::string &input : inputs) {
+        input = FSUtil::ResolveRelativePath(input, invocation.workingDirectory());
+    }
+
+    for (ext::optional<libutil::FileInfo> const &info : filesystem->statMany(inputs)) {
+        if (!info || info->modificationTime() > oldestOutput) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Reads back and closes a temporary file a builtin tool printed into.
+ */
+static std::string
+ReadOutput(FILE *file)
+{
+    std::string contents;
+
+    rewind(file);
+    char buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, size);
+    }
+
+    fclose(file);
+    return contents;
+}
+
+bool SimpleExecutor::
+performInvocation(
+    process::Context const *processContext,
+    process::Launcher *processLauncher,
+    Filesystem *filesystem,
+    std::vector<std::string> const &executablePaths,
+    pbxbuild::Tool::Invocation const &invocation,
+    bool createProductStructure,
+    BuildState *buildState,
+    std::mutex *outputMutex)
+{
+    pbxbuild::Tool::Invocation::Executable const &executable = *invocation.executable();
+
+    /*
+     * Skip invocations run before with the same command line if nothing changed since.
+     */
+    std::string hash;
+    if (buildState != nullptr) {
+        hash = BuildState::Hash(invocation);
+        buildState->see(hash);
+        if (buildState->contains(hash) && InvocationUpToDate(filesystem, invocation)) {
+            return true;
+        }
+        buildState->remove(hash);
+    }
+
+    for (std::string const &output : invocation.outputs()) {
+        std::string directory = FSUtil::GetDirectoryName(output);
+
+        if (!filesystem->createDirectory(directory)) {
+            return false;
+        }
+    }
+
+    /*
+     * Find the tool to run. Builtin tools run in-process, external tools
+     * are found on the filesystem.
+     */
+    std::string name;
+    std::shared_ptr<builtin::Driver> driver;
+    if (ext::optional<std::string> const &builtin = executable.builtin()) {
+        driver = _builtins.driver(*builtin);
+        if (driver == nullptr) {
+            /* Failed to find builtin tool. */
+            return false;
+        }
+
+        name = *builtin;
+    } else if (ext::optional<std::string> const &external = executable.external()) {
+        ext::optional<std::string> path;
+        if (FSUtil::IsAbsolutePath(*external)) {
+            if (filesystem->isExecutable(*external)) {
+                path = external;
+            }
+        } else {
+            path = filesystem->findExecutable(*external, executablePaths);
+        }
+
+        if (!path) {
+            /* Failed to find executable. */
+            return false;
+        }
+
+        name = *path;
+    } else {
+        abort();
+    }
+
+    /*
+     * When running in parallel, hold the output until the invocation finishes,
+     * so the output for each invocation is printed together.
+     */
+    std::string begin;
+    if (outputMutex != nullptr) {
+        std::lock_guard<std::mutex> lock(*outputMutex);
+        begin = _formatter->beginInvocation(invocation, name, createProductStructure);
+    } else {
+        xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, name, createProductStructure));
+    }
+
+    process::MemoryContext context = process::MemoryContext(
+        name,
+        invocation.workingDirectory(),
+        invocation.arguments(),
+        invocation.environment(),
+        processContext->userID(),
+        processContext->groupID(),
+        processContext->userName(),
+        processContext->groupName());
+
+    bool success;
+    std::string standardOutput;
+    std::string standardError;
+    if (driver != nullptr) {
+        if (outputMutex != nullptr) {
+            /* In parallel, hold what builtin tools print like external tools' output. */
+            FILE *output = tmpfile();
+            FILE *error = tmpfile();
+            if (output != nullptr && error != nullptr) {
+                int exitCode = driver->run(&context, filesystem, output, error);
+                success = (exitCode == 0);
+                standardOutput = ReadOutput(output);
+                standardError = ReadOutput(error);
+            } else {
+                success = false;
+                standardError = "error: unable to create temporary file for output of " + name + "\n";
+                if (output != nullptr) {
+                    fclose(output);
+                }
+                if (error != nullptr) {
+                    fclose(error);
+                }
+            }
+        } else {
+            int exitCode = driver->run(&context, filesystem, stdout, stderr);
+            success = (exitCode == 0);
+        }
+    } else {
+        /* In parallel, capture output so it's printed with the rest of the invocation. */
+        process::Launcher::Process::shared_ptr launched = processLauncher->spawn(filesystem, &context, outputMutex != nullptr);
+        if (launched != nullptr) {
+            processLauncher->wait(launched);
+            standardOutput = launched->standardOutput();
+            standardError = launched->standardError();
+        }
+        success = (launched != nullptr && launched->exitCode() && *launched->exitCode() == 0);
+
+        /*
+         * External tools don't write through the filesystem. Forget what's
+         * known about their outputs, anything inside outputs that are
+         * directories, and the directories containing them.
+         */
+        for (std::string const &output : invocation.outputs()) {
+            filesystem->invalidate(FSUtil::ResolveRelativePath(output, invocation.workingDirectory()));
+        }
+    }
+
+    if (outputMutex == nullptr) {
+        xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, name, createProductStructure));
+    } else {
+        std::lock_guard<std::mutex> lock(*outputMutex);
+        xcformatter::Formatter::Print(begin);
+        fwrite(standardOutput.data(), 1, standardOutput.size(), stdout);
+        fflush(stdout);
+        fwrite(standardError.data(), 1, standardError.size(), stderr);
+        xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, name, createProductStructure));
+    }
+
+    if (buildState != nullptr && success) {
+        buildState->insert(hash);
+    }
+
+    return success;
+}
+
+static bool
+ShouldPerformInvocation(pbxbuild::Tool::Invocation const &invocation, bool createProductStructure)
+{
+    // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
+    if (!invocation.executable()) {
+        return false;
+    }
+
+    return (invocation.createsProductStructure() == createProductStructure);
+}
+
 std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> SimpleExecutor::
 performInvocations(
     process::Context const *processContext,
@@ -219,91 +529,122 @@ performInvocations(
     Filesystem *filesystem,
     std::vector<std::string> const &executablePaths,
     std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-    bool createProductStructure)
+    bool createProductStructure,
+    BuildState *buildState)
 {
-    for (pbxbuild::Tool::Invocation const &invocation : orderedInvocations) {
-        // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
-        if (!invocation.executable()) {
-            continue;
+    if (_dryRun) {
+        return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
+    }
+
+    if (_jobs <= 1) {
+        for (pbxbuild::Tool::Invocation const &invocation : orderedInvocations) {
+            if (!ShouldPerformInvocation(invocation, createProductStructure)) {
+                continue;
+            }
+
+            if (!performInvocation(processContext, processLauncher, filesystem, executablePaths, invocation, createProductStructure, buildState, nullptr)) {
+                return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+            }
         }
-        pbxbuild::Tool::Invocation::Executable const &executable = *invocation.executable();
 
-        if (invocation.createsProductStructure() != createProductStructure) {
-            continue;
+        return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
+    }
+
+    /*
+     * Build the dependency graph between invocations from the same edges used
+     * to order them. Invocations that are skipped are still part of the graph,
+     * so dependencies through them hold.
+     */
+    std::vector<std::unordered_set<size_t>> dependencies = InvocationDependencies(orderedInvocations);
+    std::vector<std::vector<size_t>> dependents = std::vector<std::vector<size_t>>(orderedInvocations.size());
+    std::vector<size_t> remainingDependencies = std::vector<size_t>(orderedInvocations.size(), 0);
+    for (size_t index = 0; index < orderedInvocations.size(); ++index) {
+        for (size_t dependency : dependencies[index]) {
+            dependents[dependency].push_back(index);
         }
+        remainingDependencies[index] = dependencies[index].size();
+    }
 
-        if (!_dryRun) {
-            bool success = true;
+    /*
+     * Run ready invocations on a pool of worker threads. Invocations become
+     * ready when all of their dependencies finish. After a failure, no new
+     * invocations are started, but running invocations are allowed to finish.
+     */
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<size_t> ready;
+    size_t running = 0;
+    size_t completed = 0;
+    std::vector<pbxbuild::Tool::Invocation> failures;
+
+    for (size_t index = 0; index < orderedInvocations.size(); ++index) {
+        if (remainingDependencies[index] == 0) {
+            ready.push_back(index);
+        }
+    }
 
-            for (std::string const &output : invocation.outputs()) {
-                std::string directory = FSUtil::GetDirectoryName(output);
+    std::mutex outputMutex;
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
 
-                if (!filesystem->createDirectory(directory)) {
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
-                }
+        while (true) {
+            while (ready.empty() && running > 0) {
+                condition.wait(lock);
             }
 
-            if (ext::optional<std::string> const &builtin = executable.builtin()) {
-                /* Builtin tool, find and run in-process. */
-                if (std::shared_ptr<builtin::Driver> driver = _builtins.driver(*builtin)) {
-                    xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *builtin, createProductStructure));
-
-                    process::MemoryContext context = process::MemoryContext(
-                        *builtin,
-                        invocation.workingDirectory(),
-                        invocation.arguments(),
-                        invocation.environment(),
-                        processContext->userID(),
-                        processContext->groupID(),
-                        processContext->userName(),
-                        processContext->groupName());
-                    int exitCode = driver->run(&context, filesystem);
-                    success = (exitCode == 0);
-
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, *builtin, createProductStructure));
-                } else {
-                    /* Failed to find builtin tool. */
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
-                }
-            } else if (ext::optional<std::string> const &external = executable.external()) {
-                /* External tool, find on the filesystem. */
-                ext::optional<std::string> path;
-                if (FSUtil::IsAbsolutePath(*external)) {
-                    if (filesystem->isExecutable(*external)) {
-                        path = external;
-                    }
-                } else {
-                    path = filesystem->findExecutable(*external, executablePaths);
-                }
+            if (ready.empty() || !failures.empty()) {
+                break;
+            }
+
+            size_t index = ready.front();
+            ready.pop_front();
+            running++;
+
+            lock.unlock();
+
+            pbxbuild::Tool::Invocation const &invocation = orderedInvocations[index];
+            bool success = true;
+            if (ShouldPerformInvocation(invocation, createProductStructure)) {
+                success = performInvocation(processContext, processLauncher, filesystem, executablePaths, invocation, createProductStructure, buildState, &outputMutex);
+            }
 
-                if (path) {
-                    xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *path, createProductStructure));
-
-                    process::MemoryContext context = process::MemoryContext(
-                        *path,
-                        invocation.workingDirectory(),
-                        invocation.arguments(),
-                        invocation.environment(),
-                        processContext->userID(),
-                        processContext->groupID(),
-                        processContext->userName(),
-                        processContext->groupName());
-                    ext::optional<int> exitCode = processLauncher->launch(filesystem, &context);
-                    success = (exitCode && *exitCode == 0);
-
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, *path, createProductStructure));
-                } else {
-                    /* Failed to find executable. */
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+            lock.lock();
+            running--;
+
+            if (success) {
+                completed++;
+                for (size_t dependent : dependents[index]) {
+                    if (--remainingDependencies[dependent] == 0) {
+                        ready.push_back(dependent);
+                    }
                 }
             } else {
-                abort();
+                failures.push_back(invocation);
             }
 
-            if (!success) {
-                return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
-            }
+            condition.notify_all();
         }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t n = 0; n < std::min(_jobs, orderedInvocations.size()); ++n) {
+        threads.push_back(std::thread(worker));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    if (!failures.empty()) {
+        return std::make_pair(false, failures);
+    }
+
+    /*
+     * Invocations in a cycle never become ready. Without a failure, every
+     * invocation must have finished for the build to have succeeded.
+     */
+    if (completed != orderedInvocations.size()) {
+        fprintf(stderr, "error: cycle detected building invocation graph\n");
+        return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
     }
 
     return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
@@ -328,14 +669,42 @@ buildTarget(
         return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
     }
 
+    /*
+     * In incremental builds, load which invocations ran successfully before.
+     * The state is per target, as only this target's invocations are kept.
+     */
+    std::unique_ptr<BuildState> buildState;
+    std::string buildStatePath = targetEnvironment.environment().resolve("TARGET_TEMP_DIR") + "/" + "xcbuild-state";
+    if (_incremental && !_dryRun) {
+        buildState = std::unique_ptr<BuildState>(new BuildState());
+        if (!buildState->load(filesystem, buildStatePath)) {
+            fprintf(stderr, "warning: unable to load build state, building everything\n");
+        }
+
+        /* Keep invocations that don't run this time, such as after a failure. */
+        for (pbxbuild::Tool::Invocation const &invocation : *orderedInvocations) {
+            buildState->see(BuildState::Hash(invocation));
+        }
+    }
+
     xcformatter::Formatter::Print(_formatter->beginCreateProductStructure(target));
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> structureResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, true);
+    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> structureResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, true, buildState.get());
     xcformatter::Formatter::Print(_formatter->finishCreateProductStructure(target));
-    if (!structureResult.first) {
-        return structureResult;
+
+    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> invocationsResult = structureResult;
+    if (structureResult.first) {
+        invocationsResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, false, buildState.get());
+    }
+
+    /*
+     * Save the state even if the build failed, so successful invocations can be skipped.
+     */
+    if (buildState != nullptr) {
+        if (!filesystem->createDirectory(FSUtil::GetDirectoryName(buildStatePath)) || !buildState->save(filesystem, buildStatePath)) {
+            fprintf(stderr, "warning: unable to save build state\n");
+        }
     }
 
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> invocationsResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, false);
     if (!invocationsResult.first) {
         return invocationsResult;
     }
@@ -344,11 +713,13 @@ buildTarget(
 }
 
 std::unique_ptr<SimpleExecutor> SimpleExecutor::
-Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins)
+Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, size_t jobs, bool incremental, builtin::Registry const &builtins)
 {
     return std::unique_ptr<SimpleExecutor>(new SimpleExecutor(
         formatter,
         dryRun,
+        jobs,
+        incremental,
         builtins
     ));
 }
@@ -0,0 +1,91 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/BuildState.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <libutil/MemoryFilesystem.h>
+
+using xcexecution::BuildState;
+using libutil::MemoryFilesystem;
+
+TEST(BuildState, Hash)
+{
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::External("/usr/bin/clang");
+    invocation.arguments() = { "-c", "file.c" };
+
+    auto same = invocation;
+    EXPECT_EQ(BuildState::Hash(invocation), BuildState::Hash(same));
+
+    auto arguments = invocation;
+    arguments.arguments() = { "-c", "file.c", "-O2" };
+    EXPECT_NE(BuildState::Hash(invocation), BuildState::Hash(arguments));
+
+    /* Arguments can't run together. */
+    auto joined = invocation;
+    joined.arguments() = { "-cfile.c" };
+    EXPECT_NE(BuildState::Hash(invocation), BuildState::Hash(joined));
+
+    auto environment = invocation;
+    environment.environment() = { { "PATH", "/usr/bin" } };
+    EXPECT_NE(BuildState::Hash(invocation), BuildState::Hash(environment));
+}
+
+TEST(BuildState, LoadSave)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("objroot", { }),
+    });
+
+    BuildState missing;
+    EXPECT_TRUE(missing.load(&filesystem, "/objroot/xcbuild-state"));
+    EXPECT_FALSE(missing.contains("abc"));
+
+    BuildState state;
+    state.insert("abc");
+    state.insert("def");
+    state.remove("def");
+    EXPECT_TRUE(state.contains("abc"));
+    EXPECT_FALSE(state.contains("def"));
+    EXPECT_TRUE(state.save(&filesystem, "/objroot/xcbuild-state"));
+
+    BuildState loaded;
+    EXPECT_TRUE(loaded.load(&filesystem, "/objroot/xcbuild-state"));
+    EXPECT_TRUE(loaded.contains("abc"));
+    EXPECT_FALSE(loaded.contains("def"));
+}
+
+TEST(BuildState, SaveDropsUnseen)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("objroot", { }),
+    });
+
+    BuildState state;
+    state.insert("abc");
+    state.insert("def");
+    state.insert("ghi");
+    EXPECT_TRUE(state.save(&filesystem, "/objroot/xcbuild-state"));
+
+    /* Only some invocations are still in the next build. */
+    BuildState next;
+    EXPECT_TRUE(next.load(&filesystem, "/objroot/xcbuild-state"));
+    next.see("abc");
+    EXPECT_TRUE(next.contains("def"));
+    next.insert("jkl");
+    EXPECT_TRUE(next.save(&filesystem, "/objroot/xcbuild-state"));
+
+    BuildState loaded;
+    EXPECT_TRUE(loaded.load(&filesystem, "/objroot/xcbuild-state"));
+    EXPECT_TRUE(loaded.contains("abc"));
+    EXPECT_FALSE(loaded.contains("def"));
+    EXPECT_FALSE(loaded.contains("ghi"));
+    EXPECT_TRUE(loaded.contains("jkl"));
+}
@@ -0,0 +1,91 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/NinjaExecutor.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <process/MemoryContext.h>
+
+using xcexecution::NinjaExecutor;
+using pbxbuild::Tool::Invocation;
+
+TEST(NinjaExecutor, DependencyInfoClang)
+{
+    /* A compile writing a Makefile dependency file naming its object. */
+    Invocation invocation;
+    invocation.workingDirectory() = "/src";
+    invocation.outputs() = { "/obj/main.o" };
+    invocation.dependencyInfo() = { Invocation::DependencyInfo(dependency::DependencyInfoFormat::Makefile, "/obj/main.d") };
+
+    NinjaExecutor::DependencyInfo dependencyInfo;
+    EXPECT_TRUE(NinjaExecutor::CreateDependencyInfo(invocation, "/bin/dependency-info-tool", "/tmp", &dependencyInfo));
+
+    /* Read directly by Ninja. */
+    EXPECT_EQ("/obj/main.d", dependencyInfo.file);
+    EXPECT_EQ("", dependencyInfo.exec);
+}
+
+TEST(NinjaExecutor, DependencyInfoSwift)
+{
+    /*
+     * Swift lists its dependency files as outputs, and they name each of the
+     * outputs. Ninja would delete them after reading them, so they must be
+     * converted instead.
+     */
+    Invocation invocation;
+    invocation.workingDirectory() = "/src";
+    invocation.outputs() = { "/obj/main.o", "/obj/main~partial.swiftmodule", "/obj/main.d", "/obj/main.swiftdeps" };
+    invocation.dependencyInfo() = { Invocation::DependencyInfo(dependency::DependencyInfoFormat::Makefile, "/obj/main.d") };
+
+    NinjaExecutor::DependencyInfo dependencyInfo;
+    EXPECT_TRUE(NinjaExecutor::CreateDependencyInfo(invocation, "/bin/dependency-info-tool", "/tmp", &dependencyInfo));
+
+    EXPECT_NE("/obj/main.d", dependencyInfo.file);
+    EXPECT_EQ(0, dependencyInfo.file.find("/tmp/.ninja-dependency-info-"));
+    EXPECT_NE(std::string::npos, dependencyInfo.exec.find("makefile:/obj/main.d"));
+    EXPECT_NE(std::string::npos, dependencyInfo.exec.find("--name /obj/main.o"));
+}
+
+TEST(NinjaExecutor, DependencyInfoNone)
+{
+    Invocation invocation;
+    invocation.outputs() = { "/obj/main.o" };
+
+    NinjaExecutor::DependencyInfo dependencyInfo;
+    EXPECT_TRUE(NinjaExecutor::CreateDependencyInfo(invocation, "/bin/dependency-info-tool", "/tmp", &dependencyInfo));
+    EXPECT_EQ("", dependencyInfo.file);
+    EXPECT_EQ("", dependencyInfo.exec);
+}
+
+static process::MemoryContext
+EnvironmentContext(std::unordered_map<std::string, std::string> const &environment)
+{
+    return process::MemoryContext(
+        "/bin/xcbuild",
+        "/src",
+        std::vector<std::string>(),
+        environment,
+        0,
+        0,
+        "user",
+        "group");
+}
+
+TEST(NinjaExecutor, EnvironmentFingerprint)
+{
+    process::MemoryContext context = EnvironmentContext({ { "PATH", "/usr/bin" }, { "CONFIGURATION_BUILD_DIR", "/build" } });
+    process::MemoryContext same = EnvironmentContext({ { "CONFIGURATION_BUILD_DIR", "/build" }, { "PATH", "/usr/bin" } });
+    process::MemoryContext changed = EnvironmentContext({ { "PATH", "/usr/bin" }, { "CONFIGURATION_BUILD_DIR", "/other" } });
+    process::MemoryContext added = EnvironmentContext({ { "PATH", "/usr/bin" }, { "CONFIGURATION_BUILD_DIR", "/build" }, { "ARCHS", "arm64" } });
+
+    /* Environment variables become build settings, so any change is a new fingerprint. */
+    EXPECT_EQ(NinjaExecutor::EnvironmentFingerprint(&context), NinjaExecutor::EnvironmentFingerprint(&same));
+    EXPECT_NE(NinjaExecutor::EnvironmentFingerprint(&context), NinjaExecutor::EnvironmentFingerprint(&changed));
+    EXPECT_NE(NinjaExecutor::EnvironmentFingerprint(&context), NinjaExecutor::EnvironmentFingerprint(&added));
+}
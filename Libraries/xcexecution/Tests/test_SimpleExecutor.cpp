@@ -9,6 +9,7 @@
 
 #include <gtest/gtest.h>
 #include <xcexecution/SimpleExecutor.h>
+#include <xcexecution/BuildState.h>
 #include <xcformatter/NullFormatter.h>
 #include <pbxbuild/Tool/Invocation.h>
 #include <builtin/Driver.h>
@@ -17,13 +18,19 @@
 #include <process/MemoryLauncher.h>
 #include <libutil/MemoryFilesystem.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
 using xcexecution::SimpleExecutor;
 using libutil::Filesystem;
 using libutil::MemoryFilesystem;
 
 class Driver : public builtin::Driver {
 public:
-    using Impl = std::function<int(process::Context const *processContext, Filesystem *filesystem)>;
+    using Impl = std::function<int(process::Context const *processContext, Filesystem *filesystem, FILE *output, FILE *error)>;
 
 private:
     std::string _name;
@@ -41,8 +48,8 @@ public:
     { return _name; }
 
 public:
-    virtual int run(process::Context const *processContext, Filesystem *filesystem)
-    { return _impl(processContext, filesystem); }
+    virtual int run(process::Context const *processContext, Filesystem *filesystem, FILE *output, FILE *error)
+    { return _impl(processContext, filesystem, output, error); }
 };
 
 TEST(SimpleExecutor, PropagateToolResult)
@@ -63,10 +70,10 @@ TEST(SimpleExecutor, PropagateToolResult)
     });
 
     auto registry = builtin::Registry::Create({
-        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-fail", [](process::Context const *context, Filesystem *filesystem) -> int {
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-fail", [](process::Context const *context, Filesystem *filesystem, FILE *output, FILE *error) -> int {
             return 1;
         })),
-        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-success", [](process::Context const *context, Filesystem *filesystem) -> int {
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-success", [](process::Context const *context, Filesystem *filesystem, FILE *output, FILE *error) -> int {
             return 0;
         })),
     });
@@ -95,7 +102,7 @@ TEST(SimpleExecutor, PropagateToolResult)
     /* Create test executor. */
     auto formatter = xcformatter::NullFormatter::Create();
     std::vector<std::string> const executablePaths = { "/" };
-    SimpleExecutor executor = SimpleExecutor(formatter, false, registry);
+    SimpleExecutor executor = SimpleExecutor(formatter, false, 1, false, registry);
 
     /* Succeed if all tools succeed. */
     auto success = executor.performInvocations(
@@ -143,3 +150,277 @@ TEST(SimpleExecutor, PropagateToolResult)
     EXPECT_EQ(fail2.second.size(), 1);
 }
 
+TEST(SimpleExecutor, ParallelDependencyOrder)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("out", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](std::string const &name) -> Driver::Impl {
+        return [&mutex, &order, name](process::Context const *context, Filesystem *filesystem, FILE *output, FILE *error) -> int {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+            return (name == "builtin-fail" ? 1 : 0);
+        };
+    };
+
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-first", record("builtin-first"))),
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-second", record("builtin-second"))),
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-third", record("builtin-third"))),
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-fail", record("builtin-fail"))),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        "/",
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>(),
+        0,
+        0,
+        "user",
+        "group");
+
+    /* Create a chain of invocations, through inputs and order dependencies. */
+    auto first = pbxbuild::Tool::Invocation();
+    first.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-first");
+    first.outputs() = { "/out/first" };
+
+    auto second = pbxbuild::Tool::Invocation();
+    second.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-second");
+    second.inputs() = { "/out/first" };
+    second.outputs() = { "/out/second" };
+
+    auto third = pbxbuild::Tool::Invocation();
+    third.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-third");
+    third.orderDependencies() = { "/out/second" };
+
+    /* Create test executor. */
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { "/" };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, 4, false, registry);
+
+    /* Dependencies are respected even when passed out of order. */
+    auto success = executor.performInvocations(
+        &context,
+        &launcher,
+        &filesystem,
+        executablePaths,
+        {
+            third,
+            second,
+            first,
+        },
+        false);
+    ASSERT_TRUE(success.first);
+    EXPECT_EQ(order, std::vector<std::string>({ "builtin-first", "builtin-second", "builtin-third" }));
+
+    /* Invocations depending on a failed invocation don't run. */
+    auto fail = pbxbuild::Tool::Invocation();
+    fail.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-fail");
+    fail.outputs() = { "/out/first" };
+
+    order.clear();
+    auto failure = executor.performInvocations(
+        &context,
+        &launcher,
+        &filesystem,
+        executablePaths,
+        {
+            fail,
+            second,
+        },
+        false);
+    ASSERT_FALSE(failure.first);
+    EXPECT_EQ(failure.second.size(), 1);
+    EXPECT_EQ(order, std::vector<std::string>({ "builtin-fail" }));
+}
+
+TEST(SimpleExecutor, ParallelCycleFails)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("out", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-success", [](process::Context const *context, Filesystem *filesystem, FILE *output, FILE *error) -> int {
+            return 0;
+        })),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        "/",
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>(),
+        0,
+        0,
+        "user",
+        "group");
+
+    /* Invocations waiting on each other through order dependencies. */
+    auto first = pbxbuild::Tool::Invocation();
+    first.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-success");
+    first.outputs() = { "/out/first" };
+    first.orderDependencies() = { "/out/second" };
+
+    auto second = pbxbuild::Tool::Invocation();
+    second.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-success");
+    second.outputs() = { "/out/second" };
+    second.orderDependencies() = { "/out/first" };
+
+    /* Create test executor. */
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { "/" };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, 4, false, registry);
+
+    /* Neither can run, so the build can't succeed. */
+    auto result = executor.performInvocations(
+        &context,
+        &launcher,
+        &filesystem,
+        executablePaths,
+        {
+            first,
+            second,
+        },
+        false);
+    EXPECT_FALSE(result.first);
+}
+
+TEST(SimpleExecutor, ParallelBuiltinsOutputHeld)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("out", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    /* Each builtin waits for another to start between lines it prints. */
+    std::atomic<int> running(0);
+    std::atomic<int> overlapped(0);
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-print", [&](process::Context const *context, Filesystem *filesystem, FILE *output, FILE *error) -> int {
+            std::string const &name = context->commandLineArguments().front();
+            fprintf(output, "begin %s\n", name.c_str());
+            if (++running > 1) {
+                overlapped++;
+            }
+            for (int i = 0; i < 1000 && overlapped == 0; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            running--;
+            fprintf(output, "end %s\n", name.c_str());
+            return 0;
+        })),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        "/",
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>(),
+        0,
+        0,
+        "user",
+        "group");
+
+    /* Independent invocations, free to run at the same time. */
+    std::vector<pbxbuild::Tool::Invocation> invocations;
+    for (int i = 0; i < 8; ++i) {
+        auto invocation = pbxbuild::Tool::Invocation();
+        invocation.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-print");
+        invocation.arguments() = { std::to_string(i) };
+        invocation.outputs() = { "/out/" + std::to_string(i) };
+        invocations.push_back(invocation);
+    }
+
+    /* Create test executor. */
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { "/" };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, 4, false, registry);
+
+    testing::internal::CaptureStdout();
+    auto success = executor.performInvocations(
+        &context,
+        &launcher,
+        &filesystem,
+        executablePaths,
+        invocations,
+        false);
+    std::string printed = testing::internal::GetCapturedStdout();
+    ASSERT_TRUE(success.first);
+
+    /* Builtins ran at once, but each one's output is printed together. */
+    EXPECT_GT(overlapped, 0);
+
+    std::istringstream lines(printed);
+    std::string begin;
+    std::string end;
+    int count = 0;
+    while (std::getline(lines, begin) && std::getline(lines, end)) {
+        ASSERT_EQ(begin.compare(0, 6, "begin "), 0);
+        EXPECT_EQ(end, "end " + begin.substr(6));
+        count++;
+    }
+    EXPECT_EQ(count, 8);
+}
+
+TEST(SimpleExecutor, IncrementalSkipsUpToDate)
+{
+    /* Create in-memory execution environment. */
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("in", { }),
+        MemoryFilesystem::Entry::Directory("out", { }),
+    });
+    auto launcher = process::MemoryLauncher({ });
+
+    size_t count = 0;
+    auto registry = builtin::Registry::Create({
+        std::static_pointer_cast<builtin::Driver>(std::make_shared<Driver>("builtin-produce", [&count](process::Context const *context, Filesystem *filesystem, FILE *output, FILE *error) -> int {
+            count++;
+            return (filesystem->write(std::vector<uint8_t>(), "/out/product") ? 0 : 1);
+        })),
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        "/",
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>(),
+        0,
+        0,
+        "user",
+        "group");
+
+    auto produce = pbxbuild::Tool::Invocation();
+    produce.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-produce");
+    produce.inputs() = { "/in/source" };
+    produce.outputs() = { "/out/product" };
+
+    /* Create test executor. */
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { "/" };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, 1, true, registry);
+    xcexecution::BuildState state;
+
+    /* First build runs the invocation. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(), "/in/source"));
+    ASSERT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { produce }, false, &state).first);
+    EXPECT_EQ(count, 1);
+
+    /* Output is newer than the input, so nothing runs. */
+    ASSERT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { produce }, false, &state).first);
+    EXPECT_EQ(count, 1);
+
+    /* Modifying the input runs the invocation again. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(), "/in/source"));
+    ASSERT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { produce }, false, &state).first);
+    EXPECT_EQ(count, 2);
+}
@@ -105,15 +105,15 @@ Open(Filesystem const *filesystem, std::string const &name, std::string const &o
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    std::unique_ptr<libutil::FileContents> contents = filesystem->map(realPath);
+    if (contents == nullptr) {
         return nullptr;
     }
 
     //
     // Parse simple XML
     //
-    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents->data(), contents->size()).first;
     if (root == nullptr) {
         return nullptr;
     }
@@ -81,15 +81,15 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, settingsFileName)) {
+    std::unique_ptr<libutil::FileContents> contents = filesystem->map(settingsFileName);
+    if (contents == nullptr) {
         return nullptr;
     }
 
     /*
      * Parse property list.
      */
-    auto result = plist::Format::Any::Deserialize(contents);
+    auto result = plist::Format::Any::Deserialize(contents->data(), contents->size());
     if (result.first == nullptr) {
         return nullptr;
     }
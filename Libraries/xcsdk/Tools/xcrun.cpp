@@ -467,7 +467,7 @@ main(int argc, char **argv)
 {
     DefaultFilesystem filesystem = DefaultFilesystem();
     process::DefaultContext processContext = process::DefaultContext();
-    process::DefaultLauncher processLauncher = process::DefaultLauncher();
+    process::DefaultLauncher processLauncher;
     return Run(&filesystem, &processContext, &processLauncher);
 }
 
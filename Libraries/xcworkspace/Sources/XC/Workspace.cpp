@@ -75,15 +75,15 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, realPath)) {
+    std::unique_ptr<libutil::FileContents> contents = filesystem->map(realPath);
+    if (contents == nullptr) {
         return nullptr;
     }
 
     //
     // Parse property list
     //
-    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents).first;
+    std::unique_ptr<plist::Object> root = plist::Format::SimpleXML::Deserialize(contents->data(), contents->size()).first;
     if (root == nullptr) {
         return nullptr;
     }